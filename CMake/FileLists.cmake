@@ -1,4 +1,6 @@
 set(sources 
+   src/BinaryCoordOutput.cpp
+   src/BinaryCoordSetup.cpp
    src/BlockOutput.cpp
    src/BoxDimensions.cpp
    src/BoxDimensionsNonOrth.cpp
@@ -14,11 +16,14 @@ set(sources
    src/EnPartCntSampleOutput.cpp
    src/Ewald.cpp
    src/EwaldCached.cpp
+   src/EwaldPME.cpp
    src/FFConst.cpp
    src/FFDihedrals.cpp
    src/FFParticle.cpp
    src/FFSetup.cpp
+   src/FFTable.cpp
    src/Forcefield.cpp
+   src/FrameworkGrid.cpp
    src/Geometry.cpp
    src/HistOutput.cpp
    src/InputFileReader.cpp
@@ -31,14 +36,18 @@ set(sources
    src/NoEwald.cpp
    src/OutConst.cpp
    src/OutputVars.cpp
+   src/PairBatch.cpp
    src/PDBSetup.cpp
    src/PDBOutput.cpp
    src/PRNGSetup.cpp
+   src/Profiler.cpp
    src/PSFOutput.cpp
    src/Reader.cpp
+   src/ReplicaExchange.cpp
    src/Simulation.cpp
    src/StaticVals.cpp
    src/System.cpp
+   src/VerletList.cpp
    src/cbmc/DCCrankShaftAng.cpp
    src/cbmc/DCCrankShaftDih.cpp
    src/cbmc/DCCyclic.cpp
@@ -59,6 +68,8 @@ set(sources
    src/cbmc/TrialMol.cpp)
 
 set(headers
+   src/BinaryCoordOutput.h
+   src/BinaryCoordSetup.h
    src/BlockOutput.h
    src/BoxDimensions.h
    src/BoxDimensionsNonOrth.h
@@ -80,6 +91,7 @@ set(headers
    src/EnsemblePreprocessor.h
    src/Ewald.h
    src/EwaldCached.h  
+   src/EwaldPME.h
    src/FFAngles.h
    src/FFBonds.h
    src/FFConst.h
@@ -89,8 +101,10 @@ set(headers
    src/FFShift.h
    src/FFSwitch.h
    src/FFSwitchMartini.h
+   src/FFTable.h
    src/FixedWidthReader.h
    src/Forcefield.h
+   src/FrameworkGrid.h
    src/FxdWidthWrtr.h
    src/Geometry.h
    src/HistOutput.h
@@ -108,13 +122,18 @@ set(headers
    src/OutConst.h
    src/OutputAbstracts.h
    src/OutputVars.h
+   src/PairBatch.h
+   src/Parallel.h
    src/PDBConst.h
    src/PDBOutput.h
    src/PDBSetup.h
    src/PRNG.h
    src/PRNGSetup.h
+   src/Profiler.h
    src/PSFOutput.h
    src/Reader.h
+   src/ReplicaExchange.h
+   src/Scratch.h
    src/SeedReader.h
    src/Setup.h
    src/SimEventFrequency.h
@@ -123,6 +142,7 @@ set(headers
    src/SubdividedArray.h
    src/System.h
    src/TransformMatrix.h
+   src/VerletList.h
    src/Writer.h
    src/XYZArray.h
    src/cbmc/DCComponent.h
@@ -168,10 +188,12 @@ set(libHeaders
    lib/StrLib.h
    lib/StrStrmLib.h
    lib/VectorLib.h
+   lib/FFT3D.h
    lib/FloydWarshallCycle.h)
 
 set(libSources
-    lib/FloydWarshallCycle.cpp)
+    lib/FloydWarshallCycle.cpp
+    lib/FFT3D.cpp)
 
 set(cudaHeaders
     src/GPU/ConstantDefinitionsCUDAKernel.cuh
@@ -187,7 +209,15 @@ set(cudaSources
     src/GPU/CalculateEwaldCUDAKernel.cu
     src/GPU/ConstantDefinitionsCUDAKernel.cu)
 
+set(benchHeaders
+    src/bench/BenchSystems.h)
+
+set(benchSources
+    src/bench/BenchMain.cpp
+    src/bench/BenchSystems.cpp)
+
 source_group("Header Files" FILES ${headers})
 source_group("Lib Headers" FILES ${libHeaders})
 source_group("CUDA Header Files" FILES ${cudaHeaders})
 source_group("CUDA Source Files" FILES ${cudaSources})
+source_group("Benchmark Files" FILES ${benchHeaders} ${benchSources})
@@ -0,0 +1,14 @@
+#Benchmark of the kernels and moves, Gibbs ensemble with the profiler
+#built in, for the times of the CBMC components
+set(Bench_flags "-DENSEMBLE=2 -DGOMC_PROFILE")
+set(Bench_name "GOMC_Bench")
+
+if(GOMC_BENCH)
+   set(benchLibSources ${sources})
+   list(REMOVE_ITEM benchLibSources src/Main.cpp)
+   add_executable(GOMC_Bench ${benchSources} ${benchHeaders} ${benchLibSources}
+                  ${headers} ${libHeaders} ${libSources})
+   set_target_properties(GOMC_Bench PROPERTIES
+      OUTPUT_NAME ${Bench_name}
+      COMPILE_FLAGS "${Bench_flags}")
+endif()
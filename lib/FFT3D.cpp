@@ -0,0 +1,122 @@
+/*******************************************************************************
+GPU OPTIMIZED MONTE CARLO (GOMC) 2.40
+Copyright (C) 2018  GOMC Group
+A copy of the GNU General Public License can be found in the COPYRIGHT.txt
+along with this program, also can be found at <http://www.gnu.org/licenses/>.
+********************************************************************************/
+#include "FFT3D.h"
+#include <cmath>
+#include <cassert>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+const int FFT3D::FORWARD;
+const int FFT3D::BACKWARD;
+
+FFT3D::FFT3D()
+{
+  n[0] = n[1] = n[2] = 0;
+}
+
+uint FFT3D::GoodSize(const uint length)
+{
+  uint size = 1;
+  while (size < length)
+    size <<= 1;
+  return size;
+}
+
+void FFT3D::Init(const uint nx, const uint ny, const uint nz)
+{
+  n[0] = nx;
+  n[1] = ny;
+  n[2] = nz;
+
+  for (uint a = 0; a < 3; a++) {
+    assert(n[a] == GoodSize(n[a]));
+    uint bits = 0;
+    while ((1u << bits) < n[a])
+      bits++;
+
+    reverse[a].resize(n[a]);
+    for (uint i = 0; i < n[a]; i++) {
+      uint r = 0;
+      for (uint b = 0; b < bits; b++) {
+        if (i & (1u << b))
+          r |= 1u << (bits - 1 - b);
+      }
+      reverse[a][i] = r;
+    }
+
+    twiddle[a].resize(n[a] / 2);
+    for (uint k = 0; k < n[a] / 2; k++) {
+      double arg = -2.0 * M_PI * k / n[a];
+      twiddle[a][k] = std::complex<double>(cos(arg), sin(arg));
+    }
+  }
+}
+
+void FFT3D::Line(std::complex<double>* line, const uint axis,
+                 const int sign) const
+{
+  uint length = n[axis];
+  std::vector<uint> const& rev = reverse[axis];
+  std::vector< std::complex<double> > const& w = twiddle[axis];
+
+  for (uint i = 0; i < length; i++) {
+    if (i < rev[i])
+      std::swap(line[i], line[rev[i]]);
+  }
+
+  for (uint span = 2; span <= length; span <<= 1) {
+    uint half = span / 2;
+    uint step = length / span;
+    for (uint i = 0; i < length; i += span) {
+      for (uint k = 0; k < half; k++) {
+        std::complex<double> t = (sign == FORWARD ? w[k * step] :
+                                  std::conj(w[k * step]));
+        t *= line[i + k + half];
+        line[i + k + half] = line[i + k] - t;
+        line[i + k] += t;
+      }
+    }
+  }
+}
+
+void FFT3D::Transform(std::vector< std::complex<double> >& data,
+                      const int sign) const
+{
+  assert(data.size() == Size());
+  uint stride[3] = { n[1] * n[2], n[2], 1 };
+
+  for (uint a = 0; a < 3; a++) {
+    int lines = Size() / n[a];
+#ifdef _OPENMP
+    #pragma omp parallel default(shared)
+#endif
+    {
+      std::vector< std::complex<double> > buffer(n[a]);
+      int l;
+#ifdef _OPENMP
+      #pragma omp for
+#endif
+      for (l = 0; l < lines; l++) {
+        //first element of the line l running along axis a
+        uint start;
+        if (a == 0)
+          start = l;
+        else if (a == 1)
+          start = (l / n[2]) * stride[0] + (l % n[2]);
+        else
+          start = l * n[2];
+
+        for (uint i = 0; i < n[a]; i++)
+          buffer[i] = data[start + i * stride[a]];
+        Line(&buffer[0], a, sign);
+        for (uint i = 0; i < n[a]; i++)
+          data[start + i * stride[a]] = buffer[i];
+      }
+    }
+  }
+}
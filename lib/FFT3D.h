@@ -0,0 +1,60 @@
+/*******************************************************************************
+GPU OPTIMIZED MONTE CARLO (GOMC) 2.40
+Copyright (C) 2018  GOMC Group
+A copy of the GNU General Public License can be found in the COPYRIGHT.txt
+along with this program, also can be found at <http://www.gnu.org/licenses/>.
+********************************************************************************/
+#ifndef FFT3D_H
+#define FFT3D_H
+
+#include "BasicTypes.h" //For uint
+#include <complex>
+#include <vector>
+
+//
+//    FFT3D.h
+//    Complex to complex 3D fast Fourier transform of a row major grid
+//    (index = (x * ny + y) * nz + z). Every axis length must be a power of
+//    two. Transforms are done in place and not normalized, so a forward
+//    transform followed by a backward one scales the data by Size().
+//
+
+class FFT3D
+{
+public:
+  static const int FORWARD = -1;  //exp(-2 pi i k.x / n)
+  static const int BACKWARD = 1;  //exp(+2 pi i k.x / n)
+
+  FFT3D();
+
+  //! Smallest power of two that is not less than n
+  static uint GoodSize(const uint n);
+
+  //! Set up the transform for a nx * ny * nz grid
+  void Init(const uint nx, const uint ny, const uint nz);
+
+  uint Size() const
+  {
+    return n[0] * n[1] * n[2];
+  }
+
+  uint Length(const uint axis) const
+  {
+    return n[axis];
+  }
+
+  //! In place transform of data, which must hold Size() elements
+  void Transform(std::vector< std::complex<double> >& data,
+                 const int sign) const;
+
+private:
+  //! 1D transform of a contiguous line along axis
+  void Line(std::complex<double>* line, const uint axis,
+            const int sign) const;
+
+  uint n[3];
+  std::vector<uint> reverse[3];                  //bit reversed index
+  std::vector< std::complex<double> > twiddle[3]; //exp(-2 pi i k / n)
+};
+
+#endif /*FFT3D_H*/
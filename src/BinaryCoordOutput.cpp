@@ -0,0 +1,138 @@
+/*******************************************************************************
+GPU OPTIMIZED MONTE CARLO (GOMC) 2.40
+Copyright (C) 2018  GOMC Group
+A copy of the GNU General Public License can be found in the COPYRIGHT.txt
+along with this program, also can be found at <http://www.gnu.org/licenses/>.
+********************************************************************************/
+#include "BinaryCoordOutput.h"      //For spec;
+#include "EnsemblePreprocessor.h"   //For BOX_TOTAL, ensemble
+#include "System.h"                 //for init
+#include "StaticVals.h"             //for init
+#include "MoleculeLookup.h"         //for molecules in box and beta
+#include <algorithm>                //for sort
+#include <iostream>                 //for cout;
+
+namespace
+{
+template <typename T>
+void Write(std::ofstream & out, T const& value)
+{
+  out.write(reinterpret_cast<char const*>(&value), sizeof(T));
+}
+
+void WriteString(std::ofstream & out, std::string const& str)
+{
+  Write(out, (uint32_t)str.size());
+  out.write(str.data(), str.size());
+}
+}
+
+BinaryCoordOutput::BinaryCoordOutput(System & sys, StaticVals const& statV) :
+  molLookupRef(sys.molLookupRef), boxDimRef(sys.boxDimRef),
+  molRef(statV.mol), coordCurrRef(sys.coordinates), comCurrRef(sys.com)
+{
+  for (uint b = 0; b < BOX_TOTAL; ++b)
+    frameNumber[b] = 0;
+}
+
+void BinaryCoordOutput::Init(pdb_setup::Atoms const& atoms,
+                             config_setup::Output const& output)
+{
+  enableOut = output.binaryCoord.enable;
+  stepsPerOut = output.binaryCoord.frequency;
+
+  if (enableOut) {
+    for (uint b = 0; b < BOX_TOTAL; ++b) {
+      std::string const& name = output.state.files.binaryCoord.name[b];
+      outF[b].open(name.c_str(), std::ios::out | std::ios::binary |
+                   std::ios::trunc);
+      if (!outF[b].is_open()) {
+        std::cout << "Error: Could not open binary coordinate file "
+                  << name << "!" << std::endl;
+        exit(EXIT_FAILURE);
+      }
+      PrintHeader(b, atoms);
+    }
+    DoOutput(0);
+  }
+}
+
+void BinaryCoordOutput::PrintHeader(const uint b,
+                                    pdb_setup::Atoms const& atoms)
+{
+  outF[b].write(binary_coord::MAGIC, binary_coord::MAGIC_LENGTH);
+  Write(outF[b], binary_coord::VERSION);
+  Write(outF[b], (uint32_t)b);
+  Write(outF[b], (uint32_t)molRef.count);
+  Write(outF[b], (uint32_t)coordCurrRef.Count());
+
+  uint pStart = 0, pEnd = 0;
+  for (uint m = 0; m < molRef.count; ++m) {
+    molRef.GetRangeStartStop(pStart, pEnd, m);
+    Write(outF[b], (uint32_t)(pEnd - pStart));
+    Write(outF[b], (uint32_t)molLookupRef.GetBeta(m));
+    Write(outF[b], molRef.chain[m]);
+    WriteString(outF[b], atoms.resNames[m]);
+    for (uint p = pStart; p < pEnd; ++p) {
+      WriteString(outF[b], atoms.atomAliases[p]);
+    }
+  }
+  outF[b].flush();
+}
+
+void BinaryCoordOutput::DoOutput(const ulong step)
+{
+  for (uint b = 0; b < BOX_TOTAL; ++b) {
+    PrintFrame(b, step);
+  }
+}
+
+void BinaryCoordOutput::PrintFrame(const uint b, const ulong step)
+{
+  //molecules in ascending order, like the PDB trajectory
+  molInBox.clear();
+  MoleculeLookup::box_iterator m = molLookupRef.BoxBegin(b),
+                               end = molLookupRef.BoxEnd(b);
+  while (m != end) {
+    molInBox.push_back(*m);
+    ++m;
+  }
+  std::sort(molInBox.begin(), molInBox.end());
+
+  coords.clear();
+  uint pStart = 0, pEnd = 0;
+  for (uint i = 0; i < molInBox.size(); ++i) {
+    uint mI = molInBox[i];
+    molRef.GetRangeStartStop(pStart, pEnd, mI);
+    XYZ ref = comCurrRef.Get(mI);
+    for (uint p = pStart; p < pEnd; ++p) {
+      XYZ coor = coordCurrRef.Get(p);
+      boxDimRef.UnwrapPBC(coor, b, ref);
+      coords.push_back((float)coor.x);
+      coords.push_back((float)coor.y);
+      coords.push_back((float)coor.z);
+    }
+  }
+
+  XYZ axis = boxDimRef.axis.Get(b);
+  double dim[6] = { axis.x, axis.y, axis.z,
+                    ConvAng(boxDimRef.cosAngle[b][0]),
+                    ConvAng(boxDimRef.cosAngle[b][1]),
+                    ConvAng(boxDimRef.cosAngle[b][2])
+                  };
+
+  frameNumber[b]++;
+  Write(outF[b], frameNumber[b]);
+  Write(outF[b], (uint64_t)(step + 1));
+  outF[b].write(reinterpret_cast<char const*>(dim), sizeof(dim));
+  Write(outF[b], (uint32_t)molInBox.size());
+  Write(outF[b], (uint32_t)(coords.size() / 3));
+  if (!molInBox.empty())
+    outF[b].write(reinterpret_cast<char const*>(&molInBox[0]),
+                  molInBox.size() * sizeof(uint32_t));
+  if (!coords.empty())
+    outF[b].write(reinterpret_cast<char const*>(&coords[0]),
+                  coords.size() * sizeof(float));
+  //keep whole frames on disk, a reader drops a partly written one
+  outF[b].flush();
+}
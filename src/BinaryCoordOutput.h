@@ -0,0 +1,72 @@
+/*******************************************************************************
+GPU OPTIMIZED MONTE CARLO (GOMC) 2.40
+Copyright (C) 2018  GOMC Group
+A copy of the GNU General Public License can be found in the COPYRIGHT.txt
+along with this program, also can be found at <http://www.gnu.org/licenses/>.
+********************************************************************************/
+#ifndef BINARY_COORD_OUTPUT_H
+#define BINARY_COORD_OUTPUT_H
+
+#include <vector>
+#include <fstream>
+#include <stdint.h>
+
+#include "BasicTypes.h" //For uint
+
+#include "OutputAbstracts.h"
+#include "Molecules.h"
+#include "Coordinates.h"
+#include "BinaryCoordSetup.h" //For file layout
+
+class System;
+namespace config_setup
+{
+struct Output;
+}
+class MoleculeLookup;
+
+//Single precision coordinate trajectory, one file per box, see
+//BinaryCoordSetup.h for the layout. Much smaller and faster to write than
+//the PDB trajectory and can be read back by RecalculateTrajectory.
+struct BinaryCoordOutput : OutputableBase {
+public:
+  BinaryCoordOutput(System & sys, StaticVals const& statV);
+
+  ~BinaryCoordOutput()
+  {
+    for (uint b = 0; b < BOX_TOTAL; ++b) {
+      if (outF[b].is_open())
+        outF[b].close();
+    }
+  }
+
+  //Trajectory does not need to sample on every step, so does nothing.
+  virtual void Sample(const ulong step) {}
+
+  virtual void Init(pdb_setup::Atoms const& atoms,
+                    config_setup::Output const& output);
+
+  virtual void DoOutput(const ulong step);
+private:
+  void PrintHeader(const uint b, pdb_setup::Atoms const& atoms);
+
+  void PrintFrame(const uint b, const ulong step);
+
+  double ConvAng(const double t)
+  {
+    return acos(t) * 180.0 / M_PI;
+  }
+
+  MoleculeLookup & molLookupRef;
+  BoxDimensions& boxDimRef;
+  Molecules const& molRef;
+  Coordinates & coordCurrRef;
+  COM & comCurrRef;
+
+  std::ofstream outF[BOX_TOTAL];
+  uint32_t frameNumber[BOX_TOTAL];
+  std::vector<uint32_t> molInBox;
+  std::vector<float> coords;
+};
+
+#endif /*BINARY_COORD_OUTPUT_H*/
@@ -0,0 +1,208 @@
+/*******************************************************************************
+GPU OPTIMIZED MONTE CARLO (GOMC) 2.40
+Copyright (C) 2018  GOMC Group
+A copy of the GNU General Public License can be found in the COPYRIGHT.txt
+along with this program, also can be found at <http://www.gnu.org/licenses/>.
+********************************************************************************/
+#include "BinaryCoordSetup.h"
+#include "PDBSetup.h" //For atoms, cryst1 and remarks
+#include <cstring> //for memcmp
+#include <stdlib.h> //for exit
+#include <iostream>
+
+namespace
+{
+template <typename T>
+void Read(std::ifstream & file, T & value)
+{
+  file.read(reinterpret_cast<char *>(&value), sizeof(T));
+}
+
+void ReadString(std::ifstream & file, std::string & str)
+{
+  uint32_t length = 0;
+  Read(file, length);
+  str.resize(length);
+  if(length != 0)
+    file.read(&str[0], length);
+}
+}
+
+bool BinaryCoordSetup::Init(std::string const& name, const uint b)
+{
+  if(file.is_open() && name == fileName)
+    return true;
+
+  std::ifstream test(name.c_str(), std::ios::in | std::ios::binary);
+  char magic[binary_coord::MAGIC_LENGTH];
+  if(!test.read(magic, binary_coord::MAGIC_LENGTH) ||
+      memcmp(magic, binary_coord::MAGIC, binary_coord::MAGIC_LENGTH) != 0) {
+    return false;
+  }
+  test.close();
+
+  if(file.is_open())
+    file.close();
+  file.clear();
+  fileName = name;
+  box = b;
+  file.open(fileName.c_str(), std::ios::in | std::ios::binary);
+  CheckFile("open");
+  ReadHeader();
+  IndexFrames();
+  std::cout << "Reading binary coordinate file " << fileName << " with "
+            << frameSteps.size() << " frames" << std::endl;
+  return true;
+}
+
+void BinaryCoordSetup::CheckFile(std::string const& what)
+{
+  if(!file.good()) {
+    std::cout << "Error: Could not " << what << " binary coordinate file "
+              << fileName << "!" << std::endl;
+    exit(EXIT_FAILURE);
+  }
+}
+
+void BinaryCoordSetup::ReadHeader(void)
+{
+  char magic[binary_coord::MAGIC_LENGTH];
+  uint32_t version, fileBox, molCount, atomCount;
+  file.read(magic, binary_coord::MAGIC_LENGTH);
+  Read(file, version);
+  Read(file, fileBox);
+  Read(file, molCount);
+  Read(file, atomCount);
+  CheckFile("read the header of");
+
+  if(version != binary_coord::VERSION) {
+    std::cout << "Error: Binary coordinate file " << fileName
+              << " has version " << version << ", expected "
+              << binary_coord::VERSION << "!" << std::endl;
+    exit(EXIT_FAILURE);
+  }
+  if(fileBox != box) {
+    std::cout << "Error: Binary coordinate file " << fileName
+              << " was written for box " << fileBox << ", not box " << box
+              << "!" << std::endl;
+    exit(EXIT_FAILURE);
+  }
+
+  molStart.assign(1, 0);
+  molBeta.resize(molCount);
+  molChain.resize(molCount);
+  resName.resize(molCount);
+  atomAlias.resize(atomCount);
+  for(uint m = 0; m < molCount; m++) {
+    uint32_t length, beta;
+    Read(file, length);
+    Read(file, beta);
+    Read(file, molChain[m]);
+    ReadString(file, resName[m]);
+    molBeta[m] = beta;
+    uint start = molStart.back();
+    molStart.push_back(start + length);
+    if(molStart.back() > atomCount) {
+      std::cout << "Error: Binary coordinate file " << fileName
+                << " has more atoms than its header says!" << std::endl;
+      exit(EXIT_FAILURE);
+    }
+    for(uint p = start; p < molStart.back(); p++)
+      ReadString(file, atomAlias[p]);
+  }
+  CheckFile("read the molecules of");
+}
+
+void BinaryCoordSetup::IndexFrames(void)
+{
+  std::streampos first = file.tellg();
+  file.seekg(0, std::ios::end);
+  std::streamoff size = file.tellg();
+  file.seekg(first);
+
+  frameOffset.clear();
+  frameSteps.clear();
+  while(true) {
+    std::streampos start = file.tellg();
+    uint32_t frame, molCount, atomCount;
+    uint64_t step;
+    Read(file, frame);
+    Read(file, step);
+    //skip box dimensions
+    file.seekg(6 * sizeof(double), std::ios::cur);
+    Read(file, molCount);
+    Read(file, atomCount);
+    if(!file.good())
+      break;
+
+    std::streamoff end = std::streamoff(file.tellg()) +
+                         (std::streamoff)molCount * sizeof(uint32_t) +
+                         (std::streamoff)atomCount * 3 * sizeof(float);
+    //a partly written last frame is dropped
+    if(end > size)
+      break;
+    frameOffset.push_back(start);
+    frameSteps.push_back(step);
+    file.seekg(end);
+  }
+  file.clear();
+}
+
+void BinaryCoordSetup::ReadFrame(const uint frameNum, pdb_setup::Atoms & atoms,
+                                 pdb_setup::Cryst1 & cryst,
+                                 pdb_setup::Remarks & remarks)
+{
+  if(frameNum == 0 || frameNum > frameOffset.size()) {
+    std::cout << "Error: Recalculate Trajectory is active..." << std::endl
+              << ".. and couldn't find frame " << frameNum
+              << " in binary coordinate file " << fileName << "!"
+              << std::endl;
+    exit(EXIT_FAILURE);
+  }
+
+  uint32_t frame, molCount, atomCount;
+  uint64_t step;
+  double axis[3], angle[3];
+  file.clear();
+  file.seekg(frameOffset[frameNum - 1]);
+  Read(file, frame);
+  Read(file, step);
+  file.read(reinterpret_cast<char *>(axis), sizeof(axis));
+  file.read(reinterpret_cast<char *>(angle), sizeof(angle));
+  Read(file, molCount);
+  Read(file, atomCount);
+
+  std::vector<uint32_t> mols(molCount);
+  std::vector<float> coords(3 * atomCount);
+  if(molCount != 0)
+    file.read(reinterpret_cast<char *>(&mols[0]),
+              molCount * sizeof(uint32_t));
+  if(atomCount != 0)
+    file.read(reinterpret_cast<char *>(&coords[0]),
+              coords.size() * sizeof(float));
+  CheckFile("read a frame of");
+
+  remarks.frameNumber[box] = frame;
+  remarks.step[box] = step;
+  remarks.reached[box] = true;
+  cryst.hasVolume = true;
+  cryst.axis.Set(box, axis[0], axis[1], axis[2]);
+  for(uint i = 0; i < 3; i++)
+    cryst.cellAngle[box][i] = angle[i];
+
+  uint n = 0;
+  for(uint i = 0; i < molCount; i++) {
+    uint m = mols[i];
+    if(m + 1 >= molStart.size() ||
+        n + 3 * (molStart[m + 1] - molStart[m]) > coords.size()) {
+      std::cout << "Error: Frame " << frameNum << " of binary coordinate file "
+                << fileName << " is corrupted!" << std::endl;
+      exit(EXIT_FAILURE);
+    }
+    //molecule index as residue number, so every molecule starts a residue
+    for(uint p = molStart[m]; p < molStart[m + 1]; p++, n += 3) {
+      atoms.Assign(atomAlias[p], resName[m], m + 1, molChain[m],
+                   coords[n], coords[n + 1], coords[n + 2], box, molBeta[m]);
+    }
+  }
+}
@@ -0,0 +1,89 @@
+/*******************************************************************************
+GPU OPTIMIZED MONTE CARLO (GOMC) 2.40
+Copyright (C) 2018  GOMC Group
+A copy of the GNU General Public License can be found in the COPYRIGHT.txt
+along with this program, also can be found at <http://www.gnu.org/licenses/>.
+********************************************************************************/
+#ifndef BINARY_COORD_SETUP_H
+#define BINARY_COORD_SETUP_H
+
+#include <vector>
+#include <string>
+#include <fstream>
+#include <stdint.h>
+
+#include "BasicTypes.h" //For uint, ulong
+
+namespace pdb_setup
+{
+class Atoms;
+struct Cryst1;
+struct Remarks;
+}
+
+//
+//    Binary coordinate trajectory, written by BinaryCoordOutput, one file
+//    per box. Values are stored in the byte order of the machine that
+//    wrote them.
+//
+//    Header:
+//      char[8] MAGIC, uint32 VERSION, uint32 box,
+//      uint32 molecule count, uint32 atom count,
+//      per molecule: uint32 atoms, uint32 beta, char chain,
+//                    string residue name, string alias of each atom
+//    Frame:
+//      uint32 frame number, uint64 step,
+//      double axis[3], double cell angles[3] (degree),
+//      uint32 molecules in box, uint32 atoms in box,
+//      uint32 index of each molecule in box (ascending),
+//      float x, y, z of each atom of those molecules (unwrapped)
+//
+//    Strings are a uint32 length followed by the characters.
+//
+namespace binary_coord
+{
+static const char MAGIC[] = "GOMCBCRD";
+static const uint MAGIC_LENGTH = 8;
+static const uint32_t VERSION = 1;
+}
+
+class BinaryCoordSetup
+{
+public:
+  BinaryCoordSetup(void) : box(0) {}
+
+  //Load the header and frame index of name, if it is a binary coordinate
+  //file. Returns false for any other file. Does nothing if name is
+  //already loaded.
+  bool Init(std::string const& name, const uint b);
+
+  std::vector<ulong> const& FrameSteps(void) const
+  {
+    return frameSteps;
+  }
+
+  //Fill atoms, box dimensions and remarks of the box with frame frameNum
+  //(1 based), in the same order PDBSetup reads a PDB trajectory frame
+  void ReadFrame(const uint frameNum, pdb_setup::Atoms & atoms,
+                 pdb_setup::Cryst1 & cryst, pdb_setup::Remarks & remarks);
+
+private:
+  void ReadHeader(void);
+  void IndexFrames(void);
+  void CheckFile(std::string const& what);
+
+  std::string fileName;
+  std::ifstream file;
+  uint box;
+
+  //topology of every molecule, by molecule index
+  std::vector<uint> molStart;      //first atom, size is molecule count + 1
+  std::vector<double> molBeta;
+  std::vector<char> molChain;
+  std::vector<std::string> resName, atomAlias;
+
+  std::vector<std::streampos> frameOffset;
+  std::vector<ulong> frameSteps;
+};
+
+#endif /*BINARY_COORD_SETUP_H*/
@@ -9,7 +9,8 @@ along with this program, also can be found at <http://www.gnu.org/licenses/>.
 #include "CPUSide.h" //Spec declaration
 
 CPUSide::CPUSide(System & sys, StaticVals & statV) :
-  varRef(sys, statV), pdb(sys, statV), console(varRef), block(varRef),
+  varRef(sys, statV), pdb(sys, statV), binaryCoord(sys, statV),
+  console(varRef), block(varRef),
   hist(varRef), checkpoint(sys, statV)
 #if ENSEMBLE == GCMC
   , sample_N_E(varRef)
@@ -26,6 +27,8 @@ void CPUSide::Init(PDBSetup const& pdbSet, config_setup::Output const& out,
   timer.Init(out.console.frequency, totSteps, startStep);
   outObj.push_back(&console);
   outObj.push_back(&pdb);
+  if (out.binaryCoord.enable)
+    outObj.push_back(&binaryCoord);
   if (out.statistics.settings.block.enable)
     outObj.push_back(&block);
   if (out.checkpoint.enable)
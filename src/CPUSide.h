@@ -11,6 +11,7 @@ along with this program, also can be found at <http://www.gnu.org/licenses/>.
 #include "Clock.h"
 #include "ConsoleOutput.h"
 #include "PDBOutput.h"
+#include "BinaryCoordOutput.h"
 #include "BlockOutput.h"
 #include "HistOutput.h"
 #include "ConfigSetup.h"
@@ -36,6 +37,7 @@ private:
   std::vector<OutputableBase *> outObj;
   ConsoleOutput console;
   PDBOutput pdb;
+  BinaryCoordOutput binaryCoord;
   BlockAverages block;
   Histogram hist;
   CheckpointOutput checkpoint;
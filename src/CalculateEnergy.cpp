@@ -14,6 +14,10 @@ along with this program, also can be found at <http://www.gnu.org/licenses/>.
 #include "System.h"                 //For init
 #include "StaticVals.h"             //For init
 #include "Forcefield.h"             //
+#include "FFShift.h"                //For kernel flavors
+#include "FFSwitch.h"
+#include "FFSwitchMartini.h"
+#include "FFTable.h"
 #include "MoleculeLookup.h"
 #include "MoleculeKind.h"
 #include "Coordinates.h"
@@ -22,7 +26,12 @@ along with this program, also can be found at <http://www.gnu.org/licenses/>.
 #include "TrialMol.h"
 #include "GeomLib.h"
 #include "NumLib.h"
+#include "PairBatch.h"
+#include "Profiler.h"
+#include "Parallel.h"
 #include <cassert>
+#include <algorithm>
+#include <typeinfo>
 #ifdef GOMC_CUDA
 #include "CalculateEnergyCUDAKernel.cuh"
 #include "CalculateForceCUDAKernel.cuh"
@@ -41,6 +50,132 @@ along with this program, also can be found at <http://www.gnu.org/licenses/>.
 
 using namespace geom;
 
+namespace
+{
+//Calls the pair functions of the exact flavor FF without virtual dispatch,
+//so they can be inlined into the kernels' pair loops.
+template <class FF>
+struct DirectPair {
+  DirectPair(Forcefield const& forcefield) :
+    ff(static_cast<FF const&>(*forcefield.particles)) {}
+
+  double CalcEn(const double distSq, const uint kind1, const uint kind2) const
+  {
+    return ff.FF::CalcEn(distSq, kind1, kind2);
+  }
+  double CalcVir(const double distSq, const uint kind1, const uint kind2) const
+  {
+    return ff.FF::CalcVir(distSq, kind1, kind2);
+  }
+  double CalcCoulomb(const double distSq, const double qi_qj_Fact,
+                     const uint b) const
+  {
+    return ff.FF::CalcCoulomb(distSq, qi_qj_Fact, b);
+  }
+  double CalcCoulombVir(const double distSq, const double qi_qj,
+                        const uint b) const
+  {
+    return ff.FF::CalcCoulombVir(distSq, qi_qj, b);
+  }
+  double CalcCoulombEwald(const double distSq, const double qi_qj_Fact,
+                          const uint b) const
+  {
+    return ff.CalcCoulombEwald(distSq, qi_qj_Fact, b);
+  }
+  double CalcCoulombVirEwald(const double distSq, const double qi_qj,
+                             const uint b) const
+  {
+    return ff.CalcCoulombVirEwald(distSq, qi_qj, b);
+  }
+
+  FF const& ff;
+};
+
+//Fallback for flavors without a kernel, uses the virtual interface.
+struct VirtualPair {
+  VirtualPair(Forcefield const& forcefield) : ff(*forcefield.particles) {}
+
+  double CalcEn(const double distSq, const uint kind1, const uint kind2) const
+  {
+    return ff.CalcEn(distSq, kind1, kind2);
+  }
+  double CalcVir(const double distSq, const uint kind1, const uint kind2) const
+  {
+    return ff.CalcVir(distSq, kind1, kind2);
+  }
+  double CalcCoulomb(const double distSq, const double qi_qj_Fact,
+                     const uint b) const
+  {
+    return ff.CalcCoulomb(distSq, qi_qj_Fact, b);
+  }
+  double CalcCoulombVir(const double distSq, const double qi_qj,
+                        const uint b) const
+  {
+    return ff.CalcCoulombVir(distSq, qi_qj, b);
+  }
+  double CalcCoulombEwald(const double distSq, const double qi_qj_Fact,
+                          const uint b) const
+  {
+    return ff.CalcCoulomb(distSq, qi_qj_Fact, b);
+  }
+  double CalcCoulombVirEwald(const double distSq, const double qi_qj,
+                             const uint b) const
+  {
+    return ff.CalcCoulombVir(distSq, qi_qj, b);
+  }
+
+  FFParticle const& ff;
+};
+
+//Spline tables of any flavor (PairTable), pairs closer than the first knot
+//use the flavor's own functions.
+struct TablePair {
+  TablePair(Forcefield const& forcefield) :
+    ff(*forcefield.particles), table(*forcefield.pairTable) {}
+
+  double CalcEn(const double distSq, const uint kind1, const uint kind2) const
+  {
+    if (table.Below(distSq))
+      return ff.CalcEn(distSq, kind1, kind2);
+    return table.CalcEn(distSq, kind1, kind2);
+  }
+  double CalcVir(const double distSq, const uint kind1, const uint kind2) const
+  {
+    if (table.Below(distSq))
+      return ff.CalcVir(distSq, kind1, kind2);
+    return table.CalcVir(distSq, kind1, kind2);
+  }
+  double CalcCoulomb(const double distSq, const double qi_qj_Fact,
+                     const uint b) const
+  {
+    if (table.Below(distSq))
+      return ff.CalcCoulomb(distSq, qi_qj_Fact, b);
+    return table.CalcCoulomb(distSq, qi_qj_Fact, b);
+  }
+  double CalcCoulombVir(const double distSq, const double qi_qj,
+                        const uint b) const
+  {
+    if (table.Below(distSq))
+      return ff.CalcCoulombVir(distSq, qi_qj, b);
+    return table.CalcCoulombVir(distSq, qi_qj, b);
+  }
+  //the Coulomb table is the Ewald real space term when Ewald is on
+  double CalcCoulombEwald(const double distSq, const double qi_qj_Fact,
+                          const uint b) const
+  {
+    return CalcCoulomb(distSq, qi_qj_Fact, b);
+  }
+  double CalcCoulombVirEwald(const double distSq, const double qi_qj,
+                             const uint b) const
+  {
+    return CalcCoulombVir(distSq, qi_qj, b);
+  }
+
+  FFParticle const& ff;
+  FFTable const& table;
+};
+}
+
 CalculateEnergy::CalculateEnergy(StaticVals & stat, System & sys) :
   forcefield(stat.forcefield), mols(stat.mol), currentCoords(sys.coordinates),
   currentCOM(sys.com),
@@ -54,7 +189,15 @@ CalculateEnergy::CalculateEnergy(StaticVals & stat, System & sys) :
 #else
   currentAxes(*stat.GetBoxDim())
 #endif
-  , cellList(sys.cellList) {}
+  , cellList(sys.cellList), frameworkGrid(sys.frameworkGrid),
+  verletList(sys.verletList), scratch(sys.scratch),
+  boxInterKernel(NULL), forceKernel(NULL), boxCellKernel(NULL),
+  forceCellKernel(NULL), atomForceKernel(NULL),
+  trialInterKernel(NULL), trackVirial(false)
+{
+  for (uint b = 0; b < BOX_TOTAL; ++b)
+    virialStale[b] = true;
+}
 
 
 void CalculateEnergy::Init(System & sys)
@@ -62,6 +205,7 @@ void CalculateEnergy::Init(System & sys)
   uint maxAtomInMol = 0;
   calcEwald = sys.GetEwald();
   electrostatic = forcefield.electrostatic;
+  trackVirial = sys.statV.simEventFreq.virialTracking;
   for(uint m = 0; m < mols.count; ++m) {
     const MoleculeKind& molKind = mols.GetKind(m);
     if(molKind.NumAtoms() > maxAtomInMol)
@@ -72,6 +216,7 @@ void CalculateEnergy::Init(System & sys)
       particleCharge.push_back(molKind.AtomCharge(a));
     }
   }
+  InitKernels();
 #ifdef GOMC_CUDA
   InitCoordinatesCUDA(forcefield.particles->getCUDAVars(),
                       currentCoords.Count(), maxAtomInMol, currentCOM.Count());
@@ -80,43 +225,36 @@ void CalculateEnergy::Init(System & sys)
 
 SystemPotential CalculateEnergy::SystemTotal()
 {
-  SystemPotential pot =
-    SystemInter(SystemPotential(), currentCoords, currentCOM, currentAxes);
-
-  //system intra
-  for (uint b = 0; b < BOX_TOTAL; ++b) {
-    pot.boxVirial[b] = ForceCalc(b);
-    int i;
-    double bondEnergy[2] = {0};
-    double bondEn = 0.0, nonbondEn = 0.0, self = 0.0, correction = 0.0;
-    MoleculeLookup::box_iterator thisMol = molLookup.BoxBegin(b);
-    MoleculeLookup::box_iterator end = molLookup.BoxEnd(b);
-    std::vector<uint> molID;
-
-    while (thisMol != end) {
-      molID.push_back(*thisMol);
-      ++thisMol;
-    }
+  PROFILE_SCOPE(prof::SYSTEM_TOTAL);
+  SystemPotential pot, boxPot[BOX_TOTAL];
+  int b, threads[BOX_TOTAL];
+  ulong work[BOX_TOTAL];
+
+  //a rebuild bins all boxes in the grid of the list, so it is done first
+  if (verletList.IsEnabled()) {
+    for (b = 0; b < BOXES_WITH_U_NB; ++b)
+      verletList.Update(currentCoords, molLookup, b);
+  }
+
+  for (b = 0; b < BOX_TOTAL; ++b)
+    work[b] = BoxWork(b);
+  bool split = par::Split(threads, work, BOX_TOTAL);
 
 #ifdef _OPENMP
-    #pragma omp parallel for default(shared) private(i, bondEnergy) reduction(+:bondEn, nonbondEn, correction)
+  #pragma omp parallel for num_threads(BOX_TOTAL) schedule(static, 1) if(split)
 #endif
-    for (i = 0; i < molID.size(); i++) {
-      //calculate nonbonded energy
-      MoleculeIntra(molID[i], b, bondEnergy);
-      bondEn += bondEnergy[0];
-      nonbondEn += bondEnergy[1];
-      //calculate correction term of electrostatic interaction
-      correction += calcEwald->MolCorrection(molID[i], b);
-    }
-
-    pot.boxEnergy[b].intraBond = bondEn;
-    pot.boxEnergy[b].intraNonbond = nonbondEn;
-    //calculate self term of electrostatic interaction
-    pot.boxEnergy[b].self = calcEwald->BoxSelf(currentAxes, b);
-    pot.boxEnergy[b].correction = -1 * correction * num::qqFact;
+  for (b = 0; b < BOX_TOTAL; ++b) {
+#ifdef _OPENMP
+    if (split)
+      omp_set_num_threads(threads[b]);
+#endif
+    BoxTotal(boxPot[b], b);
   }
 
+  for (b = 0; b < BOX_TOTAL; ++b) {
+    pot.boxEnergy[b] = boxPot[b].boxEnergy[b];
+    pot.boxVirial[b] = boxPot[b].boxVirial[b];
+  }
   pot.Total();
 
   if(pot.totalEnergy.total > 1.0e12) {
@@ -130,6 +268,107 @@ SystemPotential CalculateEnergy::SystemTotal()
   return pot;
 }
 
+void CalculateEnergy::BoxTotal(SystemPotential& pot, const uint box)
+{
+  int i;
+  double bondEnergy[2] = {0};
+  double bondEn = 0.0, nonbondEn = 0.0, correction = 0.0;
+
+  //calculate LJ interaction and real term of electrostatic interaction
+  pot = BoxInter(pot, currentCoords, currentCOM, currentAxes, box);
+  //calculate reciprocate term of electrostatic interaction
+  if (box < BOXES_WITH_U_NB)
+    pot.boxEnergy[box].recip = calcEwald->BoxReciprocal(box);
+  pot.boxVirial[box] = ForceCalc(box);
+
+  //box intra
+  MoleculeLookup::box_iterator thisMol = molLookup.BoxBegin(box);
+  MoleculeLookup::box_iterator end = molLookup.BoxEnd(box);
+  std::vector<uint>& molID = scratch.Get().molID;
+  molID.clear();
+
+  while (thisMol != end) {
+    molID.push_back(*thisMol);
+    ++thisMol;
+  }
+
+#ifdef _OPENMP
+  #pragma omp parallel for default(shared) private(i, bondEnergy) reduction(+:bondEn, nonbondEn, correction)
+#endif
+  for (i = 0; i < molID.size(); i++) {
+    //calculate nonbonded energy
+    MoleculeIntra(molID[i], box, bondEnergy);
+    bondEn += bondEnergy[0];
+    nonbondEn += bondEnergy[1];
+    //calculate correction term of electrostatic interaction
+    correction += calcEwald->MolCorrection(molID[i], box);
+  }
+
+  pot.boxEnergy[box].intraBond = bondEn;
+  pot.boxEnergy[box].intraNonbond = nonbondEn;
+  //calculate self term of electrostatic interaction
+  pot.boxEnergy[box].self = calcEwald->BoxSelf(currentAxes, box);
+  pot.boxEnergy[box].correction = -1 * correction * num::qqFact;
+}
+
+ulong CalculateEnergy::BoxWork(const uint box) const
+{
+  ulong atoms = 0, work;
+  for (uint k = 0; k < mols.GetKindsCount(); k++)
+    atoms += mols.kinds[k].NumAtoms() * molLookup.NumKindInBox(k, box);
+  work = atoms;
+  if (box < BOXES_WITH_U_NB)
+    work += cellList.ShellPairs(box) + atoms * calcEwald->ImageSize(box);
+  return work;
+}
+
+void CalculateEnergy::InitKernels()
+{
+  FFParticle const& ff = *forcefield.particles;
+  bool ewald = forcefield.ewald;
+
+  //the table holds whichever Coulomb term the flavor uses
+  if (forcefield.pairTable != NULL) {
+    SetKernels<TablePair, false>();
+    return;
+  }
+
+  if (typeid(ff) == typeid(FFParticle)) {
+    if (ewald)
+      SetKernels<DirectPair<FFParticle>, true>();
+    else
+      SetKernels<DirectPair<FFParticle>, false>();
+  } else if (typeid(ff) == typeid(FF_SHIFT)) {
+    if (ewald)
+      SetKernels<DirectPair<FF_SHIFT>, true>();
+    else
+      SetKernels<DirectPair<FF_SHIFT>, false>();
+  } else if (typeid(ff) == typeid(FF_SWITCH)) {
+    if (ewald)
+      SetKernels<DirectPair<FF_SWITCH>, true>();
+    else
+      SetKernels<DirectPair<FF_SWITCH>, false>();
+  } else if (typeid(ff) == typeid(FF_SWITCH_MARTINI)) {
+    if (ewald)
+      SetKernels<DirectPair<FF_SWITCH_MARTINI>, true>();
+    else
+      SetKernels<DirectPair<FF_SWITCH_MARTINI>, false>();
+  } else {
+    SetKernels<VirtualPair, false>();
+  }
+}
+
+template <class PAIR, bool EWALD>
+void CalculateEnergy::SetKernels()
+{
+  boxInterKernel = &CalculateEnergy::BoxInterKernel<PAIR, EWALD>;
+  forceKernel = &CalculateEnergy::ForceKernel<PAIR, EWALD>;
+  boxCellKernel = &CalculateEnergy::BoxCellKernel<PAIR, EWALD>;
+  forceCellKernel = &CalculateEnergy::ForceCellKernel<PAIR, EWALD>;
+  atomForceKernel = &CalculateEnergy::AtomForceKernel<PAIR, EWALD>;
+  trialInterKernel = &CalculateEnergy::TrialInterKernel<PAIR, EWALD>;
+}
+
 
 SystemPotential CalculateEnergy::SystemInter
 (SystemPotential potential,
@@ -162,23 +401,14 @@ SystemPotential CalculateEnergy::BoxInter(SystemPotential potential,
   if (box >= BOXES_WITH_U_NB)
     return potential;
 
+  PROFILE_SCOPE(prof::BOX_INTER);
   double tempREn = 0.0, tempLJEn = 0.0;
-  double distSq, qi_qj_fact;
-  int i;
-  XYZ virComponents;
-  std::vector<uint> pair1, pair2;
-  CellList::Pairs pair = cellList.EnumeratePairs(box);
-
-  //store atom pair index
-  while (!pair.Done()) {
-    if(!SameMolecule(pair.First(), pair.Second())) {
-      pair1.push_back(pair.First());
-      pair2.push_back(pair.Second());
-    }
-    pair.Next();
-  }
+  std::vector<uint>& pair1 = scratch.Get().pair1;
+  std::vector<uint>& pair2 = scratch.Get().pair2;
 
 #ifdef GOMC_CUDA
+  BoxPairs(pair1, pair2, coords, box);
+  PROFILE_COUNT(prof::PAIRS, pair1.size());
   uint pairSize = pair1.size();
   uint currentIndex = 0;
   double REn = 0.0, LJEn = 0.0;
@@ -214,24 +444,20 @@ SystemPotential CalculateEnergy::BoxInter(SystemPotential potential,
   }
 
 #else
-#ifdef _OPENMP
-  #pragma omp parallel for default(shared) private(i, distSq, qi_qj_fact, virComponents) reduction(+:tempREn, tempLJEn)
-#endif
-  for (i = 0; i < pair1.size(); i++) {
-    if(boxAxes.InRcut(distSq, virComponents, coords, pair1[i], pair2[i], box)) {
-      if (electrostatic) {
-        qi_qj_fact = particleCharge[pair1[i]] *
-                     particleCharge[pair2[i]] * num::qqFact;
-
-        tempREn += forcefield.particles->CalcCoulomb(distSq, qi_qj_fact, box);
-      }
-
-      tempLJEn += forcefield.particles->CalcEn(distSq, particleKind[pair1[i]],
-                  particleKind[pair2[i]]);
-    }
+  if (UseVerletList(coords)) {
+    BoxPairs(pair1, pair2, coords, box);
+    PROFILE_COUNT(prof::PAIRS, pair1.size());
+    (this->*boxInterKernel)(tempREn, tempLJEn, pair1, pair2, coords, boxAxes,
+                            box);
+  } else {
+    PROFILE_COUNT(prof::PAIRS, cellList.ShellPairs(box));
+    (this->*boxCellKernel)(tempREn, tempLJEn, coords, boxAxes, box);
   }
 #endif
 
+  if (frameworkGrid.Active(box))
+    FrameworkInter(tempREn, tempLJEn, coords, box);
+
   // setting energy and virial of LJ interaction
   potential.boxEnergy[box].inter = tempLJEn;
   // setting energy and virial of coulomb interaction
@@ -247,11 +473,109 @@ SystemPotential CalculateEnergy::BoxInter(SystemPotential potential,
   return potential;
 }
 
+void CalculateEnergy::FrameworkInter(double& REn, double& LJEn,
+                                     XYZArray const& coords,
+                                     const uint box) const
+{
+  double lj, coulomb;
+  MoleculeLookup::box_iterator thisMol = molLookup.BoxBegin(box);
+  MoleculeLookup::box_iterator end = molLookup.BoxEnd(box);
+  while (thisMol != end) {
+    if (!molLookup.IsFix(*thisMol)) {
+      for (uint p = mols.MolStart(*thisMol); p < mols.MolEnd(*thisMol); ++p) {
+        frameworkGrid.Energy(lj, coulomb, coords[p], particleKind[p], box);
+        LJEn += lj;
+        if (electrostatic)
+          REn += particleCharge[p] * coulomb;
+      }
+    }
+    ++thisMol;
+  }
+  LJEn += frameworkGrid.FixedLJ(box);
+  REn += frameworkGrid.FixedReal(box);
+}
+
+template <class PAIR, bool EWALD>
+void CalculateEnergy::BoxInterKernel(double& REn, double& LJEn,
+                                     std::vector<uint> const& pair1,
+                                     std::vector<uint> const& pair2,
+                                     XYZArray const& coords,
+                                     BoxDimensions const& boxAxes,
+                                     const uint box) const
+{
+  PAIR ff(forcefield);
+  double tempREn = 0.0, tempLJEn = 0.0;
+  double qi_qj_fact;
+  int i, blocks = (pair1.size() + batch::SIZE - 1) / batch::SIZE;
+  uint k, p1, p2, start, count;
+
+#ifdef _OPENMP
+  #pragma omp parallel for default(shared) private(i, k, p1, p2, start, count, qi_qj_fact) reduction(+:tempREn, tempLJEn) if(par::Worth(pair1.size()))
+#endif
+  for (i = 0; i < blocks; i++) {
+    double dx[batch::SIZE], dy[batch::SIZE], dz[batch::SIZE];
+    double distSq[batch::SIZE];
+    start = i * batch::SIZE;
+    count = std::min(batch::SIZE, (uint)pair1.size() - start);
+    batch::PairDist(dx, dy, dz, distSq, boxAxes, coords, &pair1[start],
+                    coords, &pair2[start], count, box);
+
+    for (k = 0; k < count; k++) {
+      if (boxAxes.rCutSq[box] > distSq[k]) {
+        p1 = pair1[start + k];
+        p2 = pair2[start + k];
+        if (electrostatic) {
+          qi_qj_fact = particleCharge[p1] * particleCharge[p2] * num::qqFact;
+
+          if (EWALD)
+            tempREn += ff.CalcCoulombEwald(distSq[k], qi_qj_fact, box);
+          else
+            tempREn += ff.CalcCoulomb(distSq[k], qi_qj_fact, box);
+        }
+
+        tempLJEn += ff.CalcEn(distSq[k], particleKind[p1], particleKind[p2]);
+      }
+    }
+  }
+
+  REn = tempREn;
+  LJEn = tempLJEn;
+}
+
+bool CalculateEnergy::UseVerletList(XYZArray const& coords) const
+{
+  return verletList.IsEnabled() && &coords == &currentCoords;
+}
+
+void CalculateEnergy::BoxPairs(std::vector<uint>& pair1,
+                               std::vector<uint>& pair2,
+                               XYZArray const& coords, const uint box)
+{
+  pair1.clear();
+  pair2.clear();
+  if (UseVerletList(coords)) {
+    verletList.Update(coords, molLookup, box);
+    verletList.GetPairs(pair1, pair2, box);
+    return;
+  }
+
+  CellList::Pairs pair = cellList.EnumeratePairs(box);
+  //store atom pair index
+  while (!pair.Done()) {
+    if(!SameMolecule(pair.First(), pair.Second())) {
+      pair1.push_back(pair.First());
+      pair2.push_back(pair.Second());
+    }
+    pair.Next();
+  }
+}
+
 // NOTE: The calculation of W12, W13, W23 is expensive and would not be
 // requied for pressure and surface tension calculation. So, they have been
 // commented out. In case you need to calculate them, uncomment them.
 Virial CalculateEnergy::ForceCalc(const uint box)
 {
+  PROFILE_SCOPE(prof::FORCE_CALC);
   //store virial and energy of reference and modify the virial
   Virial tempVir;
 
@@ -261,21 +585,12 @@ Virial CalculateEnergy::ForceCalc(const uint box)
   double rT11 = 0.0, rT12 = 0.0, rT13 = 0.0;
   double rT22 = 0.0, rT23 = 0.0, rT33 = 0.0;
 
-  double distSq, pVF, pRF, qi_qj;
-  int i;
-  XYZ virC, comC;
-  std::vector<uint> pair1, pair2;
-  CellList::Pairs pair = cellList.EnumeratePairs(box);
-  //store atom pair index
-  while (!pair.Done()) {
-    if(!SameMolecule(pair.First(), pair.Second())) {
-      pair1.push_back(pair.First());
-      pair2.push_back(pair.Second());
-    }
-    pair.Next();
-  }
+  std::vector<uint>& pair1 = scratch.Get().pair1;
+  std::vector<uint>& pair2 = scratch.Get().pair2;
 
 #ifdef GOMC_CUDA
+  BoxPairs(pair1, pair2, currentCoords, box);
+  PROFILE_COUNT(prof::PAIRS, pair1.size());
   uint pairSize = pair1.size();
   //update unitcell in GPU
   UpdateCellBasisCUDA(forcefield.particles->getCUDAVars(), box,
@@ -325,48 +640,14 @@ Virial CalculateEnergy::ForceCalc(const uint box)
     currentIndex += MAX_PAIR_SIZE;
   }
 #else
-#ifdef _OPENMP
-  #pragma omp parallel for default(shared) private(i, distSq, pVF, pRF, qi_qj, virC, comC) reduction(+:vT11, vT12, vT13, vT22, vT23, vT33, rT11, rT12, rT13, rT22, rT23, rT33)
-#endif
-  for (i = 0; i < pair1.size(); i++) {
-    if (currentAxes.InRcut(distSq, virC, currentCoords, pair1[i],
-                           pair2[i], box)) {
-      pVF = 0.0;
-      pRF = 0.0;
-
-      //calculate the distance between com of two molecule
-      comC = currentCOM.Difference(particleMol[pair1[i]],
-                                   particleMol[pair2[i]]);
-      //calculate the minimum image between com of two molecule
-      comC = currentAxes.MinImage(comC, box);
-
-      if (electrostatic) {
-        qi_qj = particleCharge[pair1[i]] * particleCharge[pair2[i]];
-
-        pRF = forcefield.particles->CalcCoulombVir(distSq, qi_qj, box);
-        //calculate the top diagonal of pressure tensor
-        rT11 += pRF * (virC.x * comC.x);
-        //rT12 += pRF * (0.5 * (virC.x * comC.y + virC.y * comC.x));
-        //rT13 += pRF * (0.5 * (virC.x * comC.z + virC.z * comC.x));
-
-        rT22 += pRF * (virC.y * comC.y);
-        //rT23 += pRF * (0.5 * (virC.y * comC.z + virC.z * comC.y));
-
-        rT33 += pRF * (virC.z * comC.z);
-      }
-
-      pVF = forcefield.particles->CalcVir(distSq, particleKind[pair1[i]],
-                                          particleKind[pair2[i]]);
-      //calculate the top diagonal of pressure tensor
-      vT11 += pVF * (virC.x * comC.x);
-      //vT12 += pVF * (0.5 * (virC.x * comC.y + virC.y * comC.x));
-      //vT13 += pVF * (0.5 * (virC.x * comC.z + virC.z * comC.x));
-
-      vT22 += pVF * (virC.y * comC.y);
-      //vT23 += pVF * (0.5 * (virC.y * comC.z + virC.z * comC.y));
-
-      vT33 += pVF * (virC.z * comC.z);
-    }
+  if (UseVerletList(currentCoords)) {
+    BoxPairs(pair1, pair2, currentCoords, box);
+    PROFILE_COUNT(prof::PAIRS, pair1.size());
+    (this->*forceKernel)(vT11, vT22, vT33, rT11, rT22, rT33, pair1, pair2,
+                         box);
+  } else {
+    PROFILE_COUNT(prof::PAIRS, cellList.ShellPairs(box));
+    (this->*forceCellKernel)(vT11, vT22, vT33, rT11, rT22, rT33, box);
   }
 #endif
 
@@ -398,24 +679,356 @@ Virial CalculateEnergy::ForceCalc(const uint box)
     tempVir.realTens[2][2] = rT33 * num::qqFact;
   }
 
+  FinishVirial(tempVir, box);
+  virialStale[box] = false;
+
+  return tempVir;
+}
+
+Virial CalculateEnergy::ForceUpdate(Virial const& pairVir, const uint box)
+{
+  if (virialStale[box])
+    return ForceCalc(box);
+
+  //moves only keep the diagonal, like the CPU ForceKernel
+  Virial tempVir;
+  for (int i = 0; i < 3; i++) {
+    tempVir.interTens[i][i] = pairVir.interTens[i][i];
+    tempVir.realTens[i][i] = pairVir.realTens[i][i];
+  }
+  FinishVirial(tempVir, box);
+
+  return tempVir;
+}
+
+void CalculateEnergy::FinishVirial(Virial& virial, const uint box) const
+{
   // setting virial of LJ
-  tempVir.inter = vT11 + vT22 + vT33;
+  virial.inter = virial.interTens[0][0] + virial.interTens[1][1] +
+                 virial.interTens[2][2];
   // setting virial of coulomb
-  tempVir.real = (rT11 + rT22 + rT33) * num::qqFact;
+  virial.real = virial.realTens[0][0] + virial.realTens[1][1] +
+                virial.realTens[2][2];
 
   if (forcefield.useLRC) {
-    ForceCorrection(tempVir, currentAxes, box);
+    ForceCorrection(virial, currentAxes, box);
   }
 
   //calculate reciprocate term of force
-  tempVir = calcEwald->ForceReciprocal(tempVir, box);
+  virial = calcEwald->ForceReciprocal(virial, box);
 
-  tempVir.Total();
+  virial.Total();
+}
 
+Virial CalculateEnergy::MoleculeVirial(const uint molIndex,
+                                       const uint box) const
+{
+  Virial tempVir;
+  if (box >= BOXES_WITH_U_NB)
+    return tempVir;
+
+  PROFILE_SCOPE(prof::MOLECULE_VIRIAL);
+  double vT11 = 0.0, vT22 = 0.0, vT33 = 0.0;
+  double rT11 = 0.0, rT22 = 0.0, rT33 = 0.0;
+  uint length = mols.GetKind(molIndex).NumAtoms();
+  uint start = mols.MolStart(molIndex);
+  std::vector<uint>& nIndex = scratch.Get().nIndex;
+
+  for (uint p = 0; p < length; ++p) {
+    uint atom = start + p;
+    double v11, v22, v33, r11, r22, r33;
+    CellList::Neighbors n = cellList.EnumerateLocal(currentCoords[atom], box);
+    nIndex.clear();
+    while (!n.Done()) {
+      nIndex.push_back(*n);
+      n.Next();
+    }
+    PROFILE_COUNT(prof::PAIRS, nIndex.size());
+
+    (this->*atomForceKernel)(v11, v22, v33, r11, r22, r33, atom, nIndex, box);
+    vT11 += v11;
+    vT22 += v22;
+    vT33 += v33;
+    rT11 += r11;
+    rT22 += r22;
+    rT33 += r33;
+  }
+
+  tempVir.interTens[0][0] = vT11;
+  tempVir.interTens[1][1] = vT22;
+  tempVir.interTens[2][2] = vT33;
+  tempVir.inter = vT11 + vT22 + vT33;
+  if (electrostatic) {
+    tempVir.realTens[0][0] = rT11 * num::qqFact;
+    tempVir.realTens[1][1] = rT22 * num::qqFact;
+    tempVir.realTens[2][2] = rT33 * num::qqFact;
+    tempVir.real = (rT11 + rT22 + rT33) * num::qqFact;
+  }
   return tempVir;
 }
 
+template <class PAIR, bool EWALD>
+void CalculateEnergy::ForceKernel(double& vT11, double& vT22, double& vT33,
+                                  double& rT11, double& rT22, double& rT33,
+                                  std::vector<uint> const& pair1,
+                                  std::vector<uint> const& pair2,
+                                  const uint box) const
+{
+  PAIR ff(forcefield);
+  double tvT11 = 0.0, tvT22 = 0.0, tvT33 = 0.0;
+  double trT11 = 0.0, trT22 = 0.0, trT33 = 0.0;
+  double pVF, pRF, qi_qj;
+  int i, blocks = (pair1.size() + batch::SIZE - 1) / batch::SIZE;
+  uint k, p1, p2, start, count;
+  XYZ comC;
+
+#ifdef _OPENMP
+  #pragma omp parallel for default(shared) private(i, k, p1, p2, start, count, pVF, pRF, qi_qj, comC) reduction(+:tvT11, tvT22, tvT33, trT11, trT22, trT33) if(par::Worth(pair1.size()))
+#endif
+  for (i = 0; i < blocks; i++) {
+    double dx[batch::SIZE], dy[batch::SIZE], dz[batch::SIZE];
+    double distSq[batch::SIZE];
+    start = i * batch::SIZE;
+    count = std::min(batch::SIZE, (uint)pair1.size() - start);
+    batch::PairDist(dx, dy, dz, distSq, currentAxes, currentCoords,
+                    &pair1[start], currentCoords, &pair2[start], count, box);
+
+    for (k = 0; k < count; k++) {
+      if (currentAxes.rCutSq[box] > distSq[k]) {
+        p1 = pair1[start + k];
+        p2 = pair2[start + k];
+        pVF = 0.0;
+        pRF = 0.0;
+
+        //calculate the distance between com of two molecule
+        comC = currentCOM.Difference(particleMol[p1], particleMol[p2]);
+        //calculate the minimum image between com of two molecule
+        comC = currentAxes.MinImage(comC, box);
+
+        if (electrostatic) {
+          qi_qj = particleCharge[p1] * particleCharge[p2];
+
+          if (EWALD)
+            pRF = ff.CalcCoulombVirEwald(distSq[k], qi_qj, box);
+          else
+            pRF = ff.CalcCoulombVir(distSq[k], qi_qj, box);
+          //calculate the top diagonal of pressure tensor
+          trT11 += pRF * (dx[k] * comC.x);
+          trT22 += pRF * (dy[k] * comC.y);
+          trT33 += pRF * (dz[k] * comC.z);
+        }
+
+        pVF = ff.CalcVir(distSq[k], particleKind[p1], particleKind[p2]);
+        //calculate the top diagonal of pressure tensor
+        tvT11 += pVF * (dx[k] * comC.x);
+        tvT22 += pVF * (dy[k] * comC.y);
+        tvT33 += pVF * (dz[k] * comC.z);
+      }
+    }
+  }
+
+  vT11 = tvT11;
+  vT22 = tvT22;
+  vT33 = tvT33;
+  rT11 = trT11;
+  rT22 = trT22;
+  rT33 = trT33;
+}
+
+template <class PAIR, bool EWALD>
+void CalculateEnergy::BoxCellKernel(double& REn, double& LJEn,
+                                    XYZArray const& coords,
+                                    BoxDimensions const& boxAxes,
+                                    const uint box) const
+{
+  PAIR ff(forcefield);
+  double tempREn = 0.0, tempLJEn = 0.0;
+  double qi_qj_fact;
+  int c, cells = cellList.CellsInBox(box);
+  uint a, i, j, k, s, own, count;
+
+  //cells hold about the same number of particles, the dynamic schedule
+  //evens out the rest
+#ifdef _OPENMP
+  #pragma omp parallel default(shared) private(a, i, j, k, s, own, count, qi_qj_fact) reduction(+:tempREn, tempLJEn) if(par::Worth(cellList.ShellPairs(box)))
+#endif
+  {
+    std::vector<uint>& shell = scratch.Get().shell;
+    double dx[batch::SIZE], dy[batch::SIZE], dz[batch::SIZE];
+    double distSq[batch::SIZE];
+
+#ifdef _OPENMP
+    #pragma omp for schedule(dynamic)
+#endif
+    for (c = 0; c < cells; c++) {
+      //particle a of the cell pairs with the rest of the half shell
+      own = cellList.HalfShell(shell, c, box);
+      for (a = 0; a < own; a++) {
+        i = shell[a];
+        for (s = a + 1; s < shell.size(); s += batch::SIZE) {
+          count = std::min(batch::SIZE, (uint)shell.size() - s);
+          batch::AtomDist(dx, dy, dz, distSq, boxAxes, coords, i, coords,
+                          &shell[s], count, box);
+
+          for (k = 0; k < count; k++) {
+            j = shell[s + k];
+            if (boxAxes.rCutSq[box] > distSq[k] && !SameMolecule(i, j)) {
+              if (electrostatic) {
+                qi_qj_fact = particleCharge[i] * particleCharge[j] *
+                             num::qqFact;
+
+                if (EWALD)
+                  tempREn += ff.CalcCoulombEwald(distSq[k], qi_qj_fact, box);
+                else
+                  tempREn += ff.CalcCoulomb(distSq[k], qi_qj_fact, box);
+              }
+
+              tempLJEn += ff.CalcEn(distSq[k], particleKind[i],
+                                    particleKind[j]);
+            }
+          }
+        }
+      }
+    }
+  }
+
+  REn = tempREn;
+  LJEn = tempLJEn;
+}
+
+template <class PAIR, bool EWALD>
+void CalculateEnergy::ForceCellKernel(double& vT11, double& vT22,
+                                      double& vT33, double& rT11,
+                                      double& rT22, double& rT33,
+                                      const uint box) const
+{
+  PAIR ff(forcefield);
+  double tvT11 = 0.0, tvT22 = 0.0, tvT33 = 0.0;
+  double trT11 = 0.0, trT22 = 0.0, trT33 = 0.0;
+  double pVF, pRF, qi_qj;
+  int c, cells = cellList.CellsInBox(box);
+  uint a, i, j, k, s, own, count;
+  XYZ comC;
+
+#ifdef _OPENMP
+  #pragma omp parallel default(shared) private(a, i, j, k, s, own, count, pVF, pRF, qi_qj, comC) reduction(+:tvT11, tvT22, tvT33, trT11, trT22, trT33) if(par::Worth(cellList.ShellPairs(box)))
+#endif
+  {
+    std::vector<uint>& shell = scratch.Get().shell;
+    double dx[batch::SIZE], dy[batch::SIZE], dz[batch::SIZE];
+    double distSq[batch::SIZE];
+
+#ifdef _OPENMP
+    #pragma omp for schedule(dynamic)
+#endif
+    for (c = 0; c < cells; c++) {
+      own = cellList.HalfShell(shell, c, box);
+      for (a = 0; a < own; a++) {
+        i = shell[a];
+        for (s = a + 1; s < shell.size(); s += batch::SIZE) {
+          count = std::min(batch::SIZE, (uint)shell.size() - s);
+          batch::AtomDist(dx, dy, dz, distSq, currentAxes, currentCoords, i,
+                          currentCoords, &shell[s], count, box);
+
+          for (k = 0; k < count; k++) {
+            j = shell[s + k];
+            if (currentAxes.rCutSq[box] > distSq[k] && !SameMolecule(i, j)) {
+              //calculate the minimum image between com of two molecule
+              comC = currentCOM.Difference(particleMol[i], particleMol[j]);
+              comC = currentAxes.MinImage(comC, box);
+
+              if (electrostatic) {
+                qi_qj = particleCharge[i] * particleCharge[j];
+
+                if (EWALD)
+                  pRF = ff.CalcCoulombVirEwald(distSq[k], qi_qj, box);
+                else
+                  pRF = ff.CalcCoulombVir(distSq[k], qi_qj, box);
+                trT11 += pRF * (dx[k] * comC.x);
+                trT22 += pRF * (dy[k] * comC.y);
+                trT33 += pRF * (dz[k] * comC.z);
+              }
+
+              pVF = ff.CalcVir(distSq[k], particleKind[i], particleKind[j]);
+              tvT11 += pVF * (dx[k] * comC.x);
+              tvT22 += pVF * (dy[k] * comC.y);
+              tvT33 += pVF * (dz[k] * comC.z);
+            }
+          }
+        }
+      }
+    }
+  }
+
+  vT11 = tvT11;
+  vT22 = tvT22;
+  vT33 = tvT33;
+  rT11 = trT11;
+  rT22 = trT22;
+  rT33 = trT33;
+}
+
+template <class PAIR, bool EWALD>
+void CalculateEnergy::AtomForceKernel(double& vT11, double& vT22,
+                                      double& vT33, double& rT11,
+                                      double& rT22, double& rT33,
+                                      const uint p,
+                                      std::vector<uint> const& nIndex,
+                                      const uint box) const
+{
+  PAIR ff(forcefield);
+  double tvT11 = 0.0, tvT22 = 0.0, tvT33 = 0.0;
+  double trT11 = 0.0, trT22 = 0.0, trT33 = 0.0;
+  double pVF, pRF, qi_qj;
+  int i, blocks = (nIndex.size() + batch::SIZE - 1) / batch::SIZE;
+  uint k, j, start, count;
+  XYZ comC;
 
+#ifdef _OPENMP
+  #pragma omp parallel for default(shared) private(i, k, j, start, count, pVF, pRF, qi_qj, comC) reduction(+:tvT11, tvT22, tvT33, trT11, trT22, trT33) if(par::Worth(nIndex.size()))
+#endif
+  for (i = 0; i < blocks; i++) {
+    double dx[batch::SIZE], dy[batch::SIZE], dz[batch::SIZE];
+    double distSq[batch::SIZE];
+    start = i * batch::SIZE;
+    count = std::min(batch::SIZE, (uint)nIndex.size() - start);
+    batch::AtomDist(dx, dy, dz, distSq, currentAxes, currentCoords, p,
+                    currentCoords, &nIndex[start], count, box);
+
+    for (k = 0; k < count; k++) {
+      j = nIndex[start + k];
+      if (currentAxes.rCutSq[box] > distSq[k] && !SameMolecule(p, j)) {
+        //calculate the minimum image between com of two molecule
+        comC = currentCOM.Difference(particleMol[p], particleMol[j]);
+        comC = currentAxes.MinImage(comC, box);
+
+        if (electrostatic) {
+          qi_qj = particleCharge[p] * particleCharge[j];
+
+          if (EWALD)
+            pRF = ff.CalcCoulombVirEwald(distSq[k], qi_qj, box);
+          else
+            pRF = ff.CalcCoulombVir(distSq[k], qi_qj, box);
+          trT11 += pRF * (dx[k] * comC.x);
+          trT22 += pRF * (dy[k] * comC.y);
+          trT33 += pRF * (dz[k] * comC.z);
+        }
+
+        pVF = ff.CalcVir(distSq[k], particleKind[p], particleKind[j]);
+        tvT11 += pVF * (dx[k] * comC.x);
+        tvT22 += pVF * (dy[k] * comC.y);
+        tvT33 += pVF * (dz[k] * comC.z);
+      }
+    }
+  }
+
+  vT11 = tvT11;
+  vT22 = tvT22;
+  vT33 = tvT33;
+  rT11 = trT11;
+  rT22 = trT22;
+  rT33 = trT33;
+}
 
 bool CalculateEnergy::MoleculeInter(Intermolecular &inter_LJ,
                                     Intermolecular &inter_coulomb,
@@ -426,86 +1039,135 @@ bool CalculateEnergy::MoleculeInter(Intermolecular &inter_LJ,
   double tempREn = 0.0, tempLJEn = 0.0;
   bool overlap = false;
   if (box < BOXES_WITH_U_NB) {
+    PROFILE_SCOPE(prof::MOLECULE_INTER);
     uint length = mols.GetKind(molIndex).NumAtoms();
     uint start = mols.MolStart(molIndex);
-
+    ScratchBuffers& buf = scratch.Get();
+    TrialNeighbors& nb = buf.neighbors;
+    XYZArray& pos = buf.Positions(length * 2);
+
+    //old position of each atom followed by its new one, so the neighbors
+    //of the whole molecule go through a single parallel loop
+    nb.kind.resize(length * 2);
+    nb.charge.resize(length * 2);
     for (uint p = 0; p < length; ++p) {
       uint atom = start + p;
-      CellList::Neighbors n = cellList.EnumerateLocal(currentCoords[atom],
-                              box);
-      n = cellList.EnumerateLocal(currentCoords[atom], box);
-
-      double qi_qj_fact, distSq;
-      int i;
-      XYZ virComponents;
-      std::vector<uint> nIndex;
-
-      //store atom index in neighboring cell
-      while (!n.Done()) {
-        nIndex.push_back(*n);
-        n.Next();
+      pos.Set(2 * p, currentCoords[atom]);
+      pos.Set(2 * p + 1, molCoords[p]);
+      nb.kind[2 * p] = nb.kind[2 * p + 1] = particleKind[atom];
+      nb.charge[2 * p] = nb.charge[2 * p + 1] = particleCharge[atom];
+    }
+    Neighbors(nb, pos, length * 2, box);
+    PROFILE_COUNT(prof::PAIRS, nb.index.size());
+
+    (this->*trialInterKernel)(pos, nb, box);
+
+    //subtract the old energy and add the new one, block by block in order
+    for (uint i = 0; i < nb.blockTrial.size(); ++i) {
+      if (nb.blockTrial[i] % 2) {
+        tempREn += nb.blockReal[i];
+        tempLJEn += nb.blockLJ[i];
+        overlap |= (nb.blockOverlap[i] != 0);
+      } else {
+        tempREn -= nb.blockReal[i];
+        tempLJEn -= nb.blockLJ[i];
       }
+    }
 
-#ifdef _OPENMP
-      #pragma omp parallel for default(shared) private(i, distSq, qi_qj_fact, virComponents) reduction(+:tempREn, tempLJEn)
-#endif
-      for(i = 0; i < nIndex.size(); i++) {
-        distSq = 0.0;
-        //Subtract old energy
-        if (currentAxes.InRcut(distSq, virComponents,
-                               currentCoords, atom, nIndex[i], box)) {
-
-          if (electrostatic) {
-            qi_qj_fact = particleCharge[atom] * particleCharge[nIndex[i]] *
-                         num::qqFact;
+    if (frameworkGrid.Active(box)) {
+      double lj, coulomb;
+      for (uint p = 0; p < length; ++p) {
+        frameworkGrid.Energy(lj, coulomb, pos[2 * p], nb.kind[2 * p], box);
+        tempLJEn -= lj;
+        if (electrostatic)
+          tempREn -= nb.charge[2 * p] * coulomb;
+        overlap |= frameworkGrid.Energy(lj, coulomb, pos[2 * p + 1],
+                                        nb.kind[2 * p], box);
+        tempLJEn += lj;
+        if (electrostatic)
+          tempREn += nb.charge[2 * p] * coulomb;
+      }
+    }
+  }
 
-            tempREn -= forcefield.particles->CalcCoulomb(distSq, qi_qj_fact, box);
-          }
+  inter_LJ.energy = tempLJEn;
+  inter_coulomb.energy = tempREn;
+  return overlap;
+}
 
-          tempLJEn -= forcefield.particles->CalcEn(distSq, particleKind[atom],
-                      particleKind[nIndex[i]]);
-        }
-      }
+void CalculateEnergy::Neighbors(TrialNeighbors& nb, XYZArray const& pos,
+                                const uint count, const uint box) const
+{
+  nb.index.clear();
+  nb.start.clear();
+  nb.blockTrial.clear();
+  nb.blockStart.clear();
+  for(uint t = 0; t < count; ++t) {
+    uint first = nb.index.size();
+    nb.start.push_back(first);
+    CellList::Neighbors n = cellList.EnumerateLocal(pos[t], box);
+    while (!n.Done()) {
+      nb.index.push_back(*n);
+      n.Next();
+    }
+    for(uint s = first; s < nb.index.size(); s += batch::SIZE) {
+      nb.blockTrial.push_back(t);
+      nb.blockStart.push_back(s);
+    }
+  }
+  nb.start.push_back(nb.index.size());
+  nb.blockLJ.resize(nb.blockTrial.size());
+  nb.blockReal.resize(nb.blockTrial.size());
+  nb.blockOverlap.resize(nb.blockTrial.size());
+}
 
-      //add new energy
-      n = cellList.EnumerateLocal(molCoords[p], box);
-      //store atom index in neighboring cell
-      nIndex.clear();
-      while (!n.Done()) {
-        nIndex.push_back(*n);
-        n.Next();
-      }
+template <class PAIR, bool EWALD>
+void CalculateEnergy::TrialInterKernel(XYZArray const& pos,
+                                       TrialNeighbors& nb,
+                                       const uint box) const
+{
+  PAIR ff(forcefield);
+  int i, blocks = nb.blockTrial.size();
+  uint k, j, start, count;
+  double qi_qj_fact;
 
 #ifdef _OPENMP
-      #pragma omp parallel for default(shared) private(i, distSq, qi_qj_fact, virComponents) reduction(+:tempREn, tempLJEn)
+  #pragma omp parallel for default(shared) private(i, k, j, start, count, qi_qj_fact) if(par::Worth(nb.index.size()))
 #endif
-      for(i = 0; i < nIndex.size(); i++) {
-        distSq = 0.0;
-        if (currentAxes.InRcut(distSq, virComponents,
-                               molCoords, p, currentCoords, nIndex[i], box)) {
-          if(distSq < forcefield.rCutLowSq) {
-            overlap |= true;
-          }
-
-          if (electrostatic) {
-            qi_qj_fact = particleCharge[atom] *
-                         particleCharge[nIndex[i]] * num::qqFact;
+  for (i = 0; i < blocks; i++) {
+    double dx[batch::SIZE], dy[batch::SIZE], dz[batch::SIZE];
+    double distSq[batch::SIZE];
+    double tempREn = 0.0, tempLJEn = 0.0;
+    bool overlap = false;
+    uint t = nb.blockTrial[i];
+    start = nb.blockStart[i];
+    count = std::min(batch::SIZE, nb.start[t + 1] - start);
+    batch::AtomDist(dx, dy, dz, distSq, currentAxes, pos, t, currentCoords,
+                    &nb.index[start], count, box);
+
+    for (k = 0; k < count; k++) {
+      if (currentAxes.rCutSq[box] > distSq[k]) {
+        j = nb.index[start + k];
+        if(distSq[k] < forcefield.rCutLowSq) {
+          overlap = true;
+        }
 
-            tempREn += forcefield.particles->CalcCoulomb(distSq,
-                       qi_qj_fact, box);
-          }
+        if (electrostatic) {
+          qi_qj_fact = nb.charge[t] * particleCharge[j] * num::qqFact;
 
-          tempLJEn += forcefield.particles->CalcEn(distSq,
-                      particleKind[atom],
-                      particleKind[nIndex[i]]);
+          if (EWALD)
+            tempREn += ff.CalcCoulombEwald(distSq[k], qi_qj_fact, box);
+          else
+            tempREn += ff.CalcCoulomb(distSq[k], qi_qj_fact, box);
         }
+
+        tempLJEn += ff.CalcEn(distSq[k], nb.kind[t], particleKind[j]);
       }
     }
+    nb.blockReal[i] = tempREn;
+    nb.blockLJ[i] = tempLJEn;
+    nb.blockOverlap[i] = overlap;
   }
-
-  inter_LJ.energy = tempLJEn;
-  inter_coulomb.energy = tempREn;
-  return overlap;
 }
 
 // Calculate 1-N nonbonded intra energy
@@ -552,47 +1214,42 @@ void CalculateEnergy::ParticleInter(double* en, double *real,
                                     const uint partIndex,
                                     const uint molIndex,
                                     const uint box,
-                                    const uint trials) const
+                                    const uint trials,
+                                    TrialNeighbors& nb) const
 {
   if(box >= BOXES_WITH_U_NB)
     return;
-  double distSq, qi_qj_Fact, tempLJ, tempReal;
-  int i;
+  PROFILE_SCOPE(prof::PARTICLE_INTER);
   MoleculeKind const& thisKind = mols.GetKind(molIndex);
   uint kindI = thisKind.AtomKind(partIndex);
   double kindICharge = thisKind.AtomCharge(partIndex);
-  std::vector<uint> nIndex;
-
-  for(uint t = 0; t < trials; ++t) {
-    nIndex.clear();
-    tempReal = 0.0;
-    tempLJ = 0.0;
-    CellList::Neighbors n = cellList.EnumerateLocal(trialPos[t], box);
-    while (!n.Done()) {
-      nIndex.push_back(*n);
-      n.Next();
-    }
 
-#ifdef _OPENMP
-    #pragma omp parallel for default(shared) private(i, distSq, qi_qj_Fact) reduction(+:tempLJ, tempReal)
-#endif
-    for(i = 0; i < nIndex.size(); i++) {
-      distSq = 0.0;
+  //gather the neighbors of all trials and cut them into blocks, so a
+  //single parallel loop covers every trial
+  Neighbors(nb, trialPos, trials, box);
+  nb.kind.assign(trials, kindI);
+  nb.charge.assign(trials, kindICharge);
+  PROFILE_COUNT(prof::PAIRS, nb.index.size());
+  PROFILE_COUNT(prof::TRIALS, trials);
+
+  (this->*trialInterKernel)(trialPos, nb, box);
+
+  //sum the blocks in order, so the result does not depend on the threads
+  for(uint i = 0; i < nb.blockTrial.size(); ++i) {
+    uint t = nb.blockTrial[i];
+    overlap[t] |= (nb.blockOverlap[i] != 0);
+    en[t] += nb.blockLJ[i];
+    real[t] += nb.blockReal[i];
+  }
 
-      if(currentAxes.InRcut(distSq, trialPos, t, currentCoords, nIndex[i], box)) {
-        if(distSq < forcefield.rCutLowSq) {
-          overlap[t] |= true;
-        }
-        tempLJ += forcefield.particles->CalcEn(distSq, kindI,
-                                               particleKind[nIndex[i]]);
-        if(electrostatic) {
-          qi_qj_Fact = particleCharge[nIndex[i]] * kindICharge * num::qqFact;
-          tempReal += forcefield.particles->CalcCoulomb(distSq, qi_qj_Fact, box);
-        }
-      }
+  if (frameworkGrid.Active(box)) {
+    double lj, coulomb;
+    for(uint t = 0; t < trials; ++t) {
+      overlap[t] |= frameworkGrid.Energy(lj, coulomb, trialPos[t], kindI, box);
+      en[t] += lj;
+      if (electrostatic)
+        real[t] += kindICharge * coulomb;
     }
-    en[t] += tempLJ;
-    real[t] += tempReal;
   }
 }
 
@@ -627,11 +1284,12 @@ Intermolecular CalculateEnergy::MoleculeTailChange(const uint box,
 void CalculateEnergy::MoleculeIntra(const uint molIndex,
                                     const uint box, double *bondEn) const
 {
+  PROFILE_SCOPE(prof::MOLECULE_INTRA);
   bondEn[0] = 0.0, bondEn[1] = 0.0;
 
   MoleculeKind& molKind = mols.kinds[mols.kIndex[molIndex]];
   // *2 because we'll be storing inverse bond vectors
-  XYZArray bondVec(molKind.bondList.count * 2);
+  XYZArray& bondVec = scratch.Get().BondVectors(molKind.bondList.count * 2);
 
   BondVectors(bondVec, molKind, molIndex, box);
   MolBond(bondEn[0], molKind, bondVec, molIndex, box);
@@ -646,12 +1304,15 @@ void CalculateEnergy::MoleculeIntra(const uint molIndex,
 Energy CalculateEnergy::MoleculeIntra(cbmc::TrialMol const &mol,
                                       const uint molIndex) const
 {
+  PROFILE_SCOPE(prof::MOLECULE_INTRA);
   double bondEn = 0.0, intraNonbondEn = 0.0;
   // *2 because we'll be storing inverse bond vectors
   const MoleculeKind& molKind = mol.GetKind();
   uint count = molKind.bondList.count;
-  XYZArray bondVec(count * 2);
-  std::vector<bool> bondExist(count * 2, false);
+  ScratchBuffers& buffers = scratch.Get();
+  XYZArray& bondVec = buffers.BondVectors(count * 2);
+  std::vector<bool>& bondExist = buffers.bondExist;
+  bondExist.assign(count * 2, false);
 
   BondVectors(bondVec, mol, bondExist, molKind);
   MolBond(bondEn, mol, bondVec, bondExist, molKind);
@@ -1141,6 +1802,7 @@ bool CalculateEnergy::FindMolInCavity(std::vector< std::vector<uint> > &mol,
                                       const XYZArray& invCav, const uint box,
                                       const uint kind, const uint exRatio)
 {
+  PROFILE_SCOPE(prof::FIND_MOL_IN_CAVITY);
   uint k;
   mol.clear();
   mol.resize(molLookup.GetNumKind());
@@ -13,6 +13,8 @@ along with this program, also can be found at <http://www.gnu.org/licenses/>.
 #include "Ewald.h"
 #include "NoEwald.h"
 #include "CellList.h"
+#include "VerletList.h"
+#include "Scratch.h"
 
 #include <vector>
 
@@ -40,6 +42,7 @@ class Coordinates;
 class COM;
 class XYZArray;
 class BoxDimensions;
+class FrameworkGrid;
 
 namespace cbmc
 {
@@ -53,9 +56,14 @@ public:
 
   void Init(System & sys);
 
-  //! Calculates total energy/virial of all boxes in the system
+  //! Calculates total energy/virial of all boxes in the system. The boxes
+  //! run at the same time when that pays off (see par::Split).
   SystemPotential SystemTotal() ;
 
+  //! Work items (pairs, wave vectors times atoms, and atoms) of evaluating
+  //! the whole box, to size the teams of boxes run at the same time
+  ulong BoxWork(const uint box) const;
+
   //! Calculates total energy/virial of a single box in the system
   SystemPotential BoxInter(SystemPotential potential,
                            XYZArray const& coords,
@@ -66,6 +74,28 @@ public:
   //! Calculate force and virial for the box
   Virial ForceCalc(const uint box);
 
+  //! Virial of the box from the pair virial kept by the moves (pairVir),
+  //! only the tail correction and reciprocal terms are calculated.
+  //! Falls back to ForceCalc if the pair virial of the box is stale.
+  Virial ForceUpdate(Virial const& pairVir, const uint box);
+
+  //! Pair virial (LJ and real space) of molecule molIndex at its current
+  //! position and COM against the other molecules in box
+  Virial MoleculeVirial(const uint molIndex, const uint box) const;
+
+  //! True if moves keep the pair virial of SystemPotential up to date
+  bool TrackVirial() const
+  {
+    return trackVirial;
+  }
+
+  //! For moves that change too many pairs to update the pair virial, the
+  //! next pressure calculation recalculates it
+  void InvalidateVirial(const uint box)
+  {
+    virialStale[box] = true;
+  }
+
 
   //! Calculates intermolecule energy of all boxes in the system
   //! @param potential Copy of current energy structure to append result to
@@ -113,13 +143,15 @@ public:
   //! @param molIndex Index of molecule
   //! @param box Index of box molecule is in
   //! @param trials Number of trials ot loop over in position array. (cbmc)
+  //! @param nb Neighbor buffers, reused between calls
   void ParticleInter(double* en, double *real,
                      XYZArray const& trialPos,
                      bool* overlap,
                      const uint partIndex,
                      const uint molIndex,
                      const uint box,
-                     const uint trials) const;
+                     const uint trials,
+                     TrialNeighbors& nb) const;
 
 
   //! Calculates the change in the TC from adding numChange atoms of a kind
@@ -157,6 +189,9 @@ public:
 
 private:
 
+  //! Energy and virial of one box in current system, for SystemTotal
+  void BoxTotal(SystemPotential& pot, const uint box);
+
   //! Calculates full TC energy for one box in current system
   void EnergyCorrection(SystemPotential& pot, BoxDimensions const& boxAxes,
                         const uint box) const;
@@ -165,6 +200,10 @@ private:
   void ForceCorrection(Virial& virial, BoxDimensions const& boxAxes,
                        const uint box) const;
 
+  //! Sets the scalars of the LJ and real space tensors and adds the tail
+  //! correction and reciprocal terms
+  void FinishVirial(Virial& virial, const uint box) const;
+
 
   //! Calculates bond vectors of a full molecule, stores them in vecs
   void BondVectors(XYZArray & vecs,
@@ -230,6 +269,92 @@ private:
   void MolNonbond_1_3(double & energy, cbmc::TrialMol const &mol,
                       MoleculeKind const& molKind) const;
 
+  //! Collects all atom pairs of different molecules that may interact in
+  //! box. Uses the Verlet list if enabled and coords is the current state,
+  //! otherwise enumerates the cell list.
+  void BoxPairs(std::vector<uint>& pair1, std::vector<uint>& pair2,
+                XYZArray const& coords, const uint box);
+
+  //! True if the pairs of coords come from the Verlet list. Volume moves
+  //! evaluate trial coordinates, which the list of the current state does
+  //! not cover.
+  bool UseVerletList(XYZArray const& coords) const;
+
+  //! Energy of the mobile atoms of box with the fixed molecules, from the
+  //! framework grid, plus the energy among the fixed molecules
+  void FrameworkInter(double& REn, double& LJEn, XYZArray const& coords,
+                      const uint box) const;
+
+  //! Nonbonded pair loops, compiled once per FFParticle flavor so the pair
+  //! functions are inlined. PAIR wraps the flavor, EWALD selects the Ewald
+  //! real space term at compile time (see CalculateEnergy.cpp).
+  template <class PAIR, bool EWALD>
+  void BoxInterKernel(double& REn, double& LJEn,
+                      std::vector<uint> const& pair1,
+                      std::vector<uint> const& pair2,
+                      XYZArray const& coords, BoxDimensions const& boxAxes,
+                      const uint box) const;
+
+  //! Diagonal of the LJ (vT) and real space (rT) pressure tensors
+  template <class PAIR, bool EWALD>
+  void ForceKernel(double& vT11, double& vT22, double& vT33,
+                   double& rT11, double& rT22, double& rT33,
+                   std::vector<uint> const& pair1,
+                   std::vector<uint> const& pair2, const uint box) const;
+
+  //! Same as BoxInterKernel and ForceKernel for all pairs of the cell list,
+  //! which are taken from the half shell of each cell (see CellList.h).
+  //! The cells are shared out among the threads, no pair list is built.
+  template <class PAIR, bool EWALD>
+  void BoxCellKernel(double& REn, double& LJEn, XYZArray const& coords,
+                     BoxDimensions const& boxAxes, const uint box) const;
+  template <class PAIR, bool EWALD>
+  void ForceCellKernel(double& vT11, double& vT22, double& vT33,
+                       double& rT11, double& rT22, double& rT33,
+                       const uint box) const;
+
+  //! Diagonal of the LJ and real space pressure tensors of atom p of the
+  //! current coordinates against the atoms nIndex of other molecules
+  template <class PAIR, bool EWALD>
+  void AtomForceKernel(double& vT11, double& vT22, double& vT33,
+                       double& rT11, double& rT22, double& rT33, const uint p,
+                       std::vector<uint> const& nIndex,
+                       const uint box) const;
+
+  //! Gathers the neighbors of the first count positions of pos and cuts
+  //! them into blocks. nb.kind and nb.charge are left to the caller.
+  void Neighbors(TrialNeighbors& nb, XYZArray const& pos, const uint count,
+                 const uint box) const;
+
+  //! Energy of every block of nb, positions pos with atom kind and charge
+  //! nb.kind and nb.charge against their neighbors in the current
+  //! coordinates, all positions in one parallel loop. Fills nb.blockLJ,
+  //! blockReal and blockOverlap.
+  template <class PAIR, bool EWALD>
+  void TrialInterKernel(XYZArray const& pos, TrialNeighbors& nb,
+                        const uint box) const;
+
+  //! Picks the kernels for the FFParticle flavor in use, once at Init
+  void InitKernels();
+  template <class PAIR, bool EWALD>
+  void SetKernels();
+
+  typedef void (CalculateEnergy::*BoxInterFn)
+  (double&, double&, std::vector<uint> const&, std::vector<uint> const&,
+   XYZArray const&, BoxDimensions const&, const uint) const;
+  typedef void (CalculateEnergy::*ForceFn)
+  (double&, double&, double&, double&, double&, double&,
+   std::vector<uint> const&, std::vector<uint> const&, const uint) const;
+  typedef void (CalculateEnergy::*BoxCellFn)
+  (double&, double&, XYZArray const&, BoxDimensions const&, const uint) const;
+  typedef void (CalculateEnergy::*ForceCellFn)
+  (double&, double&, double&, double&, double&, double&, const uint) const;
+  typedef void (CalculateEnergy::*AtomForceFn)
+  (double&, double&, double&, double&, double&, double&, const uint,
+   std::vector<uint> const&, const uint) const;
+  typedef void (CalculateEnergy::*TrialInterFn)
+  (XYZArray const&, TrialNeighbors&, const uint) const;
+
   //! For particles in main coordinates array determines if they belong
   //! to same molecule, using internal arrays.
   bool SameMolecule(const uint p1, const uint p2) const
@@ -254,6 +379,21 @@ private:
   std::vector<int> particleMol;
   std::vector<double> particleCharge;
   const CellList& cellList;
+  const FrameworkGrid& frameworkGrid;
+  VerletList& verletList;
+  //! Work arrays of the system, one set per thread
+  ScratchPool& scratch;
+
+  //! Virial tracking, the pair virial of a stale box is recalculated
+  bool trackVirial;
+  bool virialStale[BOX_TOTAL];
+
+  BoxInterFn boxInterKernel;
+  ForceFn forceKernel;
+  BoxCellFn boxCellKernel;
+  ForceCellFn forceCellKernel;
+  AtomForceFn atomForceKernel;
+  TrialInterFn trialInterKernel;
 };
 
 #endif /*ENERGY_H*/
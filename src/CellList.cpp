@@ -10,18 +10,25 @@ along with this program, also can be found at <http://www.gnu.org/licenses/>.
 #include "Molecules.h"
 #include "XYZArray.h"
 #include "MoleculeLookup.h"
+#include "VerletList.h"
+#include "Profiler.h"
 
 #include <algorithm>
 
 const int CellList::END_CELL;
+const int CellList::CELL_SLACK;
+const int CellList::HALF_SHELL;
 
 CellList::CellList(const Molecules& mols,  BoxDimensions& dims)
   : mols(&mols)
 {
   dimensions = &dims;
   isBuilt = false;
+  verlet = NULL;
   for(uint b = 0; b < BOX_TOTAL; b++) {
     edgeCells[b][0] = edgeCells[b][1] = edgeCells[b][2] = 0;
+    scaled[b] = regridded[b] = false;
+    excludeFixed[b] = false;
   }
 }
 
@@ -32,13 +39,22 @@ void CellList::SetCutoff()
   }
 }
 
+void CellList::SetCutoff(const double skin)
+{
+  for(uint b = 0; b < BOX_TOTAL; b++) {
+    cutoff[b] = dimensions->rCut[b] + skin;
+  }
+}
+
 bool CellList::IsExhaustive() const
 {
-  std::vector<int> particles(list);
+  std::vector<int> particles;
   for(int b = 0; b < BOX_TOTAL; ++b) {
-    particles.insert(particles.end(), head[b].begin(), head[b].end());
+    for(int c = 0; c < count[b].size(); ++c) {
+      particles.insert(particles.end(), atoms[b].begin() + start[b][c],
+                       atoms[b].begin() + start[b][c] + count[b][c]);
+    }
   }
-  particles.erase(std::remove(particles.begin(), particles.end(), -1), particles.end());
   std::sort(particles.begin(), particles.end());
   for(int i = 0; i < particles.size(); ++i) {
     if (i != particles[i]) return false;
@@ -48,54 +64,133 @@ bool CellList::IsExhaustive() const
 
 void CellList::RemoveMol(const int molIndex, const int box, const XYZArray& pos)
 {
+  PROFILE_SCOPE(prof::CELL_REMOVE_MOL);
   // For each atom in molecule
   int p = mols->MolStart(molIndex);
   int end = mols->MolEnd(molIndex);
   while(p != end) {
-    int cell = PositionToCell(pos[p], box);
-    int at = head[box][cell];
-
-    //If particle we're looking for is at head of list assign its
-    //pointed at index (should be -1) to head.... this is the case
-    //for removing the head molecule in the cell, which is often when
-    //we're removing the last molecule/particle from a particular cell.
-    //
-    //If particle isn't at the head of the list, traverse links to find it,
-    //relinking once found.
-    if (at == p) {
-      head[box][cell] = list[p];
-    } else {
-      while(at != END_CELL) {
-        if (list[at] == p) {
-          list[at] = list[p];
-          break;
-        }
-        at = list[at];
-      }
-    }
+    Unlink(p, box, cellOf[p]);
     ++p;
   }
 }
 
+int CellList::Unlink(const int p, const int box, const int cell)
+{
+  //Particles move up one place behind p, so the cell keeps the order the
+  //particles were inserted in. Moves mostly take out recent particles,
+  //which sit at the end.
+  int* first = &atoms[box][start[box][cell]];
+  int* last = first + count[box][cell];
+  int* at = std::find(first, last, p);
+  if (at != last) {
+    std::copy(at + 1, last, at);
+    --count[box][cell];
+  }
+  return at - first;
+}
+
+void CellList::Insert(const int p, const int box, const int cell)
+{
+  if (start[box][cell] + count[box][cell] == start[box][cell + 1])
+    Repack(box);
+  atoms[box][start[box][cell] + count[box][cell]] = p;
+  ++count[box][cell];
+  cellOf[p] = cell;
+}
+
+void CellList::Reinsert(const int p, const int box, const int cell,
+                        const int place)
+{
+  if (start[box][cell] + count[box][cell] == start[box][cell + 1])
+    Repack(box);
+  int* first = &atoms[box][start[box][cell]];
+  std::copy_backward(first + place, first + count[box][cell],
+                     first + count[box][cell] + 1);
+  first[place] = p;
+  ++count[box][cell];
+  cellOf[p] = cell;
+}
+
+void CellList::Repack(const int box)
+{
+  PROFILE_SCOPE(prof::CELL_REPACK);
+  int nCells = count[box].size();
+  std::vector<int> newStart(nCells + 1);
+  newStart[0] = 0;
+  for (int c = 0; c < nCells; ++c)
+    newStart[c + 1] = newStart[c] + count[box][c] + CELL_SLACK;
+
+  std::vector<int> packed(newStart[nCells]);
+  for (int c = 0; c < nCells; ++c) {
+    std::copy(atoms[box].begin() + start[box][c],
+              atoms[box].begin() + start[box][c] + count[box][c],
+              packed.begin() + newStart[c]);
+  }
+  atoms[box].swap(packed);
+  start[box].swap(newStart);
+}
+
 void CellList::AddMol(const int molIndex, const int box, const XYZArray& pos)
+{
+  PROFILE_SCOPE(prof::CELL_ADD_MOL);
+  BinMol(molIndex, box, pos);
+
+  if (verlet != NULL) {
+    verlet->AddMol(molIndex, box, pos);
+  }
+}
+
+void CellList::BinMol(const int molIndex, const int box, const XYZArray& pos)
 {
   // For each atom in molecule
   int p = mols->MolStart(molIndex);
   int end = mols->MolEnd(molIndex);
 
-  //Note: GridAll assigns everthing to END_CELL
-  // so list should point to that
-  // if this is the first particle in a particular cell.
   while(p != end) {
-    int cell = PositionToCell(pos[p], box);
-    //Make the current head index the index the new head points at.
-    list[p] = head[box][cell];
-    //Assign the new head as our particle index
-    head[box][cell] = p;
+    Insert(p, box, PositionToCell(pos[p], box));
     ++p;
   }
 }
 
+void CellList::SortBox(const XYZArray& pos, const MoleculeLookup& lookup,
+                       const uint b)
+{
+  int nCells = edgeCells[b][0] * edgeCells[b][1] * edgeCells[b][2];
+  count[b].assign(nCells, 0);
+
+  //count the particles of each cell
+  MoleculeLookup::box_iterator it = lookup.BoxBegin(b),
+                               end = lookup.BoxEnd(b);
+  for (; it != end; ++it) {
+    if (excludeFixed[b] && lookup.IsFix(*it))
+      continue;
+    for (int p = mols->MolStart(*it); p != mols->MolEnd(*it); ++p) {
+      cellOf[p] = PositionToCell(pos[p], b);
+      ++count[b][cellOf[p]];
+    }
+  }
+
+  //place the cells one after the other, with slack behind each
+  start[b].resize(nCells + 1);
+  start[b][0] = 0;
+  for (int c = 0; c < nCells; ++c) {
+    start[b][c + 1] = start[b][c] + count[b][c] + CELL_SLACK;
+    count[b][c] = 0;
+  }
+  atoms[b].resize(start[b][nCells]);
+
+  //fill them in molecule order
+  for (it = lookup.BoxBegin(b); it != end; ++it) {
+    if (excludeFixed[b] && lookup.IsFix(*it))
+      continue;
+    for (int p = mols->MolStart(*it); p != mols->MolEnd(*it); ++p) {
+      int cell = cellOf[p];
+      atoms[b][start[b][cell] + count[b][cell]] = p;
+      ++count[b][cell];
+    }
+  }
+}
+
 // Resize all boxes to match current axes
 void CellList::ResizeGrid(const BoxDimensions& dims)
 {
@@ -156,70 +251,193 @@ void CellList::RebuildNeighbors(int b)
 {
   int* eCells = edgeCells[b];
   int nCells = eCells[0] * eCells[1] * eCells[2];
-  head[b].resize(nCells);
   neighbors[b].resize(nCells);
   for (int i = 0; i < nCells; ++i) {
     neighbors[b][i].clear();
   }
 
+  // Offsets of the cell itself, the 13 cells ahead of it (offset greater
+  // in x, then y, then z) and the 13 behind it. An offset and its negative
+  // always fall in different halves, and with at least 3 cells per edge
+  // they never wrap onto the same cell.
+  int offset[27][3];
+  int n = 0;
+  for (int half = 0; half < 3; ++half) {
+    for (int dx = -1; dx <= 1; ++dx) {
+      for (int dy = -1; dy <= 1; ++dy) {
+        for (int dz = -1; dz <= 1; ++dz) {
+          int order = dx * 9 + dy * 3 + dz;
+          if ((half == 0 && order == 0) || (half == 1 && order > 0) ||
+              (half == 2 && order < 0)) {
+            offset[n][0] = dx;
+            offset[n][1] = dy;
+            offset[n][2] = dz;
+            ++n;
+          }
+        }
+      }
+    }
+  }
+
   for (int x = 0; x < eCells[0]; ++x) {
     for (int y = 0; y < eCells[1]; ++y) {
       for (int z = 0; z < eCells[2]; ++z) {
         int cell = x * eCells[2] * eCells[1] + y * eCells[2] + z;
-        for (int dx = -1; dx <= 1; ++dx) {
-          for (int dy = -1; dy <= 1; ++dy) {
-            for (int dz = -1; dz <= 1; ++dz) {
-              // Cache adjacent cells, wrapping if needed
-              neighbors[b][cell].push_back(
-                ((x + dx + eCells[0]) % eCells[0]) *
-                eCells[2] * eCells[1] +
-                ((y + dy + eCells[1]) % eCells[1]) *
-                eCells[2] +
-                ((z + dz + eCells[2]) % eCells[2]));
-            }
-          }
+        for (int i = 0; i < 27; ++i) {
+          // Cache adjacent cells, wrapping if needed
+          neighbors[b][cell].push_back(
+            ((x + offset[i][0] + eCells[0]) % eCells[0]) *
+            eCells[2] * eCells[1] +
+            ((y + offset[i][1] + eCells[1]) % eCells[1]) *
+            eCells[2] +
+            ((z + offset[i][2] + eCells[2]) % eCells[2]));
         }
       }
     }
   }
 }
 
+int CellList::HalfShell(std::vector<uint>& out, int cell, int box) const
+{
+  out.clear();
+  for (int i = 0; i < HALF_SHELL; ++i) {
+    int c = neighbors[box][cell][i];
+    out.insert(out.end(), atoms[box].begin() + start[box][c],
+               atoms[box].begin() + start[box][c] + count[box][c]);
+  }
+  return count[box][cell];
+}
+
+ulong CellList::ShellPairs(int box) const
+{
+  ulong pairs = 0;
+  for (int cell = 0; cell < count[box].size(); ++cell) {
+    ulong ahead = 0;
+    for (int i = 1; i < HALF_SHELL; ++i)
+      ahead += count[box][neighbors[box][cell][i]];
+    ulong own = count[box][cell];
+    pairs += own * (own - 1) / 2 + own * ahead;
+  }
+  return pairs;
+}
+
 void CellList::GridAll(BoxDimensions& dims, const XYZArray& pos,
                        const MoleculeLookup& lookup)
 {
+  PROFILE_SCOPE(prof::CELL_GRID_ALL);
   dimensions = &dims;
-  list.resize(pos.Count());
+  cellOf.resize(pos.Count());
   ResizeGrid(dims);
   for (int b = 0; b < BOX_TOTAL; ++b) {
-    head[b].assign(edgeCells[b][0] * edgeCells[b][1] *
-                   edgeCells[b][2],
-                   END_CELL);
-    MoleculeLookup::box_iterator it = lookup.BoxBegin(b),
-                                 end = lookup.BoxEnd(b);
-
-    // For each molecule per box
-    while (it != end) {
-      AddMol(*it, b, pos);
-      ++it;
-    }
+    SortBox(pos, lookup, b);
   }
 }
 
 void CellList::GridBox(BoxDimensions& dims, const XYZArray& pos,
                        const MoleculeLookup& lookup, const uint b)
 {
+  PROFILE_SCOPE(prof::CELL_GRID_BOX);
   dimensions = &dims;
-  list.resize(pos.Count());
+  cellOf.resize(pos.Count());
   ResizeGridBox(dims, b);
-  head[b].assign(edgeCells[b][0] * edgeCells[b][1] *
-                 edgeCells[b][2], END_CELL);
+  SortBox(pos, lookup, b);
+}
+
+void CellList::GridScaled(BoxDimensions& dims, const XYZArray& pos,
+                          const MoleculeLookup& lookup, const uint b)
+{
+  PROFILE_SCOPE(prof::CELL_GRID_SCALED);
+  cellSizeOld[b] = cellSize[b];
+  for (uint i = 0; i < 3; ++i)
+    edgeCellsOld[b][i] = edgeCells[b][i];
+  scaled[b] = true;
+
+  XYZ sides = dims.axis[b];
+  int eCells[3];
+  eCells[0] = std::max((int)floor(sides.x / cutoff[b]), 3);
+  eCells[1] = std::max((int)floor(sides.y / cutoff[b]), 3);
+  eCells[2] = std::max((int)floor(sides.z / cutoff[b]), 3);
+
+  if (!isBuilt || eCells[0] != edgeCells[b][0] ||
+      eCells[1] != edgeCells[b][1] || eCells[2] != edgeCells[b][2]) {
+    // Grid changed shape, bin from scratch into the spare cells. The old
+    // cells and neighbor lists are moved aside, SortBox and
+    // RebuildNeighbors fill new ones.
+    atomsOld[b].swap(atoms[b]);
+    startOld[b].swap(start[b]);
+    countOld[b].swap(count[b]);
+    neighborsOld[b].swap(neighbors[b]);
+    regridded[b] = true;
+  }
+
   MoleculeLookup::box_iterator it = lookup.BoxBegin(b),
                                end = lookup.BoxEnd(b);
+  if (regridded[b]) {
+    for (; it != end; ++it) {
+      if (excludeFixed[b] && lookup.IsFix(*it))
+        continue;
+      for (int p = mols->MolStart(*it); p != mols->MolEnd(*it); ++p) {
+        Moved m = {p, cellOf[p], 0};
+        moved[b].push_back(m);
+      }
+    }
+    GridBox(dims, pos, lookup, b);
+    return;
+  }
+
+  // Cells scale with the box, so most particles keep their cell
+  dimensions = &dims;
+  cellSize[b] = XYZ(sides.x / eCells[0], sides.y / eCells[1],
+                    sides.z / eCells[2]);
+  for (; it != end; ++it) {
+    if (excludeFixed[b] && lookup.IsFix(*it))
+      continue;
+    for (int p = mols->MolStart(*it); p != mols->MolEnd(*it); ++p) {
+      int cell = PositionToCell(pos[p], b);
+      if (cell != cellOf[p]) {
+        Moved m = {p, cellOf[p], Unlink(p, b, cellOf[p])};
+        moved[b].push_back(m);
+        Insert(p, b, cell);
+      }
+    }
+  }
+}
 
-  // For each molecule per box
-  while (it != end) {
-    AddMol(*it, b, pos);
-    ++it;
+void CellList::RestoreScaled(BoxDimensions& dims)
+{
+  dimensions = &dims;
+  for (uint b = 0; b < BOX_TOTAL; ++b) {
+    if (!scaled[b])
+      continue;
+    cellSize[b] = cellSizeOld[b];
+    if (regridded[b]) {
+      atoms[b].swap(atomsOld[b]);
+      start[b].swap(startOld[b]);
+      count[b].swap(countOld[b]);
+      neighbors[b].swap(neighborsOld[b]);
+      for (uint i = 0; i < 3; ++i)
+        edgeCells[b][i] = edgeCellsOld[b][i];
+      for (uint i = 0; i < moved[b].size(); ++i)
+        cellOf[moved[b][i].p] = moved[b][i].cell;
+    } else {
+      // Undo the moves last first, so every particle is at the end of
+      // its new cell and goes back to its old place
+      for (int i = moved[b].size() - 1; i >= 0; --i) {
+        Moved const& m = moved[b][i];
+        Unlink(m.p, b, cellOf[m.p]);
+        Reinsert(m.p, b, m.cell, m.place);
+      }
+    }
+    moved[b].clear();
+    scaled[b] = regridded[b] = false;
+  }
+}
+
+void CellList::CommitScaled()
+{
+  for (uint b = 0; b < BOX_TOTAL; ++b) {
+    moved[b].clear();
+    scaled[b] = regridded[b] = false;
   }
 }
 
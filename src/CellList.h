@@ -18,18 +18,54 @@ class Molecules;
 class XYZArray;
 class BoxDimensions;
 class MoleculeLookup;
-
+class VerletList;
+
+//
+//    CellList.h
+//    Bins the particles of each box into cells at least a cutoff wide.
+//    The particles of a cell are stored contiguously (compressed rows):
+//    cell c of box b holds count[b][c] particle indices starting at
+//    atoms[b][start[b][c]], with free places up to start[b][c + 1], so the
+//    neighbor loops stream through memory instead of chasing links.
+//    Boxes are binned with a counting sort, leaving CELL_SLACK free places
+//    behind every cell; single molecule moves fill and free those places
+//    and only a full cell packs the box again.
+//
 class CellList
 {
 public:
   explicit CellList(const Molecules& mols, BoxDimensions& dims);
   void SetCutoff();
+  // Pad the cutoff of every box by skin (used for Verlet list binning)
+  void SetCutoff(const double skin);
+  // Forward AddMol to the Verlet list, so it can patch itself
+  void SetVerletList(VerletList* vList)
+  {
+    verlet = vList;
+  }
+
+  // Leave the fixed molecules of box out of the grid, their energy with
+  // the other molecules comes from the framework grid
+  void ExcludeFixed(const uint box)
+  {
+    excludeFixed[box] = true;
+  }
 
   void RemoveMol(const int molIndex, const int box, const XYZArray& pos);
   void AddMol(const int molIndex, const int box, const XYZArray& pos);
   void GridAll(BoxDimensions& dims, const XYZArray& pos, const MoleculeLookup& lookup);
   void GridBox(BoxDimensions& dims, const XYZArray& pos, const MoleculeLookup& lookup,
                const uint b);
+  // Regrid box b for the scaled axes and coordinates of a volume move.
+  // If the number of cells per edge did not change, only atoms that
+  // changed cell are moved, and logged for RestoreScaled. Otherwise the
+  // old cells are swapped aside and the box is binned again.
+  void GridScaled(BoxDimensions& dims, const XYZArray& pos,
+                  const MoleculeLookup& lookup, const uint b);
+  // Put back the grid of every box scaled since the last commit
+  void RestoreScaled(BoxDimensions& dims);
+  // Keep the scaled grid and drop the old one
+  void CommitScaled();
 
   // Index of cell containing position
   int PositionToCell(const XYZ& posRef, int box) const;
@@ -47,9 +83,18 @@ public:
   class Pairs;
   Pairs EnumeratePairs(int box) const;
 
+  // Half shell of a cell: the cell itself and the 13 neighbors ahead of
+  // it, so that every pair of neighboring cells is in exactly one half
+  // shell. Replaces out with the particles of the half shell of cell and
+  // returns how many of them, at the front, belong to cell itself.
+  int HalfShell(std::vector<uint>& out, int cell, int box) const;
+
+  // Number of particle pairs the half shells of box hold
+  ulong ShellPairs(int box) const;
+
   int CellsInBox(int box) const
   {
-    return head[box].size();
+    return count[box].size();
   }
 
   // true if every particle is a member of exactly one cell
@@ -57,23 +102,60 @@ public:
 
 private:
   static const int END_CELL = -1;
+  // Cells of a half shell, at the front of the neighbors of every cell
+  static const int HALF_SHELL = 14;
+  // Free places left behind every cell when a box is packed
+  static const int CELL_SLACK = 8;
 
   // Resize all boxes to match current axes
   void ResizeGrid(const BoxDimensions& dims);
   // Resize one boxes to match current axes
   void ResizeGridBox(const BoxDimensions& dims, const uint b);
-  // Rebuild head/neighbor lists in box b to match current grid
+  // Rebuild neighbor lists in box b to match current grid
   void RebuildNeighbors(int b);
-
-  std::vector<int> list;
+  // Bin all molecules of box b from scratch, with a counting sort
+  void SortBox(const XYZArray& pos, const MoleculeLookup& lookup,
+               const uint b);
+  // Insert molecule into its cells, without notifying the Verlet list
+  void BinMol(const int molIndex, const int box, const XYZArray& pos);
+  // Append particle p to cell of box, packing the box if the cell is full
+  void Insert(const int p, const int box, const int cell);
+  // Remove particle p from cell of box, keeping the order of the others.
+  // Returns the place p had in the cell.
+  int Unlink(const int p, const int box, const int cell);
+  // Put particle p back at place of cell of box, behind it move up
+  void Reinsert(const int p, const int box, const int cell, const int place);
+  // Lay the cells of box out again with CELL_SLACK free places each
+  void Repack(const int box);
+
+  std::vector<int> atoms[BOX_TOTAL];  // particles of each cell, packed
+  std::vector<int> start[BOX_TOTAL];  // first place of each cell, and end
+  std::vector<int> count[BOX_TOTAL];  // particles in each cell
+  std::vector<int> cellOf;   // cell of each particle, set by BinMol
+  // neighbor cells of each cell: itself, the 13 ahead, the 13 behind
   std::vector<std::vector<int> > neighbors[BOX_TOTAL];
-  std::vector<int> head[BOX_TOTAL];
   XYZ cellSize[BOX_TOTAL];
   int edgeCells[BOX_TOTAL][3];
   const Molecules* mols;
   BoxDimensions *dimensions;
   double cutoff[BOX_TOTAL];
   bool isBuilt;
+  bool excludeFixed[BOX_TOTAL];
+  VerletList* verlet;
+
+  // Particle that changed cell in GridScaled, with its old cell and place
+  struct Moved {
+    int p, cell, place;
+  };
+  // grid before GridScaled, put back by RestoreScaled. A regridded box
+  // swaps its cells with these and logs the old cell of every particle.
+  std::vector<Moved> moved[BOX_TOTAL];
+  std::vector<std::vector<int> > neighborsOld[BOX_TOTAL];
+  std::vector<int> atomsOld[BOX_TOTAL], startOld[BOX_TOTAL];
+  std::vector<int> countOld[BOX_TOTAL];
+  XYZ cellSizeOld[BOX_TOTAL];
+  int edgeCellsOld[BOX_TOTAL][3];
+  bool scaled[BOX_TOTAL], regridded[BOX_TOTAL];
 };
 
 
@@ -88,43 +170,43 @@ inline int CellList::PositionToCell(const XYZ& posRef, int box) const
   return x * edgeCells[box][1] * edgeCells[box][2] + y * edgeCells[box][2] + z;
 }
 
+// Visits the particles of a cell, the one inserted last first
 class CellList::Cell
 {
 public:
-  Cell(int start, const std::vector<int>& list) :
-    at(start), list(list.begin()) {}
+  Cell(const int* first, int count) : first(first), at(count - 1) {}
 
   int operator*() const
   {
-    return at;
+    return first[at];
   }
 
   void Next()
   {
-    at = list[at];
+    --at;
   }
 
   bool Done()
   {
-    return at == CellList::END_CELL;
+    return at < 0;
   }
 
-  void Jump(int head)
+  void Jump(const int* cellFirst, int cellCount)
   {
-    at = head;
+    first = cellFirst;
+    at = cellCount - 1;
   }
 
 private:
+  const int* first;
   int at;
-  std::vector<int>::const_iterator list;
 };
 
 
 class CellList::Neighbors
 {
 public:
-  Neighbors(const std::vector<int>& list,
-            const std::vector<int>& head,
+  Neighbors(const int* atoms, const int* start, const int* count,
             const std::vector<int>& neighbors);
 
   int operator*() const
@@ -142,36 +224,39 @@ public:
 private:
 
   CellList::Cell cell;
-  std::vector<int>::const_iterator head;
+  const int* atoms;
+  const int* start;
+  const int* count;
   std::vector<int>::const_iterator neighbor, nEnd;
 };
 
 inline CellList::Cell CellList::EnumerateCell(int cell, int box) const
 {
 #ifndef NDEBUG
-  if(cell >= head[box].size()) {
+  if(cell >= count[box].size()) {
     std::cout << "CellList.h:153: box " << box << ", Out of cell" << std::endl;
   }
 #endif
-  return CellList::Cell(head[box][cell], list);
+  return CellList::Cell(&atoms[box][0] + start[box][cell], count[box][cell]);
 }
 
 inline CellList::Neighbors CellList::EnumerateLocal(int cell, int box) const
 {
 #ifndef NDEBUG
-  if(cell >= head[box].size()) {
+  if(cell >= count[box].size()) {
     std::cout << "CellList.h:162: box " << box << ", Out of cell" << std::endl;
     std::cout << "AxisDimensions: " << dimensions->GetAxis(box) << std::endl;
   }
 #endif
-  return CellList::Neighbors(list, head[box], neighbors[box][cell]);
+  return CellList::Neighbors(&atoms[box][0], &start[box][0], &count[box][0],
+                             neighbors[box][cell]);
 }
 
 inline CellList::Neighbors CellList::EnumerateLocal(const XYZ& pos, int box) const
 {
   int cell = PositionToCell(pos, box);
 #ifndef NDEBUG
-  if(cell >= head[box].size()) {
+  if(cell >= count[box].size()) {
     std::cout << "CellList.h:172: box " << box << ", pos: " << pos
               << std::endl;
     std::cout << "AxisDimensions: " << dimensions->GetAxis(box) << std::endl;
@@ -180,10 +265,13 @@ inline CellList::Neighbors CellList::EnumerateLocal(const XYZ& pos, int box) con
   return EnumerateLocal(cell, box);
 }
 
-inline CellList::Neighbors::Neighbors(const std::vector<int>& partList,
-                                      const std::vector<int>& headList, const std::vector<int>& neighbors) :
-  cell(headList[neighbors[0]], partList),
-  head(headList.begin()),
+inline CellList::Neighbors::Neighbors(const int* atoms, const int* start,
+                                      const int* count,
+                                      const std::vector<int>& neighbors) :
+  cell(atoms + start[neighbors[0]], count[neighbors[0]]),
+  atoms(atoms),
+  start(start),
+  count(count),
   neighbor(neighbors.begin()),
   nEnd(neighbors.end())
 {
@@ -192,7 +280,7 @@ inline CellList::Neighbors::Neighbors(const std::vector<int>& partList,
     if(Done()) {
       break;
     } else {
-      cell.Jump(head[*neighbor]);
+      cell.Jump(atoms + start[*neighbor], count[*neighbor]);
     }
   }
 }
@@ -207,13 +295,15 @@ inline void CellList::Neighbors::Next()
     if(Done()) {
       break;
     } else {
-      cell.Jump(head[*neighbor]);
+      cell.Jump(atoms + start[*neighbor], count[*neighbor]);
     }
   }
   assert(!cell.Done() || Done());
 }
 
 
+// Visits every pair of particles in the same or neighboring cells once,
+// from the half shell of each cell
 class CellList::Pairs
 {
 public:
@@ -221,66 +311,79 @@ public:
 
   int First() const
   {
-    return *cellParticle;
+    return first[a];
   }
   int Second() const
   {
-    return *localParticle;
+    return second[b];
+  }
+  void Next()
+  {
+    ++b;
+    Settle();
   }
-  void Next();
   bool Done() const
   {
     return cell == nCells;
   }
 private:
-  // skip to next nonempty cell
-  void NextCell();
+  // points second at cell number shell of the half shell
+  void JumpShell();
+  // moves on from an exhausted partner cell to the next pair
+  void Settle();
 
-  CellList::Cell cellParticle;
-  CellList::Neighbors localParticle;
   const CellList& cellList;
   int box, cell, nCells;
+  // particle a of cell against particle b of the partner cell
+  const int* first;
+  const int* second;
+  int firstCount, secondCount, a, b, shell;
 };
 
 inline CellList::Pairs::Pairs(const CellList& cellList, int box) :
-  cellParticle(cellList.EnumerateCell(0, box)),
-  localParticle(cellList.EnumerateLocal(0, box)),
   cellList(cellList),
   box(box),
   cell(0),
-  nCells(cellList.CellsInBox(box))
+  nCells(cellList.CellsInBox(box)),
+  a(0),
+  shell(0)
 {
-  if (cellParticle.Done()) NextCell();
-  if (First() >= Second() &&
-      !(First() == CellList::END_CELL && Second() == CellList::END_CELL))
-    Next();
+  // skip empty cells
+  while (cell < nCells && cellList.count[box][cell] == 0)
+    ++cell;
+  if (Done())
+    return;
+  first = &cellList.atoms[box][0] + cellList.start[box][cell];
+  firstCount = cellList.count[box][cell];
+  JumpShell();
+  Settle();
 }
 
-inline void CellList::Pairs::NextCell()
+inline void CellList::Pairs::JumpShell()
 {
-  do {
-    ++cell;
-    if (cell >= nCells) return;
-    cellParticle = cellList.EnumerateCell(cell, box);
-    localParticle = cellList.EnumerateLocal(cell, box);
-    // skip empty cells
-  } while (cellParticle.Done());
+  int c = cellList.neighbors[box][cell][shell];
+  second = &cellList.atoms[box][0] + cellList.start[box][c];
+  secondCount = cellList.count[box][c];
+  // within the cell itself, only the particles after a
+  b = (shell == 0 ? a + 1 : 0);
 }
 
-inline void CellList::Pairs::Next()
+inline void CellList::Pairs::Settle()
 {
-  do {
-    cellParticle.Next();
-    if (cellParticle.Done()) {
-      localParticle.Next();
-      if (localParticle.Done()) {
-        NextCell();
-        if (Done()) return;
-      } else {
-        cellParticle = cellList.EnumerateCell(cell, box);
+  while (b >= secondCount) {
+    if (++shell == CellList::HALF_SHELL) {
+      shell = 0;
+      if (++a == firstCount) {
+        a = 0;
+        do {
+          if (++cell == nCells)
+            return;
+        } while (cellList.count[box][cell] == 0);
+        first = &cellList.atoms[box][0] + cellList.start[box][cell];
+        firstCount = cellList.count[box][cell];
       }
     }
-    // skip over doubles
-  } while (First() >= Second());
+    JumpShell();
+  }
 }
 #endif
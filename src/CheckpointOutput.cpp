@@ -6,29 +6,28 @@ along with this program, also can be found at <http://www.gnu.org/licenses/>.
 ********************************************************************************/
 
 #include <stdint.h>
+#include <cstring>
+#include <cstdio>
 #include "CheckpointOutput.h"
 #include "MoleculeLookup.h"
 #include "System.h"
-
-namespace
-{
-union dbl_output_union {
-  char bin_value[8];
-  double dbl_value;
-};
-
-union uint32_output_union {
-  char bin_value[8];
-  uint32_t uint_value;
-};
-}
+#ifdef _WIN32
+#include <io.h>     //for _commit
+#else
+#include <unistd.h> //for fsync
+#endif
 
 CheckpointOutput::CheckpointOutput(System & sys, StaticVals const& statV) :
   moveSetRef(sys.moveSettings), molLookupRef(sys.molLookupRef),
   boxDimRef(sys.boxDimRef),  molRef(statV.mol), prngRef(sys.prng),
-  coordCurrRef(sys.coordinates), filename("checkpoint.dat")
+  coordCurrRef(sys.coordinates), potentialRef(sys.potential),
+  ewaldRef(sys.GetEwald()), fingerprint(sys.stateFingerprint),
+  filename("checkpoint.dat")
 {
-  outputFile = NULL;
+  saveState = false;
+#ifndef _WIN32
+  writerRunning = false;
+#endif
 }
 
 void CheckpointOutput::Init(pdb_setup::Atoms const& atoms,
@@ -36,266 +35,292 @@ void CheckpointOutput::Init(pdb_setup::Atoms const& atoms,
 {
   enableOutCheckpoint = output.checkpoint.enable;
   stepsPerCheckpoint = output.checkpoint.frequency;
+  saveState = output.checkpointState;
 }
 
 void CheckpointOutput::DoOutput(const ulong step)
 {
   if(enableOutCheckpoint) {
-    openOutputFile();
+    buffer.clear();
+    sectionId.clear();
+    sectionOffset.clear();
+    //header, filled in by finish
+    buffer.resize(checkpoint::HEADER_SIZE, 0);
     printStepNumber(step);
     printBoxDimensionsData();
     printRandomNumbers();
     printCoordinates();
     printMoleculeLookupData();
     printMoveSettingsData();
-    std::cout << "Checkpoint saved to " << filename << std::endl;
+    if(saveState) {
+      printPotential();
+      printRecip();
+    }
+    finish();
+
+    //only one checkpoint is written at a time
+    waitForWriter();
+    buffer.swap(writeBuffer);
+    startWriter();
+    std::cout << "Saving checkpoint to " << filename << std::endl;
   }
 }
 
 void CheckpointOutput::printStepNumber(const ulong step)
 {
-  uint32_t s = (uint32_t) step + 1;
-  outputUintIn8Chars(s);
+  beginSection(checkpoint::STEP);
+  output((uint64_t)(step + 1));
 }
 
 void CheckpointOutput::printBoxDimensionsData()
 {
+  beginSection(checkpoint::BOX);
   // print the number of boxes
-  uint32_t totalBoxes = BOX_TOTAL;
-  outputUintIn8Chars(totalBoxes);
-  for(int b = 0; b < totalBoxes; b++) {
+  output((uint32_t)BOX_TOTAL);
+  output((uint32_t)0);
+  for(uint b = 0; b < BOX_TOTAL; b++) {
     XYZ axis = boxDimRef.axis.Get(b);
-    outputDoubleIn8Chars(axis.x);
-    outputDoubleIn8Chars(axis.y);
-    outputDoubleIn8Chars(axis.z);
-    outputDoubleIn8Chars(boxDimRef.cosAngle[b][0]);
-    outputDoubleIn8Chars(boxDimRef.cosAngle[b][1]);
-    outputDoubleIn8Chars(boxDimRef.cosAngle[b][2]);
+    output(axis.x);
+    output(axis.y);
+    output(axis.z);
+    outputArray(boxDimRef.cosAngle[b], 3);
   }
 }
 
 void CheckpointOutput::printRandomNumbers()
 {
+  beginSection(checkpoint::PRNG);
   // First let's save the state array inside prng
   // the length of the array is 624
   // there is a save function inside MersenneTwister.h file
   // to read back we can use the load function
   const int N = 624;
-  uint32_t* saveArray = new uint32_t[N];
+  uint32_t saveArray[N];
   prngRef.GetGenerator()->save(saveArray);
-  for(int i = 0; i < N; i++) {
-    outputUintIn8Chars(saveArray[i]);
-  }
+  outputArray(saveArray, N);
 
   // Save the location of pointer in state
   uint32_t location = prngRef.GetGenerator()->pNext -
                       prngRef.GetGenerator()->state;
-  outputUintIn8Chars(location);
+  output(location);
 
   // save the "left" value so we can restore it later
-  outputUintIn8Chars(prngRef.GetGenerator()->left);
+  output((uint32_t)prngRef.GetGenerator()->left);
 
   // let's save seedValue just in case
   // not sure if that is used or not, or how important it is
-  outputUintIn8Chars(prngRef.GetGenerator()->seedValue);
+  output((uint32_t)prngRef.GetGenerator()->seedValue);
 }
 
 void CheckpointOutput::printCoordinates()
 {
+  beginSection(checkpoint::COORDINATES);
   // first let's print the count
   uint32_t count = coordCurrRef.Count();
-  outputUintIn8Chars(count);
+  output(count);
+  output((uint32_t)0);
 
-  // now let's print the coordinates one by one
-  for(int i = 0; i < count; i++) {
-    outputDoubleIn8Chars(coordCurrRef[i].x);
-    outputDoubleIn8Chars(coordCurrRef[i].y);
-    outputDoubleIn8Chars(coordCurrRef[i].z);
-  }
+  // now the x, y and z arrays
+  outputArray(coordCurrRef.x, count);
+  outputArray(coordCurrRef.y, count);
+  outputArray(coordCurrRef.z, count);
 }
 
 void CheckpointOutput::printMoleculeLookupData()
 {
-  // print the size of molLookup array
-  outputUintIn8Chars(molLookupRef.molLookupCount);
-  // print the molLookup array itself
-  for(int i = 0; i < molLookupRef.molLookupCount; i++) {
-    outputUintIn8Chars(molLookupRef.molLookup[i]);
-  }
+  beginSection(checkpoint::MOL_LOOKUP);
+  // print the molLookup array with its size
+  output((uint32_t)molLookupRef.molLookupCount);
+  outputArray(molLookupRef.molLookup, molLookupRef.molLookupCount);
 
-  // print the size of boxAndKindStart array
-  outputUintIn8Chars(molLookupRef.boxAndKindStartCount);
-  // print the BoxAndKindStart array
-  for(int i = 0; i < molLookupRef.boxAndKindStartCount; i++) {
-    outputUintIn8Chars(molLookupRef.boxAndKindStart[i]);
-  }
+  // print the BoxAndKindStart array with its size
+  output((uint32_t)molLookupRef.boxAndKindStartCount);
+  outputArray(molLookupRef.boxAndKindStart,
+              molLookupRef.boxAndKindStartCount);
 
   // print numKinds
-  outputUintIn8Chars(molLookupRef.numKinds);
+  output((uint32_t)molLookupRef.numKinds);
 
-  //print the size of fixedAtom array
-  outputUintIn8Chars((uint)molLookupRef.fixedAtom.size());
-  //print the fixedAtom array itself
-  for(int i = 0; i < molLookupRef.fixedAtom.size(); i++) {
-    outputUintIn8Chars(molLookupRef.fixedAtom[i]);
-  }
+  //print the fixedAtom array with its size
+  outputVector(molLookupRef.fixedAtom);
 }
 
 void CheckpointOutput::printMoveSettingsData()
 {
-  uint size_x, size_y, size_z;
-
-  // print size of scale
-  size_x = moveSetRef.scale.size();
-  size_y = moveSetRef.scale[0].size();
-  size_z = moveSetRef.scale[0][0].size();
-  outputUintIn8Chars(size_x);
-  outputUintIn8Chars(size_y);
-  outputUintIn8Chars(size_z);
+  beginSection(checkpoint::MOVE_SETTINGS);
+  outputVector3(moveSetRef.scale);
+  outputVector3(moveSetRef.acceptPercent);
+  outputVector3(moveSetRef.accepted);
+  outputVector3(moveSetRef.tries);
+  outputVector3(moveSetRef.tempAccepted);
+  outputVector3(moveSetRef.tempTries);
+}
 
-  // print scale array
-  for(int i = 0; i < size_x; i++) {
-    for(int j = 0; j < size_y; j++) {
-      for(int k = 0; k < size_z; k++) {
-        outputDoubleIn8Chars(moveSetRef.scale[i][j][k]);
-      }
-    }
+void CheckpointOutput::printPotential()
+{
+  beginSection(checkpoint::POTENTIAL);
+  output((uint32_t)BOX_TOTAL);
+  output(fingerprint);
+  for(uint b = 0; b < BOX_TOTAL; b++) {
+    Energy const& en = potentialRef.boxEnergy[b];
+    output(en.intraBond);
+    output(en.intraNonbond);
+    output(en.inter);
+    output(en.tc);
+    output(en.real);
+    output(en.recip);
+    output(en.self);
+    output(en.correction);
+    Virial const& vir = potentialRef.boxVirial[b];
+    output(vir.inter);
+    output(vir.tc);
+    output(vir.real);
+    output(vir.recip);
+    output(vir.self);
+    output(vir.correction);
+    outputTensor(vir.interTens);
+    outputTensor(vir.realTens);
+    outputTensor(vir.recipTens);
+    outputTensor(vir.corrTens);
   }
+}
 
-  // print size of acceptPercent
-  size_x = moveSetRef.acceptPercent.size();
-  size_y = moveSetRef.acceptPercent[0].size();
-  size_z = moveSetRef.acceptPercent[0][0].size();
-  outputUintIn8Chars(size_x);
-  outputUintIn8Chars(size_y);
-  outputUintIn8Chars(size_z);
-
-  // print acceptPercent array
-  for(int i = 0; i < size_x; i++) {
-    for(int j = 0; j < size_y; j++) {
-      for(int k = 0; k < size_z; k++) {
-        outputDoubleIn8Chars(moveSetRef.acceptPercent[i][j][k]);
-      }
+void CheckpointOutput::printRecip()
+{
+  //only for engines that keep nothing but the structure factors
+  std::vector<double> sumR, sumI;
+  if(ewaldRef == NULL || !ewaldRef->GetRecipSums(sumR, sumI, 0))
+    return;
+
+  beginSection(checkpoint::RECIP);
+  output((uint32_t)BOXES_WITH_U_NB);
+  output(fingerprint);
+  for(uint b = 0; b < BOXES_WITH_U_NB; b++) {
+    ewaldRef->GetRecipSums(sumR, sumI, b);
+    output((uint32_t)sumR.size());
+    output((uint32_t)0);
+    if(!sumR.empty()) {
+      outputArray(&sumR[0], sumR.size());
+      outputArray(&sumI[0], sumI.size());
     }
   }
+}
 
-  // print size of accepted
-  size_x = moveSetRef.accepted.size();
-  size_y = moveSetRef.accepted[0].size();
-  size_z = moveSetRef.accepted[0][0].size();
-  outputUintIn8Chars(size_x);
-  outputUintIn8Chars(size_y);
-  outputUintIn8Chars(size_z);
-
-  // print accepted array
-  for(int i = 0; i < size_x; i++) {
-    for(int j = 0; j < size_y; j++) {
-      for(int k = 0; k < size_z; k++) {
-        outputUintIn8Chars(moveSetRef.accepted[i][j][k]);
-      }
-    }
+template <typename T>
+void CheckpointOutput::outputVector3(vector<vector<vector<T> > > const& data)
+{
+  uint32_t size[3] = { (uint32_t)data.size(), 0, 0 };
+  if(size[0] != 0) {
+    size[1] = data[0].size();
+    if(size[1] != 0)
+      size[2] = data[0][0].size();
   }
-
-  // print size of tries
-  size_x = moveSetRef.tries.size();
-  size_y = moveSetRef.tries[0].size();
-  size_z = moveSetRef.tries[0][0].size();
-  outputUintIn8Chars(size_x);
-  outputUintIn8Chars(size_y);
-  outputUintIn8Chars(size_z);
-
-  // print tries array
-  for(int i = 0; i < size_x; i++) {
-    for(int j = 0; j < size_y; j++) {
-      for(int k = 0; k < size_z; k++) {
-        outputUintIn8Chars(moveSetRef.tries[i][j][k]);
-      }
+  outputArray(size, 3);
+  output((uint32_t)0);
+  for(uint i = 0; i < size[0]; i++) {
+    for(uint j = 0; j < size[1]; j++) {
+      if(size[2] != 0)
+        outputArray(&data[i][j][0], size[2]);
     }
   }
+  align();
+}
 
-  // print size of tempAccepted
-  size_x = moveSetRef.tempAccepted.size();
-  size_y = moveSetRef.tempAccepted[0].size();
-  size_z = moveSetRef.tempAccepted[0][0].size();
-  outputUintIn8Chars(size_x);
-  outputUintIn8Chars(size_y);
-  outputUintIn8Chars(size_z);
+void CheckpointOutput::align()
+{
+  buffer.resize((buffer.size() + 7) & ~(size_t)7, 0);
+}
 
-  // print tempAccepted array
-  for(int i = 0; i < size_x; i++) {
-    for(int j = 0; j < size_y; j++) {
-      for(int k = 0; k < size_z; k++) {
-        outputUintIn8Chars(moveSetRef.tempAccepted[i][j][k]);
-      }
-    }
+void CheckpointOutput::beginSection(const uint32_t id)
+{
+  align();
+  sectionId.push_back(id);
+  sectionOffset.push_back(buffer.size());
+}
+
+void CheckpointOutput::finish()
+{
+  align();
+  uint64_t tableOffset = buffer.size();
+  for(uint s = 0; s < sectionId.size(); s++) {
+    uint64_t end = (s + 1 < sectionId.size() ? sectionOffset[s + 1] :
+                    tableOffset);
+    uint64_t length = end - sectionOffset[s];
+    output(sectionId[s]);
+    output(checkpoint::Checksum(&buffer[sectionOffset[s]], length));
+    output(sectionOffset[s]);
+    output(length);
   }
 
-  // print size of tempTries
-  size_x = moveSetRef.tempTries.size();
-  size_y = moveSetRef.tempTries[0].size();
-  size_z = moveSetRef.tempTries[0][0].size();
-  outputUintIn8Chars(size_x);
-  outputUintIn8Chars(size_y);
-  outputUintIn8Chars(size_z);
+  memcpy(&buffer[0], checkpoint::MAGIC, checkpoint::MAGIC_LENGTH);
+  uint32_t version = checkpoint::VERSION, count = sectionId.size();
+  memcpy(&buffer[8], &version, sizeof(version));
+  memcpy(&buffer[12], &count, sizeof(count));
+  memcpy(&buffer[16], &tableOffset, sizeof(tableOffset));
+}
 
-  // print tempTries array
-  for(int i = 0; i < size_x; i++) {
-    for(int j = 0; j < size_y; j++) {
-      for(int k = 0; k < size_z; k++) {
-        outputUintIn8Chars(moveSetRef.tempTries[i][j][k]);
-      }
-    }
+void CheckpointOutput::startWriter()
+{
+#ifdef _WIN32
+  writeFile();
+#else
+  if(pthread_create(&writer, NULL, &CheckpointOutput::writerThread, this)
+      != 0) {
+    //no thread to spare, write it from here
+    writeFile();
+    return;
   }
+  writerRunning = true;
+#endif
 }
 
-void CheckpointOutput::openOutputFile()
+void CheckpointOutput::waitForWriter()
 {
-  outputFile = fopen(filename.c_str(), "wb");
-  if(outputFile == NULL) {
-    fprintf(stderr, "Error opening checkpoint output file %s\n",
-            filename.c_str());
-    exit(EXIT_FAILURE);
+#ifndef _WIN32
+  if(writerRunning) {
+    pthread_join(writer, NULL);
+    writerRunning = false;
   }
+#endif
 }
 
-void CheckpointOutput::outputDoubleIn8Chars(double data)
+void* CheckpointOutput::writerThread(void* self)
 {
-  if(outputFile == NULL) {
-    fprintf(stderr, "Error opening checkpoint output file %s\n",
-            filename.c_str());
-    exit(EXIT_FAILURE);
-  }
-  dbl_output_union temp;
-  temp.dbl_value = data;
-  fprintf(outputFile, "%c%c%c%c%c%c%c%c",
-          temp.bin_value[0],
-          temp.bin_value[1],
-          temp.bin_value[2],
-          temp.bin_value[3],
-          temp.bin_value[4],
-          temp.bin_value[5],
-          temp.bin_value[6],
-          temp.bin_value[7]);
-  fflush(outputFile);
+  static_cast<CheckpointOutput*>(self)->writeFile();
+  return NULL;
 }
 
-void CheckpointOutput::outputUintIn8Chars(uint32_t data)
+void CheckpointOutput::writeFile()
 {
+  std::string tempName = filename + ".tmp";
+  FILE* outputFile = fopen(tempName.c_str(), "wb");
   if(outputFile == NULL) {
     fprintf(stderr, "Error opening checkpoint output file %s\n",
-            filename.c_str());
+            tempName.c_str());
     exit(EXIT_FAILURE);
   }
-  uint32_output_union temp;
-  temp.uint_value = data;
-  fprintf(outputFile, "%c%c%c%c%c%c%c%c",
-          temp.bin_value[0],
-          temp.bin_value[1],
-          temp.bin_value[2],
-          temp.bin_value[3],
-          temp.bin_value[4],
-          temp.bin_value[5],
-          temp.bin_value[6],
-          temp.bin_value[7]);
-  fflush(outputFile);
-}
\ No newline at end of file
+  bool ok = fwrite(&writeBuffer[0], 1, writeBuffer.size(), outputFile) ==
+            writeBuffer.size();
+  ok = ok && fflush(outputFile) == 0;
+#ifdef _WIN32
+  ok = ok && _commit(_fileno(outputFile)) == 0;
+#else
+  ok = ok && fsync(fileno(outputFile)) == 0;
+#endif
+  ok = (fclose(outputFile) == 0) && ok;
+  if(!ok) {
+    fprintf(stderr, "Error writing checkpoint output file %s\n",
+            tempName.c_str());
+    exit(EXIT_FAILURE);
+  }
+#ifdef _WIN32
+  //rename does not replace an existing file on Windows
+  remove(filename.c_str());
+#endif
+  if(rename(tempName.c_str(), filename.c_str()) != 0) {
+    fprintf(stderr, "Error renaming %s to checkpoint output file %s\n",
+            tempName.c_str(), filename.c_str());
+    exit(EXIT_FAILURE);
+  }
+}
+
@@ -9,7 +9,13 @@ along with this program, also can be found at <http://www.gnu.org/licenses/>.
 #include "OutputAbstracts.h"
 #include "MoveSettings.h"
 #include "Coordinates.h"
+#include "CheckpointSetup.h" //For file layout
 #include <iostream>
+#include <vector>
+#include <stdint.h>
+#ifndef _WIN32
+#include <pthread.h>
+#endif
 
 class CheckpointOutput : public OutputableBase
 {
@@ -18,8 +24,7 @@ public:
 
   ~CheckpointOutput()
   {
-    if(outputFile)
-      fclose(outputFile);
+    waitForWriter();
   }
 
   virtual void DoOutput(const ulong step);
@@ -44,20 +49,70 @@ private:
   Molecules const & molRef;
   PRNG & prngRef;
   Coordinates & coordCurrRef;
+  SystemPotential & potentialRef;
+  Ewald const* ewaldRef;
+  uint32_t fingerprint; //checkpoint::Fingerprint of the settings
 
   bool enableOutCheckpoint;
+  bool saveState; //also save the running energies and Ewald sums
   std::string filename;
-  FILE* outputFile;
   ulong stepsPerCheckpoint;
 
-  void openOutputFile();
+  //The MC loop serializes into buffer, which is then handed over to a
+  //writer thread as writeBuffer. The thread writes it to a temporary file
+  //and renames that over filename, so a crash never leaves a partly
+  //written checkpoint behind.
+  std::vector<char> buffer;
+  std::vector<char> writeBuffer;
+#ifndef _WIN32
+  pthread_t writer;
+  bool writerRunning;
+#endif
+
+  void startWriter();
+  void waitForWriter();
+  static void* writerThread(void* self);
+  void writeFile();
+
+  //sections of the file, see CheckpointSetup.h
+  std::vector<uint32_t> sectionId;
+  std::vector<uint64_t> sectionOffset;
+
   void printStepNumber(const ulong step);
   void printRandomNumbers();
   void printCoordinates();
   void printMoleculeLookupData();
   void printMoveSettingsData();
   void printBoxDimensionsData();
+  void printPotential();
+  void printRecip();
 
-  void outputDoubleIn8Chars(double data);
-  void outputUintIn8Chars(uint32_t data);
+  void beginSection(const uint32_t id);
+  void finish();
+  template <typename T>
+  void output(T const& data)
+  {
+    outputArray(&data, 1);
+  }
+  template <typename T>
+  void outputArray(T const* data, const uint64_t count)
+  {
+    const char* bytes = reinterpret_cast<const char*>(data);
+    buffer.insert(buffer.end(), bytes, bytes + count * sizeof(T));
+  }
+  template <typename T>
+  void outputVector(std::vector<T> const& data)
+  {
+    output((uint32_t)data.size());
+    if(!data.empty())
+      outputArray(&data[0], data.size());
+  }
+  template <typename T>
+  void outputVector3(vector<vector<vector<T> > > const& data);
+  void outputTensor(const double (&tens)[3][3])
+  {
+    for(uint i = 0; i < 3; i++)
+      outputArray(tens[i], 3);
+  }
+  void align();
 };
@@ -6,9 +6,18 @@ along with this program, also can be found at <http://www.gnu.org/licenses/>.
 ********************************************************************************/
 
 #include <stdint.h>
+#include <cstring>
+#include <cstdio>
 #include "CheckpointSetup.h"
 #include "MoleculeLookup.h"
+#include "FFParticle.h"
 #include "System.h"
+#ifndef _WIN32
+#include <sys/mman.h> //for mmap
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
 
 namespace
 {
@@ -23,27 +32,367 @@ union uint32_input_union {
 };
 }
 
+uint32_t checkpoint::Checksum(const char* data, const uint64_t length)
+{
+  static uint32_t table[256];
+  static bool tableDone = false;
+  if(!tableDone) {
+    for(uint32_t i = 0; i < 256; i++) {
+      uint32_t c = i;
+      for(int k = 0; k < 8; k++)
+        c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+      table[i] = c;
+    }
+    tableDone = true;
+  }
+
+  uint32_t crc = 0xFFFFFFFFu;
+  for(uint64_t i = 0; i < length; i++)
+    crc = table[(crc ^ (unsigned char)data[i]) & 0xFF] ^ (crc >> 8);
+  return crc ^ 0xFFFFFFFFu;
+}
+
+uint32_t checkpoint::Fingerprint(config_setup::SystemVals const& sys,
+                                 StaticVals const& statV)
+{
+  std::vector<double> value;
+  value.push_back(sys.ff.VDW_KIND);
+  value.push_back(sys.ff.cutoff);
+  value.push_back(sys.ff.cutoffLow);
+  value.push_back(sys.ff.rswitch);
+  value.push_back(sys.ff.doTailCorr);
+  value.push_back(sys.ff.vdwGeometricSigma);
+  value.push_back(sys.ff.pairTable);
+  value.push_back(sys.ff.pairTable ? sys.ff.tablePoints : 0);
+  value.push_back(sys.ff.frameworkGrid);
+  value.push_back(sys.ff.frameworkGrid ? sys.ff.gridSpacing : 0.0);
+  value.push_back(sys.ff.frameworkGrid && sys.ff.gridInterp);
+  value.push_back(sys.exclude.EXCLUDE_KIND);
+  value.push_back(sys.elect.enable);
+  value.push_back(sys.elect.ewald);
+  value.push_back(sys.elect.pme);
+  value.push_back(sys.elect.pme ? sys.elect.pmeSpacing : 0.0);
+  value.push_back(sys.elect.tolerance);
+  value.push_back(sys.elect.oneFourScale);
+  value.push_back(sys.elect.dielectric);
+  for(uint b = 0; b < BOX_TOTAL; b++)
+    value.push_back(sys.elect.cutoffCoulomb[b]);
+
+  //parameter file
+  FFParticle const& particles = *statV.forcefield.particles;
+  uint count = particles.NumKinds();
+  value.push_back(count);
+  for(uint i = 0; i < count; i++) {
+    for(uint j = 0; j < count; j++) {
+      value.push_back(particles.GetEpsilon(i, j));
+      value.push_back(particles.GetSigma(i, j));
+      value.push_back(particles.GetN(i, j));
+      value.push_back(particles.GetEpsilon_1_4(i, j));
+      value.push_back(particles.GetSigma_1_4(i, j));
+      value.push_back(particles.GetN_1_4(i, j));
+    }
+  }
+
+  //PSF files
+  Molecules const& mols = statV.mol;
+  value.push_back(mols.GetKindsCount());
+  for(uint k = 0; k < mols.GetKindsCount(); k++) {
+    MoleculeKind const& kind = mols.kinds[k];
+    value.push_back(kind.NumAtoms());
+    value.push_back(kind.oneThree);
+    value.push_back(kind.oneFour);
+    for(uint a = 0; a < kind.NumAtoms(); a++) {
+      value.push_back(kind.AtomKind(a));
+      value.push_back(kind.AtomCharge(a));
+    }
+  }
+  return Checksum(reinterpret_cast<const char*>(&value[0]),
+                  value.size() * sizeof(double));
+}
+
 CheckpointSetup::CheckpointSetup(System & sys, StaticVals const& statV) :
   moveSetRef(sys.moveSettings), molLookupRef(sys.molLookupRef),
   boxDimRef(sys.boxDimRef),  molRef(statV.mol), prngRef(sys.prng),
   coordCurrRef(sys.coordinates), filename("checkpoint.dat")
 {
-  inputFile = NULL;
+  fileData = NULL;
+  fileSize = 0;
   saveArray = NULL;
+  fileVersion = 0;
+  hasPotential = false;
+  hasRecip = false;
+  potentialFingerprint = recipFingerprint = 0;
 }
 
 void CheckpointSetup::ReadAll()
 {
   openInputFile();
-  readStepNumber();
-  readBoxDimensionsData();
-  readRandomNumbers();
-  readCoordinates();
-  readMoleculeLookupData();
-  readMoveSettingsData();
+  if(fileSize >= checkpoint::HEADER_SIZE &&
+      memcmp(fileData, checkpoint::MAGIC, checkpoint::MAGIC_LENGTH) == 0) {
+    readSections();
+  } else {
+    readPos = 0;
+    readEnd = fileSize;
+    readStepNumber();
+    readBoxDimensionsData();
+    readRandomNumbers();
+    readCoordinates();
+    readMoleculeLookupData();
+    readMoveSettingsData();
+  }
+  closeInputFile();
   std::cout << "Checkpoint loaded from " << filename << std::endl;
 }
 
+void CheckpointSetup::readSections()
+{
+  uint32_t version, count;
+  uint64_t tableOffset;
+  readPos = checkpoint::MAGIC_LENGTH;
+  readEnd = checkpoint::HEADER_SIZE;
+  read(version);
+  read(count);
+  read(tableOffset);
+  fileVersion = version;
+  if(version != checkpoint::VERSION && version != 1) {
+    std::cerr << "ERROR: Checkpoint file " << filename << " has version "
+              << version << ", expected " << checkpoint::VERSION << "\n";
+    exit(EXIT_FAILURE);
+  }
+
+  readPos = tableOffset;
+  readEnd = fileSize;
+  sectionId.resize(count);
+  sectionOffset.resize(count);
+  sectionLength.resize(count);
+  for(uint32_t s = 0; s < count; s++) {
+    uint32_t checksum;
+    read(sectionId[s]);
+    read(checksum);
+    read(sectionOffset[s]);
+    read(sectionLength[s]);
+    if(sectionOffset[s] > fileSize ||
+        sectionLength[s] > fileSize - sectionOffset[s] ||
+        checkpoint::Checksum(fileData + sectionOffset[s], sectionLength[s])
+        != checksum) {
+      std::cerr << "ERROR: Checkpoint file " << filename
+                << " is corrupted (section " << sectionId[s] << ")\n";
+      exit(EXIT_FAILURE);
+    }
+  }
+
+  readStepSection();
+  readBoxSection();
+  readPRNGSection();
+  readCoordinatesSection();
+  readMoleculeLookupSection();
+  readMoveSettingsSection();
+  readPotentialSection();
+  readRecipSection();
+}
+
+bool CheckpointSetup::seekSection(const uint32_t id, const bool required)
+{
+  for(uint s = 0; s < sectionId.size(); s++) {
+    if(sectionId[s] == id) {
+      readPos = sectionOffset[s];
+      readEnd = sectionOffset[s] + sectionLength[s];
+      return true;
+    }
+  }
+  if(required) {
+    std::cerr << "ERROR: Checkpoint file " << filename
+              << " has no section " << id << "\n";
+    exit(EXIT_FAILURE);
+  }
+  return false;
+}
+
+void CheckpointSetup::readStepSection()
+{
+  uint64_t step;
+  seekSection(checkpoint::STEP, true);
+  read(step);
+  stepNumber = step;
+}
+
+void CheckpointSetup::readBoxSection()
+{
+  uint32_t pad;
+  seekSection(checkpoint::BOX, true);
+  read(totalBoxes);
+  read(pad);
+  axis.resize(totalBoxes);
+  cosAngle.resize(totalBoxes);
+  for(uint b = 0; b < totalBoxes; b++) {
+    axis[b].resize(3);
+    cosAngle[b].resize(3);
+    readArray(&axis[b][0], 3);
+    readArray(&cosAngle[b][0], 3);
+  }
+}
+
+void CheckpointSetup::readPRNGSection()
+{
+  const int N = 624;
+  seekSection(checkpoint::PRNG, true);
+  if(saveArray != NULL) {
+    delete[] saveArray;
+    saveArray = NULL;
+  }
+  saveArray = new uint32_t[N];
+  readArray(saveArray, N);
+  read(seedLocation);
+  read(seedLeft);
+  read(seedValue);
+}
+
+void CheckpointSetup::readCoordinatesSection()
+{
+  uint32_t pad;
+  seekSection(checkpoint::COORDINATES, true);
+  read(coordLength);
+  read(pad);
+  coords.Init(coordLength);
+  readArray(coords.x, coordLength);
+  readArray(coords.y, coordLength);
+  readArray(coords.z, coordLength);
+}
+
+void CheckpointSetup::readMoleculeLookupSection()
+{
+  seekSection(checkpoint::MOL_LOOKUP, true);
+  readVector(molLookupVec);
+  readVector(boxAndKindStartVec);
+  read(numKinds);
+  readVector(fixedAtomVec);
+}
+
+void CheckpointSetup::readMoveSettingsSection()
+{
+  seekSection(checkpoint::MOVE_SETTINGS, true);
+  readVector3(scaleVec);
+  readVector3(acceptPercentVec);
+  readVector3(acceptedVec);
+  readVector3(triesVec);
+  readVector3(tempAcceptedVec);
+  readVector3(tempTriesVec);
+}
+
+void CheckpointSetup::readPotentialSection()
+{
+  uint32_t boxes;
+  hasPotential = false;
+  //version 1 saved the objects as laid out in memory, recompute them
+  if(fileVersion < 2 || !seekSection(checkpoint::POTENTIAL, false))
+    return;
+  read(boxes);
+  read(potentialFingerprint);
+  if(boxes != BOX_TOTAL)
+    return;
+  for(uint b = 0; b < BOX_TOTAL; b++) {
+    Energy& en = boxEnergy[b];
+    read(en.intraBond);
+    read(en.intraNonbond);
+    read(en.inter);
+    read(en.tc);
+    read(en.real);
+    read(en.recip);
+    read(en.self);
+    read(en.correction);
+    Virial& vir = boxVirial[b];
+    read(vir.inter);
+    read(vir.tc);
+    read(vir.real);
+    read(vir.recip);
+    read(vir.self);
+    read(vir.correction);
+    readTensor(vir.interTens);
+    readTensor(vir.realTens);
+    readTensor(vir.recipTens);
+    readTensor(vir.corrTens);
+  }
+  hasPotential = true;
+}
+
+void CheckpointSetup::readRecipSection()
+{
+  uint32_t boxes, size, pad;
+  hasRecip = false;
+  if(fileVersion < 2 || !seekSection(checkpoint::RECIP, false))
+    return;
+  read(boxes);
+  read(recipFingerprint);
+  sumRVec.resize(boxes);
+  sumIVec.resize(boxes);
+  for(uint b = 0; b < boxes; b++) {
+    read(size);
+    read(pad);
+    sumRVec[b].resize(size);
+    sumIVec[b].resize(size);
+    if(size != 0) {
+      readArray(&sumRVec[b][0], size);
+      readArray(&sumIVec[b][0], size);
+    }
+  }
+  hasRecip = true;
+}
+
+template <typename T>
+void CheckpointSetup::read(T & value)
+{
+  readArray(&value, 1);
+}
+
+void CheckpointSetup::readTensor(double (&tens)[3][3])
+{
+  for(uint i = 0; i < 3; i++)
+    readArray(tens[i], 3);
+}
+
+template <typename T>
+void CheckpointSetup::readArray(T * values, const uint64_t count)
+{
+  if(count == 0)
+    return;
+  checkRead(count * sizeof(T));
+  memcpy(values, fileData + readPos, count * sizeof(T));
+  readPos += count * sizeof(T);
+}
+
+template <typename T>
+void CheckpointSetup::readVector(vector<T> & vec)
+{
+  uint32_t size;
+  read(size);
+  vec.resize(size);
+  if(size != 0)
+    readArray(&vec[0], size);
+}
+
+template <typename T>
+void CheckpointSetup::readVector3(vector<vector<vector<T> > > & vec)
+{
+  uint32_t size[3], pad;
+  readArray(size, 3);
+  read(pad);
+  vec.resize(size[0]);
+  for(uint i = 0; i < size[0]; i++) {
+    vec[i].resize(size[1]);
+    for(uint j = 0; j < size[1]; j++) {
+      vec[i][j].resize(size[2]);
+      if(size[2] != 0)
+        readArray(&vec[i][j][0], size[2]);
+    }
+  }
+  align();
+}
+
+void CheckpointSetup::align()
+{
+  readPos = (readPos + 7) & ~(uint64_t)7;
+}
+
 void CheckpointSetup::readStepNumber()
 {
   stepNumber = readUintIn8Chars();
@@ -246,52 +595,79 @@ void CheckpointSetup::readMoveSettingsData()
 
 void CheckpointSetup::openInputFile()
 {
-  inputFile = fopen(filename.c_str(), "rb");
+#ifndef _WIN32
+  int fd = open(filename.c_str(), O_RDONLY);
+  struct stat st;
+  if(fd != -1 && fstat(fd, &st) == 0 && st.st_size > 0) {
+    void* map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if(map != MAP_FAILED) {
+      fileData = static_cast<const char*>(map);
+      fileSize = st.st_size;
+      close(fd);
+      return;
+    }
+  }
+  if(fd != -1)
+    close(fd);
+#endif
+  //no mmap, read the whole file instead
+  FILE* inputFile = fopen(filename.c_str(), "rb");
   if(inputFile == NULL) {
     fprintf(stderr, "Error opening checkpoint input file %s\n",
             filename.c_str());
     exit(EXIT_FAILURE);
   }
+  fseek(inputFile, 0, SEEK_END);
+  long size = ftell(inputFile);
+  fseek(inputFile, 0, SEEK_SET);
+  fileBuffer.resize(size > 0 ? size : 1);
+  if(size > 0 && fread(&fileBuffer[0], 1, size, inputFile) != (size_t)size) {
+    fprintf(stderr, "Error reading checkpoint input file %s\n",
+            filename.c_str());
+    exit(EXIT_FAILURE);
+  }
+  fclose(inputFile);
+  fileData = &fileBuffer[0];
+  fileSize = (size > 0 ? size : 0);
 }
 
-double CheckpointSetup::readDoubleIn8Chars()
+void CheckpointSetup::closeInputFile()
 {
-  if(inputFile == NULL) {
-    fprintf(stderr, "Error opening checkpoint output file %s\n",
-            filename.c_str());
+  if(fileData == NULL)
+    return;
+#ifndef _WIN32
+  if(fileBuffer.empty())
+    munmap(const_cast<char*>(fileData), fileSize);
+#endif
+  std::vector<char>().swap(fileBuffer);
+  fileData = NULL;
+  fileSize = 0;
+}
+
+void CheckpointSetup::checkRead(const uint64_t length)
+{
+  if(readPos > readEnd || length > readEnd - readPos) {
+    std::cerr << "ERROR: Checkpoint file " << filename
+              << " ends unexpectedly\n";
     exit(EXIT_FAILURE);
   }
+}
+
+double CheckpointSetup::readDoubleIn8Chars()
+{
   dbl_input_union temp;
-  fscanf(inputFile, "%c%c%c%c%c%c%c%c",
-         &temp.bin_value[0],
-         &temp.bin_value[1],
-         &temp.bin_value[2],
-         &temp.bin_value[3],
-         &temp.bin_value[4],
-         &temp.bin_value[5],
-         &temp.bin_value[6],
-         &temp.bin_value[7]);
+  checkRead(8);
+  memcpy(temp.bin_value, fileData + readPos, 8);
+  readPos += 8;
   return temp.dbl_value;
 }
 
 uint32_t CheckpointSetup::readUintIn8Chars()
 {
-  uint32_t data;
-  if(inputFile == NULL) {
-    fprintf(stderr, "Error opening checkpoint output file %s\n",
-            filename.c_str());
-    exit(EXIT_FAILURE);
-  }
   uint32_input_union temp;
-  fscanf(inputFile, "%c%c%c%c%c%c%c%c",
-         &temp.bin_value[0],
-         &temp.bin_value[1],
-         &temp.bin_value[2],
-         &temp.bin_value[3],
-         &temp.bin_value[4],
-         &temp.bin_value[5],
-         &temp.bin_value[6],
-         &temp.bin_value[7]);
+  checkRead(8);
+  memcpy(temp.bin_value, fileData + readPos, 8);
+  readPos += 8;
   return temp.uint_value;
 }
 
@@ -352,3 +728,12 @@ void CheckpointSetup::SetMoveSettings(MoveSettings & moveSettings)
   moveSettings.tempAccepted = this->tempAcceptedVec;
   moveSettings.tempTries = this->tempTriesVec;
 }
+
+void CheckpointSetup::SetPotential(SystemPotential & potential)
+{
+  for(uint b = 0; b < BOX_TOTAL; b++) {
+    potential.boxEnergy[b] = boxEnergy[b];
+    potential.boxVirial[b] = boxVirial[b];
+  }
+  potential.Total();
+}
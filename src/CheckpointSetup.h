@@ -10,6 +10,73 @@ along with this program, also can be found at <http://www.gnu.org/licenses/>.
 #include "MoveSettings.h"
 #include "Coordinates.h"
 #include <iostream>
+#include <stdint.h>
+
+//
+//    Checkpoint file, written by CheckpointOutput. Values are stored in the
+//    byte order of the machine that wrote them.
+//
+//    Header:
+//      char[8] MAGIC, uint32 VERSION, uint32 section count,
+//      uint64 offset of the section table
+//    Section table, one entry per section:
+//      uint32 id, uint32 CRC-32 of the section, uint64 offset, uint64 length
+//
+//    Every section starts on an 8 byte boundary, so the arrays in it can be
+//    used straight from the mapped file. Sections:
+//      STEP           uint64 step
+//      BOX            uint32 boxes, pad, per box double axis[3], cosAngle[3]
+//      PRNG           uint32 state[624], location, left, seed
+//      COORDINATES    uint32 count, pad, double x[count], y[count], z[count]
+//      MOL_LOOKUP     uint32 arrays with their size in front: molLookup,
+//                     boxAndKindStart, then uint32 numKinds, then fixedAtom
+//      MOVE_SETTINGS  scale, acceptPercent, accepted, tries, tempAccepted,
+//                     tempTries, each as uint32 size[3], pad and the values
+//                     (double or uint32), padded to 8 bytes
+//    Optional (CheckpointState), both start with the Fingerprint of the
+//    settings they were computed with and are only used if it matches:
+//      POTENTIAL      uint32 boxes, fingerprint, per box double Energy
+//                     intraBond, intraNonbond, inter, tc, real, recip,
+//                     self, correction, Virial inter, tc, real, recip,
+//                     self, correction, interTens[9], realTens[9],
+//                     recipTens[9], corrTens[9]
+//      RECIP          uint32 boxes, fingerprint, per box uint32 size, pad,
+//                     double sumR[size], sumI[size]
+//
+//    Version 1 files are read without their optional sections. Files
+//    without MAGIC are read in the original layout (every value in 8
+//    bytes, in the order of the sections above without the optional ones).
+//
+namespace checkpoint
+{
+static const char MAGIC[] = "GOMCCHKP";
+static const uint MAGIC_LENGTH = 8;
+static const uint32_t VERSION = 2;
+static const uint HEADER_SIZE = 24;
+static const uint ENTRY_SIZE = 24;
+
+enum Section {
+  STEP = 1,
+  BOX,
+  PRNG,
+  COORDINATES,
+  MOL_LOOKUP,
+  MOVE_SETTINGS,
+  POTENTIAL,
+  RECIP
+};
+
+//CRC-32 (IEEE 802.3) of length bytes of data
+uint32_t Checksum(const char* data, const uint64_t length);
+
+//Checksum of what the running energies and Ewald sums depend on: the
+//cutoffs, tail corrections, potential and exclusion kind, electrostatics
+//and the Ewald engine, pair tables and framework grids of the config, the
+//LJ/Mie parameters of every pair of atom kinds and the atom kinds,
+//charges and 1-3/1-4 exclusions of every molecule kind
+uint32_t Fingerprint(config_setup::SystemVals const& config,
+                     StaticVals const& statV);
+}
 
 class CheckpointSetup
 {
@@ -18,10 +85,7 @@ public:
 
   ~CheckpointSetup()
   {
-    if(inputFile != NULL) {
-      fclose(inputFile);
-      inputFile = NULL;
-    }
+    closeInputFile();
     if(saveArray != NULL) {
       delete [] saveArray;
       saveArray = NULL;
@@ -36,6 +100,31 @@ public:
   void SetMoleculeLookup(MoleculeLookup & molLookupRef);
   void SetMoveSettings(MoveSettings & moveSettings);
 
+  //Running energies and Ewald structure factors, if the checkpoint was
+  //written with CheckpointState by a run with the same Fingerprint
+  bool HasPotential(const uint32_t fingerprint) const
+  {
+    return hasPotential && potentialFingerprint == fingerprint;
+  }
+  void SetPotential(SystemPotential & potential);
+  bool HasRecip(const uint32_t fingerprint) const
+  {
+    return hasRecip && recipFingerprint == fingerprint;
+  }
+  //True if the file has either, whatever the settings
+  bool HasState() const
+  {
+    return hasPotential || hasRecip;
+  }
+  std::vector<std::vector<double> > const& RecipReal() const
+  {
+    return sumRVec;
+  }
+  std::vector<std::vector<double> > const& RecipImaginary() const
+  {
+    return sumIVec;
+  }
+
 private:
   MoveSettings & moveSetRef;
   MoleculeLookup & molLookupRef;
@@ -45,7 +134,13 @@ private:
   PRNG & prngRef;
 
   std::string filename;
-  FILE* inputFile;
+  //the whole file, mapped (or read, where mmap is not available)
+  const char* fileData;
+  uint64_t fileSize;
+  uint64_t readPos, readEnd;
+  std::vector<char> fileBuffer;
+  std::vector<uint32_t> sectionId;
+  std::vector<uint64_t> sectionOffset, sectionLength;
 
   // the following variables will hold the data read from checkpoint
   // and will be passed to the rest of the code via Get functions
@@ -62,17 +157,48 @@ private:
   vector<vector<vector<double> > > scaleVec, acceptPercentVec;
   vector<vector<vector<uint32_t> > > acceptedVec, triesVec, tempAcceptedVec,
          tempTriesVec;
+  uint32_t fileVersion;
+  bool hasPotential, hasRecip;
+  uint32_t potentialFingerprint, recipFingerprint;
+  Energy boxEnergy[BOX_TOTAL];
+  Virial boxVirial[BOX_TOTAL];
+  vector<vector<double> > sumRVec, sumIVec;
 
   // private functions used by ReadAll and Get functions
   void openInputFile();
+  void closeInputFile();
+
+  // sectioned format
+  void readSections();
+  bool seekSection(const uint32_t id, const bool required);
+  void readStepSection();
+  void readBoxSection();
+  void readPRNGSection();
+  void readCoordinatesSection();
+  void readMoleculeLookupSection();
+  void readMoveSettingsSection();
+  void readPotentialSection();
+  void readRecipSection();
+  template <typename T>
+  void read(T & value);
+  template <typename T>
+  void readArray(T * values, const uint64_t count);
+  template <typename T>
+  void readVector(vector<T> & vec);
+  template <typename T>
+  void readVector3(vector<vector<vector<T> > > & vec);
+  void readTensor(double (&tens)[3][3]);
+  void align();
+
+  // original format
   void readStepNumber();
   void readRandomNumbers();
   void readCoordinates();
   void readMoleculeLookupData();
   void readMoveSettingsData();
   void readBoxDimensionsData();
-  void closeInputFile();
 
   double readDoubleIn8Chars();
   uint32_t readUintIn8Chars();
+  void checkRead(const uint64_t length);
 };
@@ -38,11 +38,15 @@ ConfigSetup::ConfigSetup(void)
   in.restart.step = ULONG_MAX;
   in.restart.recalcTrajectory = false;
   in.restart.restartFromCheckpoint = false;
+  in.restart.frameIndexFile = false;
   in.prng.seed = UINT_MAX;
   sys.elect.readEwald = false;
   sys.elect.readElect = false;
   sys.elect.readCache = false;
+  sys.elect.cacheFloat = false;
   sys.elect.ewald = false;
+  sys.elect.pme = false;
+  sys.elect.pmeSpacing = 1.0;
   sys.elect.enable = false;
   sys.elect.tolerance = DBL_MAX;
   sys.elect.oneFourScale = DBL_MAX;
@@ -54,6 +58,8 @@ ConfigSetup::ConfigSetup(void)
   sys.step.adjustment = ULONG_MAX;
   sys.step.pressureCalcFreq = ULONG_MAX;
   sys.step.pressureCalc = true;
+  sys.step.virialTracking = false;
+  sys.step.virialFullFreq = 0;
   in.ffKind.numOfKinds = 0;
   sys.exclude.EXCLUDE_KIND = UINT_MAX;
   in.prng.kind = "";
@@ -77,7 +83,13 @@ ConfigSetup::ConfigSetup(void)
   sys.ff.rswitch = DBL_MAX;
   sys.ff.cutoff = DBL_MAX;
   sys.ff.cutoffLow = DBL_MAX;
+  sys.ff.verletSkin = 0.0;
   sys.ff.vdwGeometricSigma = false;
+  sys.ff.pairTable = false;
+  sys.ff.tablePoints = 100;
+  sys.ff.frameworkGrid = false;
+  sys.ff.gridInterp = true;
+  sys.ff.gridSpacing = 0.2;
   sys.moves.displace = DBL_MAX;
   sys.moves.rotate = DBL_MAX;
   sys.moves.intraSwap = DBL_MAX;
@@ -101,6 +113,9 @@ ConfigSetup::ConfigSetup(void)
 #endif
   out.checkpoint.enable = false;
   out.checkpoint.frequency = ULONG_MAX;
+  out.checkpointState = false;
+  out.binaryCoord.enable = false;
+  out.binaryCoord.frequency = ULONG_MAX;
   out.statistics.settings.uniqueStr.val = "";
   out.state.settings.frequency = ULONG_MAX;
   out.restart.settings.frequency = ULONG_MAX;
@@ -180,6 +195,11 @@ void ConfigSetup::Init(const char *fileName)
       if(in.restart.restartFromCheckpoint) {
         printf("%-40s %-s \n", "Info: Restart checkpoint", "Active");
       }
+    } else if(CheckString(line[0], "TrajectoryIndex")) {
+      in.restart.frameIndexFile = checkBool(line[1]);
+      if(in.restart.frameIndexFile) {
+        printf("%-40s %-s \n", "Info: Trajectory frame index file", "Active");
+      }
     } else if(CheckString(line[0], "FirstStep")) {
       in.restart.step = stringtoi(line[1]);
     } else if(CheckString(line[0], "PRNG")) {
@@ -389,6 +409,37 @@ void ConfigSetup::Init(const char *fileName)
     } else if(CheckString(line[0], "RcutLow")) {
       sys.ff.cutoffLow = stringtod(line[1]);
       printf("%-40s %-4.4f A\n", "Info: Short Range Cutoff", sys.ff.cutoffLow);
+    } else if(CheckString(line[0], "PairTable")) {
+      sys.ff.pairTable = checkBool(line[1]);
+      if(line.size() == 3)
+        sys.ff.tablePoints = stringtoi(line[2]);
+      if(sys.ff.pairTable) {
+        printf("%-40s %-u \n", "Info: Pair table points per A^2",
+               sys.ff.tablePoints);
+      }
+    } else if(CheckString(line[0], "FrameworkGrid")) {
+      sys.ff.frameworkGrid = checkBool(line[1]);
+      if(line.size() >= 3)
+        sys.ff.gridSpacing = stringtod(line[2]);
+      if(line.size() == 4) {
+        if(CheckString(line[3], "nearest")) {
+          sys.ff.gridInterp = false;
+        } else if(!CheckString(line[3], "linear")) {
+          std::cout << "Error: Framework grid lookup must be linear or "
+                    << "nearest!" << std::endl;
+          exit(EXIT_FAILURE);
+        }
+      }
+      if(sys.ff.frameworkGrid) {
+        printf("%-40s %-4.4f A %s\n", "Info: Framework grid spacing",
+               sys.ff.gridSpacing, sys.ff.gridInterp ? "(linear)" : "(nearest)");
+      }
+    } else if(CheckString(line[0], "FrameworkGridFile")) {
+      sys.ff.gridFile = line[1];
+      printf("%-40s %-s \n", "Info: Framework grid file", line[1].c_str());
+    } else if(CheckString(line[0], "VerletSkin")) {
+      sys.ff.verletSkin = stringtod(line[1]);
+      printf("%-40s %-4.4f A\n", "Info: Verlet list skin", sys.ff.verletSkin);
     } else if(CheckString(line[0], "Exclude")) {
       if(line[1] == sys.exclude.EXC_ONETWO) {
         sys.exclude.EXCLUDE_KIND = sys.exclude.EXC_ONETWO_KIND;
@@ -429,11 +480,30 @@ void ConfigSetup::Init(const char *fileName)
     } else if(CheckString(line[0], "CachedFourier")) {
       sys.elect.cache = checkBool(line[1]);
       sys.elect.readCache = true;
+      if(line.size() == 3) {
+        if(CheckString(line[2], "float")) {
+          sys.elect.cacheFloat = true;
+        } else if(!CheckString(line[2], "double")) {
+          std::cout << "Error: Precision of the Fourier cache must be float "
+                    << "or double!" << std::endl;
+          exit(EXIT_FAILURE);
+        }
+      }
       if(sys.elect.cache) {
-        printf("%-40s %-s \n", "Info: Cache Ewald Fourier", "Active");
+        printf("%-40s %-s \n", "Info: Cache Ewald Fourier",
+               sys.elect.cacheFloat ? "Active (float)" : "Active");
       } else {
         printf("%-40s %-s \n", "Info: Cache Ewald Fourier", "Inactive");
       }
+    } else if(CheckString(line[0], "PME")) {
+      sys.elect.pme = checkBool(line[1]);
+      if(sys.elect.pme) {
+        printf("%-40s %-s \n", "Info: Particle Mesh Ewald", "Active");
+      }
+    } else if(CheckString(line[0], "PMESpacing")) {
+      sys.elect.pmeSpacing = stringtod(line[1]);
+      printf("%-40s %-4.4f A \n", "Info: PME Mesh Spacing",
+             sys.elect.pmeSpacing);
     } else if(CheckString(line[0], "1-4scaling")) {
       sys.elect.oneFourScale = stringtod(line[1]);
     } else if(CheckString(line[0], "Dielectric")) {
@@ -469,6 +539,12 @@ void ConfigSetup::Init(const char *fileName)
         printf("%-40s %-lu \n", "Info: Pressure calculation frequency",
                sys.step.pressureCalcFreq);
       }
+    } else if(CheckString(line[0], "VirialTracking")) {
+      sys.step.virialTracking = checkBool(line[1]);
+      if(line.size() == 3)
+        sys.step.virialFullFreq = stringtoi(line[2]);
+      if(sys.step.virialTracking)
+        printf("%-40s %-s \n", "Info: Virial tracking", "Active");
     } else if(CheckString(line[0], "DisFreq")) {
       sys.moves.displace = stringtod(line[1]);
       printf("%-40s %-4.4f \n", "Info: Displacement move frequency",
@@ -673,6 +749,11 @@ void ConfigSetup::Init(const char *fileName)
                out.checkpoint.frequency);
       else
         printf("%-40s %-s \n", "Info: Saving checkpoint", "Inactive");
+    } else if(CheckString(line[0], "CheckpointState")) {
+      out.checkpointState = checkBool(line[1]);
+      if(out.checkpointState)
+        printf("%-40s %-s \n", "Info: Checkpoint energies and Ewald sums",
+               "Active");
     } else if(CheckString(line[0], "CoordinatesFreq")) {
       out.state.settings.enable = checkBool(line[1]);
       if(line.size() == 3)
@@ -686,6 +767,19 @@ void ConfigSetup::Init(const char *fileName)
                out.state.settings.frequency);
       } else
         printf("%-40s %-s \n", "Info: Printing coordinate", "Inactive");
+    } else if(CheckString(line[0], "BinaryCoordinatesFreq")) {
+      out.binaryCoord.enable = checkBool(line[1]);
+      if(line.size() == 3)
+        out.binaryCoord.frequency = stringtoi(line[2]);
+
+      if(out.binaryCoord.enable && (line.size() == 2))
+        out.binaryCoord.frequency = (ulong)sys.step.total / 10;
+
+      if(out.binaryCoord.enable) {
+        printf("%-40s %-lu \n", "Info: Binary coordinate frequency",
+               out.binaryCoord.frequency);
+      } else
+        printf("%-40s %-s \n", "Info: Printing binary coordinate", "Inactive");
     } else if(CheckString(line[0], "RestartFreq")) {
       out.restart.settings.enable = checkBool(line[1]);
       if(line.size() == 3)
@@ -899,6 +993,11 @@ void ConfigSetup::fillDefaults(void)
     printf("%-40s %-4.4f \n", "Default: Short Range Cutoff", sys.ff.cutoffLow);
   }
 
+  if(sys.ff.pairTable && sys.ff.tablePoints == 0) {
+    std::cout << "Error: Pair table points per A^2 must be positive!\n";
+    exit(EXIT_FAILURE);
+  }
+
   if(out.statistics.settings.block.enable && in.restart.recalcTrajectory) {
     out.statistics.settings.block.enable = false;
     printf("%-40s \n", "Warning: Average output is activated but it will be ignored.");
@@ -909,11 +1008,21 @@ void ConfigSetup::fillDefaults(void)
     printf("%-40s \n", "Warning: Printing restart coordinate is activated but it will be ignored.");
   }
 
+  if(in.restart.frameIndexFile && !in.restart.recalcTrajectory) {
+    in.restart.frameIndexFile = false;
+    printf("%-40s \n", "Warning: Trajectory frame index file is activated but it will be ignored.");
+  }
+
   if(out.state.settings.enable && in.restart.recalcTrajectory) {
     out.state.settings.enable = false;
     printf("%-40s \n", "Warning: Printing coordinate is activated but it will be ignored.");
   }
 
+  if(out.binaryCoord.enable && in.restart.recalcTrajectory) {
+    out.binaryCoord.enable = false;
+    printf("%-40s \n", "Warning: Printing binary coordinate is activated but it will be ignored.");
+  }
+
   out.state.files.psf.name = out.statistics.settings.uniqueStr.val +
                              "_merged.psf";
   for(int i = 0; i < BOX_TOTAL; i++) {
@@ -923,6 +1032,8 @@ void ConfigSetup::fillDefaults(void)
     toStr >> numStr;
     out.state.files.pdb.name[i] = out.statistics.settings.uniqueStr.val +
                                   "_BOX_" + numStr + ".pdb";
+    out.state.files.binaryCoord.name[i] =
+      out.statistics.settings.uniqueStr.val + "_BOX_" + numStr + ".bcrd";
   }
   out.state.files.seed.name = out.statistics.settings.uniqueStr.val + ".dat";
 }
@@ -1035,6 +1146,14 @@ void ConfigSetup::verifyInputs(void)
     std::cout << "Error: Tolerance is not specified!" << std::endl;
     exit(EXIT_FAILURE);
   }
+  if(sys.elect.pme && !sys.elect.ewald) {
+    std::cout << "Error: PME requires Ewald to be active!" << std::endl;
+    exit(EXIT_FAILURE);
+  }
+  if(sys.elect.pme && sys.elect.pmeSpacing <= 0.0) {
+    std::cout << "Error: PME mesh spacing must be positive!" << std::endl;
+    exit(EXIT_FAILURE);
+  }
   if(sys.step.adjustment == ULONG_MAX) {
     std::cout << "Error: Move adjustment frequency is not specified!\n";
     exit(EXIT_FAILURE);
@@ -1164,6 +1283,20 @@ void ConfigSetup::verifyInputs(void)
     std::cout << "Error: Switch distance should be less than Cutoff!\n";
     exit(EXIT_FAILURE);
   }
+  if(sys.ff.verletSkin < 0.0) {
+    std::cout << "Error: Verlet list skin cannot be negative!\n";
+    exit(EXIT_FAILURE);
+  }
+  if(sys.ff.frameworkGrid && sys.ff.gridSpacing <= 0.0) {
+    std::cout << "Error: Framework grid spacing must be positive!\n";
+    exit(EXIT_FAILURE);
+  }
+#if ENSEMBLE == GEMC || ENSEMBLE == NPT
+  if(sys.ff.frameworkGrid && sys.moves.volume > 0.0) {
+    std::cout << "Error: Framework grid cannot be used with volume moves!\n";
+    exit(EXIT_FAILURE);
+  }
+#endif
 #ifdef VARIABLE_PARTICLE_NUMBER
   if(sys.cbmcTrials.bonded.ang == UINT_MAX) {
     std::cout << "Error: CBMC number of angle trials is not specified!\n";
@@ -1280,6 +1413,10 @@ void ConfigSetup::verifyInputs(void)
     std::cout << "Error: Coordinate frequency is not specified!\n";
     exit(EXIT_FAILURE);
   }
+  if(out.binaryCoord.enable && out.binaryCoord.frequency == ULONG_MAX) {
+    std::cout << "Error: Binary coordinate frequency is not specified!\n";
+    exit(EXIT_FAILURE);
+  }
   if(out.statistics.settings.block.enable &&
       out.statistics.settings.block.frequency == ULONG_MAX) {
     std::cout << "Error: Average output frequency is not specified!\n";
@@ -1321,6 +1458,26 @@ void ConfigSetup::verifyInputs(void)
     printf("Note: Average output Inactived. Pressure average output will be ignored.\n");
     out.statistics.vars.pressure.block = false;
   }
+  if(!sys.step.pressureCalc && sys.step.virialTracking) {
+    printf("Note: Pressure Calculation Inactived. Virial tracking will be ignored.\n");
+    sys.step.virialTracking = false;
+  }
+  if(sys.step.virialTracking) {
+    //full recalculation every 100 pressure calculations by default
+    if(sys.step.virialFullFreq == 0) {
+      if(sys.step.pressureCalcFreq < ULONG_MAX / 100)
+        sys.step.virialFullFreq = 100 * sys.step.pressureCalcFreq;
+      else
+        sys.step.virialFullFreq = ULONG_MAX;
+    }
+    if(sys.step.virialFullFreq % sys.step.pressureCalcFreq != 0) {
+      std::cout << "Error: Virial full calculation frequency must be a "
+                << "multiple of the pressure calculation frequency!\n";
+      exit(EXIT_FAILURE);
+    }
+    printf("%-40s %-lu \n", "Info: Virial full calculation frequency",
+           sys.step.virialFullFreq);
+  }
   if(!sys.step.pressureCalc && out.statistics.vars.pressure.block) {
     printf("Note: Pressure Calculation Inactived. Pressure average output will be ignored.\n");
     out.statistics.vars.pressure.block = false;
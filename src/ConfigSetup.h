@@ -52,6 +52,7 @@ struct RestartSettings {
   ulong step;
   bool recalcTrajectory;
   bool restartFromCheckpoint;
+  bool frameIndexFile;
   bool operator()(void)
   {
     return enable;
@@ -130,8 +131,12 @@ struct VDWSwitch : public PotentialConfig {
 //Items that effect the system interactions and/or identity, e.g. Temp.
 struct FFValues {
   uint VDW_KIND;
-  double cutoff, cutoffLow, rswitch;
-  bool doTailCorr, vdwGeometricSigma;
+  double cutoff, cutoffLow, rswitch, verletSkin;
+  bool doTailCorr, vdwGeometricSigma, pairTable;
+  uint tablePoints;
+  bool frameworkGrid, gridInterp;
+  double gridSpacing;
+  std::string gridFile;
   std::string kind;
 
   static const std::string VDW, VDW_SHIFT, VDW_SWITCH;
@@ -150,8 +155,8 @@ struct GEMCKind {
 
 
 struct Step {
-  ulong total, equil, adjustment, pressureCalcFreq;
-  bool pressureCalc;
+  ulong total, equil, adjustment, pressureCalcFreq, virialFullFreq;
+  bool pressureCalc, virialTracking;
 };
 
 //Holds the percentage of each kind of move for this ensemble.
@@ -172,8 +177,11 @@ struct ElectroStatic {
   bool enable;
   bool ewald;
   bool cache;
+  bool cacheFloat;  //store the Fourier cache in single precision
+  bool pme;
   bool cutoffCoulombRead[BOX_TOTAL];
   double tolerance;
+  double pmeSpacing;  //largest PME mesh spacing
   double oneFourScale;
   double dielectric;
   double cutoffCoulomb[BOX_TOTAL];
@@ -288,7 +296,7 @@ struct HistFiles { /* : ReadableBase*/
 
 //Files for output.
 struct OutFiles {
-  FileNames<BOX_TOTAL> pdb;
+  FileNames<BOX_TOTAL> pdb, binaryCoord;
   FileName psf, seed;
   HistFiles hist;
 };
@@ -325,7 +333,8 @@ struct Statistics {
 struct Output {
   SysState state, restart;
   Statistics statistics;
-  EventSettings console, checkpoint;
+  EventSettings console, checkpoint, binaryCoord;
+  bool checkpointState;
 };
 
 }
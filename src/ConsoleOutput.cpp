@@ -13,6 +13,7 @@ along with this program, also can be found at <http://www.gnu.org/licenses/>.
 #include "MoleculeKind.h"           //For kind names
 #include "PDBConst.h"               //For resname len.
 #include "OutputVars.h"
+#include "Profiler.h"
 
 #include <iostream>                 // std::cout, std::fixed
 #include <iomanip>                  // std::setprecision
@@ -82,7 +83,7 @@ void ConsoleOutput::DoOutput(const ulong step)
       }
 
     }
-
+    PROFILE_REPORT(step);
   }
 }
 
@@ -18,6 +18,8 @@ along with this program, also can be found at <http://www.gnu.org/licenses/>.
 #include "TrialMol.h"
 #include "GeomLib.h"
 #include "NumLib.h"
+#include "Profiler.h"
+#include "Parallel.h"
 #include <cassert>
 #ifdef GOMC_CUDA
 #include "CalculateEwaldCUDAKernel.cuh"
@@ -114,6 +116,53 @@ void Ewald::Init()
   UpdateVectorsAndRecipTerms();
 }
 
+bool Ewald::InitFromSums(std::vector<std::vector<double> > const& sumR,
+                         std::vector<std::vector<double> > const& sumI)
+{
+#ifdef GOMC_CUDA
+  //the sums live on the device
+  return false;
+#else
+  for(uint m = 0; m < mols.count; ++m) {
+    const MoleculeKind& molKind = mols.GetKind(m);
+    for(uint a = 0; a < molKind.NumAtoms(); ++a) {
+      particleKind.push_back(molKind.AtomKind(a));
+      particleMol.push_back(m);
+      particleCharge.push_back(molKind.AtomCharge(a));
+    }
+  }
+
+  AllocMem();
+  for (uint b = 0; b < BOXES_WITH_U_NB; ++b) {
+    RecipInit(b, currentAxes);
+    //sum again if the wave vectors changed since the checkpoint
+    if (b < sumR.size() && sumR[b].size() == imageSize[b] &&
+        sumI[b].size() == imageSize[b]) {
+      std::copy(sumR[b].begin(), sumR[b].end(), sumRnew[b]);
+      std::copy(sumI[b].begin(), sumI[b].end(), sumInew[b]);
+    } else {
+      BoxReciprocalSetup(b, currentCoords);
+    }
+    SetRecipRef(b);
+    printf("Box: %d, RecipVectors: %6d, kmax: %d\n",
+           b, imageSize[b], kmax[b]);
+  }
+  return true;
+#endif
+}
+
+bool Ewald::GetRecipSums(std::vector<double>& sumR, std::vector<double>& sumI,
+                         uint box) const
+{
+#ifdef GOMC_CUDA
+  return false;
+#else
+  sumR.assign(sumRref[box], sumRref[box] + imageSizeRef[box]);
+  sumI.assign(sumIref[box], sumIref[box] + imageSizeRef[box]);
+  return true;
+#endif
+}
+
 void Ewald::UpdateVectorsAndRecipTerms()
 {
   for (uint b = 0; b < BOXES_WITH_U_NB; ++b) {
@@ -176,22 +225,146 @@ void Ewald::AllocMem()
 #endif
 }
 
+void Ewald::LatticeTables(RecipLattice const& lat, XYZArray const& coords,
+                          const uint start, const uint length,
+                          const uint first, const uint box)
+{
+  uint stride = 2 * lat.nMax + 1;
+  uint size = (first + length) * 3 * stride;
+  if (trigR[box].size() < size) {
+    trigR[box].resize(size);
+    trigI[box].resize(size);
+  }
+
+  for (uint p = 0; p < length; p++) {
+    double arg[3];
+    arg[0] = coords.x[start + p] * lat.unit.x;
+    arg[1] = coords.y[start + p] * lat.unit.y;
+    arg[2] = coords.z[start + p] * lat.unit.z;
+
+    for (uint a = 0; a < 3; a++) {
+      //index 0 of tR/tI is n = 0
+      double *tR = &trigR[box][((first + p) * 3 + a) * stride + lat.nMax];
+      double *tI = &trigI[box][((first + p) * 3 + a) * stride + lat.nMax];
+      double c = cos(arg[a]);
+      double s = sin(arg[a]);
+      tR[0] = 1.0;
+      tI[0] = 0.0;
+      for (int n = 1; n <= lat.nMax; n++) {
+        tR[n] = tR[n - 1] * c - tI[n - 1] * s;
+        tI[n] = tR[n - 1] * s + tI[n - 1] * c;
+        tR[-n] = tR[n];
+        tI[-n] = -tI[n];
+      }
+    }
+  }
+}
+
+void Ewald::LatticeSum(double& sumReal, double& sumImaginary,
+                       RecipLattice const& lat, const uint i,
+                       MoleculeKind const& kind, const uint length,
+                       const uint first, const uint box) const
+{
+  uint stride = 2 * lat.nMax + 1;
+  int offX = lat.nMax + lat.nx[i];
+  int offY = stride + lat.nMax + lat.ny[i];
+  int offZ = 2 * stride + lat.nMax + lat.nz[i];
+  double xyR, xyI;
+
+  sumReal = 0.0;
+  sumImaginary = 0.0;
+  for (uint p = 0; p < length; p++) {
+    const double *tR = &trigR[box][(first + p) * 3 * stride];
+    const double *tI = &trigI[box][(first + p) * 3 * stride];
+    //e^(i k.r) = e^(i kx x) * e^(i ky y) * e^(i kz z)
+    xyR = tR[offX] * tR[offY] - tI[offX] * tI[offY];
+    xyI = tR[offX] * tI[offY] + tI[offX] * tR[offY];
+    sumReal += kind.AtomCharge(p) * (xyR * tR[offZ] - xyI * tI[offZ]);
+    sumImaginary += kind.AtomCharge(p) * (xyR * tI[offZ] + xyI * tR[offZ]);
+  }
+}
+
+void Ewald::LatticeSum(double& sumReal, double& sumImaginary,
+                       RecipLattice const& lat, const uint i,
+                       const double *charge, const uint length,
+                       const uint first, const uint box) const
+{
+  uint stride = 2 * lat.nMax + 1;
+  int offX = lat.nMax + lat.nx[i];
+  int offY = stride + lat.nMax + lat.ny[i];
+  int offZ = 2 * stride + lat.nMax + lat.nz[i];
+  double xyR, xyI;
+
+  sumReal = 0.0;
+  sumImaginary = 0.0;
+  for (uint p = 0; p < length; p++) {
+    const double *tR = &trigR[box][(first + p) * 3 * stride];
+    const double *tI = &trigI[box][(first + p) * 3 * stride];
+    xyR = tR[offX] * tR[offY] - tI[offX] * tI[offY];
+    xyI = tR[offX] * tI[offY] + tI[offX] * tR[offY];
+    sumReal += charge[p] * (xyR * tR[offZ] - xyI * tI[offZ]);
+    sumImaginary += charge[p] * (xyR * tI[offZ] + xyI * tR[offZ]);
+  }
+}
+
+void Ewald::BoxTiles(RecipTiles& tiles, const uint box) const
+{
+  MoleculeLookup::box_iterator thisMol = molLookup.BoxBegin(box);
+  MoleculeLookup::box_iterator end = molLookup.BoxEnd(box);
+  uint tileAtoms = 0;
+
+  tiles.mol.clear();
+  tiles.molFirst.clear();
+  tiles.atom.clear();
+  tiles.charge.clear();
+  tiles.tileFirst.clear();
+  tiles.maxTile = 0;
+  while (thisMol != end) {
+    if (tiles.tileFirst.empty() || tileAtoms >= RECIP_TILE_ATOMS) {
+      tiles.maxTile = std::max(tiles.maxTile, tileAtoms);
+      tiles.tileFirst.push_back(tiles.mol.size());
+      tileAtoms = 0;
+    }
+    MoleculeKind const& thisKind = mols.GetKind(*thisMol);
+    uint start = mols.MolStart(*thisMol);
+    tiles.mol.push_back(*thisMol);
+    tiles.molFirst.push_back(tiles.atom.size());
+    //uncharged atoms add nothing to the structure factors
+    for (uint j = 0; j < thisKind.NumAtoms(); j++) {
+      if (thisKind.AtomCharge(j) != 0.0) {
+        tiles.atom.push_back(start + j);
+        tiles.charge.push_back(thisKind.AtomCharge(j));
+        tileAtoms++;
+      }
+    }
+    thisMol++;
+  }
+  tiles.maxTile = std::max(tiles.maxTile, tileAtoms);
+  tiles.tileFirst.push_back(tiles.mol.size());
+  tiles.molFirst.push_back(tiles.atom.size());
+}
+
+void Ewald::ReserveTables(RecipLattice const& lat, const uint rows,
+                          const uint box)
+{
+  uint size = rows * 3 * (2 * lat.nMax + 1);
+  if (trigR[box].size() < size) {
+    trigR[box].resize(size);
+    trigI[box].resize(size);
+  }
+}
 
 //calculate reciprocate term for a box
 void Ewald::BoxReciprocalSetup(uint box, XYZArray const& molCoords)
 {
-  uint j, m;
-  int i;
-  double dotProduct = 0.0;
-  double sumReal = 0.0;
-  double sumImaginary = 0.0;
+  PROFILE_SCOPE(prof::BOX_RECIP_SETUP);
 
   if (box < BOXES_WITH_U_NB) {
+#ifdef GOMC_CUDA
     MoleculeLookup::box_iterator end = molLookup.BoxEnd(box);
     MoleculeLookup::box_iterator thisMol = molLookup.BoxBegin(box);
-
-#ifdef GOMC_CUDA
     int numberOfAtoms = 0, i = 0;
+    uint j;
 
     for(int k = 0; k < mols.GetKindsCount(); k++) {
       MoleculeKind const& thisKind = mols.kinds[k];
@@ -216,36 +389,72 @@ void Ewald::BoxReciprocalSetup(uint box, XYZArray const& molCoords)
                               sumInew[box], prefact[box], hsqr[box],
                               currentEnergyRecip[box], box);
 #else
+    RecipLattice const& lat = lattice[box];
+    RecipTiles& tiles = boxTiles[box];
+    int kTiles = (imageSize[box] + RECIP_TILE_K - 1) / RECIP_TILE_K;
+    int tileCount;
+
+    std::memset(sumRnew[box], 0.0, sizeof(double) * imageSize[box]);
+    std::memset(sumInew[box], 0.0, sizeof(double) * imageSize[box]);
+    BoxTiles(tiles, box);
+    tileCount = tiles.tileFirst.size() - 1;
+    PROFILE_COUNT(prof::KVECTORS, imageSize[box] * tiles.mol.size());
+
+    //one parallel region over tiles of wave vectors for the whole box, each
+    //wave vector is summed by one thread in atom order
+    if (lat.use) {
+      ReserveTables(lat, tiles.maxTile, box);
 #ifdef _OPENMP
-    #pragma omp parallel default(shared)
+      #pragma omp parallel default(shared) if(par::Worth(imageSize[box] * tiles.atom.size()))
 #endif
-    {
-      std::memset(sumRnew[box], 0.0, sizeof(double) * imageSize[box]);
-      std::memset(sumInew[box], 0.0, sizeof(double) * imageSize[box]);
-    }
-
-    while (thisMol != end) {
-      MoleculeKind const& thisKind = mols.GetKind(*thisMol);
-
+      for (int t = 0; t < tileCount; t++) {
+        uint first = tiles.molFirst[tiles.tileFirst[t]];
+        int count = tiles.molFirst[tiles.tileFirst[t + 1]] - first;
+        if (count == 0)
+          continue;
 #ifdef _OPENMP
-      #pragma omp parallel for default(shared) private(i, j, dotProduct, sumReal, sumImaginary)
+        #pragma omp for
 #endif
-      for (i = 0; i < imageSize[box]; i++) {
-        sumReal = 0.0;
-        sumImaginary = 0.0;
-
-        for (j = 0; j < thisKind.NumAtoms(); j++) {
-          dotProduct = Dot(mols.MolStart(*thisMol) + j,
-                           kx[box][i], ky[box][i],
-                           kz[box][i], molCoords);
+        for (int p = 0; p < count; p++) {
+          LatticeTables(lat, molCoords, tiles.atom[first + p], 1, p, box);
+        }
 
-          sumReal += (thisKind.AtomCharge(j) * cos(dotProduct));
-          sumImaginary += (thisKind.AtomCharge(j) * sin(dotProduct));
+#ifdef _OPENMP
+        #pragma omp for
+#endif
+        for (int kt = 0; kt < kTiles; kt++) {
+          uint kEnd = std::min((kt + 1) * RECIP_TILE_K, imageSize[box]);
+          for (uint k = kt * RECIP_TILE_K; k < kEnd; k++) {
+            double sumReal, sumImaginary;
+            LatticeSum(sumReal, sumImaginary, lat, k, &tiles.charge[first],
+                       count, 0, box);
+            sumRnew[box][k] += sumReal;
+            sumInew[box][k] += sumImaginary;
+          }
+        }
+      }
+    } else {
+#ifdef _OPENMP
+      #pragma omp parallel for default(shared) if(par::Worth(imageSize[box] * tiles.atom.size()))
+#endif
+      for (int kt = 0; kt < kTiles; kt++) {
+        uint kEnd = std::min((kt + 1) * RECIP_TILE_K, imageSize[box]);
+        for (int t = 0; t < tileCount; t++) {
+          uint first = tiles.molFirst[tiles.tileFirst[t]];
+          uint last = tiles.molFirst[tiles.tileFirst[t + 1]];
+          for (uint k = kt * RECIP_TILE_K; k < kEnd; k++) {
+            double sumReal = 0.0, sumImaginary = 0.0;
+            for (uint p = first; p < last; p++) {
+              double dotProduct = Dot(tiles.atom[p], kx[box][k], ky[box][k],
+                                      kz[box][k], molCoords);
+              sumReal += tiles.charge[p] * cos(dotProduct);
+              sumImaginary += tiles.charge[p] * sin(dotProduct);
+            }
+            sumRnew[box][k] += sumReal;
+            sumInew[box][k] += sumImaginary;
+          }
         }
-        sumRnew[box][i] += sumReal;
-        sumInew[box][i] += sumImaginary;
       }
-      thisMol++;
     }
 #endif
   }
@@ -255,6 +464,7 @@ void Ewald::BoxReciprocalSetup(uint box, XYZArray const& molCoords)
 //calculate reciprocate term for a box
 double Ewald::BoxReciprocal(uint box) const
 {
+  PROFILE_SCOPE(prof::BOX_RECIP);
   int i;
   double energyRecip = 0.0;
 
@@ -262,8 +472,9 @@ double Ewald::BoxReciprocal(uint box) const
 #ifdef GOMC_CUDA
     return currentEnergyRecip[box];
 #else
+    PROFILE_COUNT(prof::KVECTORS, imageSize[box]);
 #ifdef _OPENMP
-    #pragma omp parallel for default(shared) private(i) reduction(+:energyRecip)
+    #pragma omp parallel for default(shared) private(i) reduction(+:energyRecip) if(par::Worth(imageSize[box]))
 #endif
     for (i = 0; i < imageSize[box]; i++) {
       energyRecip += (( sumRnew[box][i] * sumRnew[box][i] +
@@ -281,6 +492,7 @@ double Ewald::BoxReciprocal(uint box) const
 double Ewald::MolReciprocal(XYZArray const& molCoords,
                             const uint molIndex, const uint box)
 {
+  PROFILE_SCOPE(prof::MOL_RECIP);
   double energyRecipNew = 0.0;
   double energyRecipOld = 0.0;
 
@@ -303,8 +515,14 @@ double Ewald::MolReciprocal(XYZArray const& molCoords,
                          cCoords, molCoords, MolCharge, imageSizeRef[box],
                          sumRnew[box], sumInew[box], energyRecipNew, box);
 #else
+    PROFILE_COUNT(prof::KVECTORS, imageSizeRef[box]);
+    if (latticeRef[box].use) {
+      LatticeTables(latticeRef[box], molCoords, 0, length, 0, box);
+      LatticeTables(latticeRef[box], currentCoords, startAtom, length, length, box);
+    }
+
 #ifdef _OPENMP
-    #pragma omp parallel for default(shared) private(i, p, atom, sumRealNew, sumImaginaryNew, sumRealOld, sumImaginaryOld, dotProductNew, dotProductOld) reduction(+:energyRecipNew, energyRecipOld)
+    #pragma omp parallel for default(shared) private(i, p, atom, sumRealNew, sumImaginaryNew, sumRealOld, sumImaginaryOld, dotProductNew, dotProductOld) reduction(+:energyRecipNew, energyRecipOld) if(par::Worth(imageSizeRef[box] * length))
 #endif
     for (i = 0; i < imageSizeRef[box]; i++) {
       sumRealNew = 0.0;
@@ -314,21 +532,28 @@ double Ewald::MolReciprocal(XYZArray const& molCoords,
       sumRealOld = 0.0;
       sumImaginaryOld = 0.0;
 
-      for (p = 0; p < length; ++p) {
-        atom = startAtom + p;
-        dotProductNew = Dot(p, kxRef[box][i],
-                            kyRef[box][i], kzRef[box][i],
-                            molCoords);
-
-        dotProductOld = Dot(atom, kxRef[box][i],
-                            kyRef[box][i], kzRef[box][i],
-                            currentCoords);
-
-        sumRealNew += (thisKind.AtomCharge(p) * cos(dotProductNew));
-        sumImaginaryNew += (thisKind.AtomCharge(p) * sin(dotProductNew));
-
-        sumRealOld += (thisKind.AtomCharge(p) * cos(dotProductOld));
-        sumImaginaryOld += (thisKind.AtomCharge(p) * sin(dotProductOld));
+      if (latticeRef[box].use) {
+        LatticeSum(sumRealNew, sumImaginaryNew, latticeRef[box], i, thisKind,
+                   length, 0, box);
+        LatticeSum(sumRealOld, sumImaginaryOld, latticeRef[box], i, thisKind,
+                   length, length, box);
+      } else {
+        for (p = 0; p < length; ++p) {
+          atom = startAtom + p;
+          dotProductNew = Dot(p, kxRef[box][i],
+                              kyRef[box][i], kzRef[box][i],
+                              molCoords);
+
+          dotProductOld = Dot(atom, kxRef[box][i],
+                              kyRef[box][i], kzRef[box][i],
+                              currentCoords);
+
+          sumRealNew += (thisKind.AtomCharge(p) * cos(dotProductNew));
+          sumImaginaryNew += (thisKind.AtomCharge(p) * sin(dotProductNew));
+
+          sumRealOld += (thisKind.AtomCharge(p) * cos(dotProductOld));
+          sumImaginaryOld += (thisKind.AtomCharge(p) * sin(dotProductOld));
+        }
       }
 
       sumRnew[box][i] = sumRref[box][i] - sumRealOld + sumRealNew;
@@ -349,6 +574,7 @@ double Ewald::SwapDestRecip(const cbmc::TrialMol &newMol,
                             const uint box,
                             const int molIndex)
 {
+  PROFILE_SCOPE(prof::SWAP_DEST_RECIP);
   double energyRecipNew = 0.0;
   double energyRecipOld = 0.0;
 
@@ -371,21 +597,30 @@ double Ewald::SwapDestRecip(const cbmc::TrialMol &newMol,
                           sumRnew[box], sumInew[box],
                           insert, energyRecipNew, box);
 #else
+    PROFILE_COUNT(prof::KVECTORS, imageSizeRef[box]);
+    if (latticeRef[box].use)
+      LatticeTables(latticeRef[box], molCoords, 0, length, 0, box);
+
 #ifdef _OPENMP
-    #pragma omp parallel for default(shared) private(i, p, dotProductNew, sumRealNew, sumImaginaryNew) reduction(+:energyRecipNew)
+    #pragma omp parallel for default(shared) private(i, p, dotProductNew, sumRealNew, sumImaginaryNew) reduction(+:energyRecipNew) if(par::Worth(imageSizeRef[box] * length))
 #endif
     for (i = 0; i < imageSizeRef[box]; i++) {
       sumRealNew = 0.0;
       sumImaginaryNew = 0.0;
       dotProductNew = 0.0;
 
-      for (p = 0; p < length; ++p) {
-        dotProductNew = Dot(p, kxRef[box][i],
-                            kyRef[box][i], kzRef[box][i],
-                            molCoords);
-
-        sumRealNew += (thisKind.AtomCharge(p) * cos(dotProductNew));
-        sumImaginaryNew += (thisKind.AtomCharge(p) * sin(dotProductNew));
+      if (latticeRef[box].use) {
+        LatticeSum(sumRealNew, sumImaginaryNew, latticeRef[box], i, thisKind,
+                   length, 0, box);
+      } else {
+        for (p = 0; p < length; ++p) {
+          dotProductNew = Dot(p, kxRef[box][i],
+                              kyRef[box][i], kzRef[box][i],
+                              molCoords);
+
+          sumRealNew += (thisKind.AtomCharge(p) * cos(dotProductNew));
+          sumImaginaryNew += (thisKind.AtomCharge(p) * sin(dotProductNew));
+        }
       }
 
       //sumRealNew;
@@ -405,6 +640,7 @@ double Ewald::SwapDestRecip(const cbmc::TrialMol &newMol,
 
 void Ewald::RecipInit(uint box, BoxDimensions const& boxAxes)
 {
+  PROFILE_SCOPE(prof::RECIP_INIT);
   if(boxAxes.orthogonal[box])
     RecipInitOrth(box, boxAxes);
   else
@@ -416,6 +652,7 @@ void Ewald::RecipInit(uint box, BoxDimensions const& boxAxes)
 double Ewald::SwapSourceRecip(const cbmc::TrialMol &oldMol,
                               const uint box, const int molIndex)
 {
+  PROFILE_SCOPE(prof::SWAP_SOURCE_RECIP);
   double energyRecipNew = 0.0;
   double energyRecipOld = 0.0;
 
@@ -438,22 +675,30 @@ double Ewald::SwapSourceRecip(const cbmc::TrialMol &oldMol,
                           insert, energyRecipNew, box);
 
 #else
+    PROFILE_COUNT(prof::KVECTORS, imageSizeRef[box]);
+    if (latticeRef[box].use)
+      LatticeTables(latticeRef[box], molCoords, 0, length, 0, box);
+
 #ifdef _OPENMP
-    #pragma omp parallel for default(shared) private(i, p, dotProductNew, sumRealNew, sumImaginaryNew) reduction(+:energyRecipNew)
+    #pragma omp parallel for default(shared) private(i, p, dotProductNew, sumRealNew, sumImaginaryNew) reduction(+:energyRecipNew) if(par::Worth(imageSizeRef[box] * length))
 #endif
     for (i = 0; i < imageSizeRef[box]; i++) {
       sumRealNew = 0.0;
       sumImaginaryNew = 0.0;
       dotProductNew = 0.0;
 
-      for (p = 0; p < length; ++p) {
-        dotProductNew = Dot(p, kxRef[box][i],
-                            kyRef[box][i], kzRef[box][i],
-                            molCoords);
-
-        sumRealNew += (thisKind.AtomCharge(p) * cos(dotProductNew));
-        sumImaginaryNew += (thisKind.AtomCharge(p) * sin(dotProductNew));
-
+      if (latticeRef[box].use) {
+        LatticeSum(sumRealNew, sumImaginaryNew, latticeRef[box], i, thisKind,
+                   length, 0, box);
+      } else {
+        for (p = 0; p < length; ++p) {
+          dotProductNew = Dot(p, kxRef[box][i],
+                              kyRef[box][i], kzRef[box][i],
+                              molCoords);
+
+          sumRealNew += (thisKind.AtomCharge(p) * cos(dotProductNew));
+          sumImaginaryNew += (thisKind.AtomCharge(p) * sin(dotProductNew));
+        }
       }
       sumRnew[box][i] = sumRref[box][i] - sumRealNew;
       sumInew[box][i] = sumIref[box][i] - sumImaginaryNew;
@@ -473,6 +718,7 @@ double Ewald::SwapSourceRecip(const cbmc::TrialMol &oldMol,
 double Ewald::SwapRecip(const std::vector<cbmc::TrialMol> &newMol,
                         const std::vector<cbmc::TrialMol> &oldMol)
 {
+  PROFILE_SCOPE(prof::SWAP_RECIP);
   double energyRecipNew = 0.0;
   double energyRecipOld = 0.0;
   uint box = newMol[0].GetBox();
@@ -484,9 +730,10 @@ double Ewald::SwapRecip(const std::vector<cbmc::TrialMol> &newMol,
     double dotProductNew, sumRealNew, sumImaginaryNew;
     lengthNew = thisKindNew.NumAtoms();
     lengthOld = thisKindOld.NumAtoms();
+    PROFILE_COUNT(prof::KVECTORS, imageSizeRef[box]);
 
 #ifdef _OPENMP
-    #pragma omp parallel for default(shared) private(i, p, dotProductNew, sumRealNew, sumImaginaryNew) reduction(+:energyRecipNew)
+    #pragma omp parallel for default(shared) private(i, p, dotProductNew, sumRealNew, sumImaginaryNew) reduction(+:energyRecipNew) if(par::Worth(imageSizeRef[box] * (lengthNew + lengthOld)))
 #endif
     for (i = 0; i < imageSizeRef[box]; i++) {
       sumRealNew = 0.0;
@@ -573,6 +820,14 @@ void Ewald::RecipInitOrth(uint box, BoxDimensions const& boxAxes)
   nkz_max = int(ff.recip_rcut[box] * boxAxes.axis.Get(box).z / (2 * M_PI)) + 1;
   kmax[box] = std::max(std::max(nkx_max, nky_max), std::max(nky_max, nkz_max));
 
+  RecipLattice& lat = lattice[box];
+  lat.use = true;
+  lat.unit = constValue;
+  lat.nMax = kmax[box];
+  lat.nx.resize(imageTotal);
+  lat.ny.resize(imageTotal);
+  lat.nz.resize(imageTotal);
+
   for(x = 0; x <= nkx_max; x++) {
     if(x == 0.0)
       nky_min = 0;
@@ -592,6 +847,9 @@ void Ewald::RecipInitOrth(uint box, BoxDimensions const& boxAxes)
         ksqr = kX * kX + kY * kY + kZ * kZ;
 
         if(ksqr < ff.recip_rcut_Sq[box]) {
+          lat.nx[counter] = x;
+          lat.ny[counter] = y;
+          lat.nz[counter] = z;
           kx[box][counter] = kX;
           ky[box][counter] = kY;
           kz[box][counter] = kZ;
@@ -626,6 +884,7 @@ void Ewald::RecipInitNonOrth(uint box, BoxDimensions const& boxAxes)
   XYZArray cellB_Inv(3);
   double det = cellB.AdjointMatrix(cellB_Inv);
   cellB_Inv.ScaleRange(0, 3, (2 * M_PI) / det);
+  lattice[box].use = false;
 
   double vol = boxAxes.volume[box] / (4 * M_PI);
   nkx_max = int(ff.recip_rcut[box] * boxAxes.axis.Get(box).x / (2 * M_PI)) + 1;
@@ -730,18 +989,14 @@ void Ewald::RecipCountInit(uint box, BoxDimensions const& boxAxes)
 //back up reciptocate value to Ref (will be called during initialization)
 void Ewald::SetRecipRef(uint box)
 {
-#ifdef _OPENMP
-  #pragma omp parallel default(shared)
-#endif
-  {
-    std::memcpy(sumRref[box], sumRnew[box], sizeof(double) * imageSize[box]);
-    std::memcpy(sumIref[box], sumInew[box], sizeof(double) * imageSize[box]);
-    std::memcpy(kxRef[box], kx[box], sizeof(double) * imageSize[box]);
-    std::memcpy(kyRef[box], ky[box], sizeof(double) * imageSize[box]);
-    std::memcpy(kzRef[box], kz[box], sizeof(double) * imageSize[box]);
-    std::memcpy(hsqrRef[box], hsqr[box], sizeof(double) * imageSize[box]);
-    std::memcpy(prefactRef[box], prefact[box], sizeof(double) *imageSize[box]);
-  }
+  std::memcpy(sumRref[box], sumRnew[box], sizeof(double) * imageSize[box]);
+  std::memcpy(sumIref[box], sumInew[box], sizeof(double) * imageSize[box]);
+  std::memcpy(kxRef[box], kx[box], sizeof(double) * imageSize[box]);
+  std::memcpy(kyRef[box], ky[box], sizeof(double) * imageSize[box]);
+  std::memcpy(kzRef[box], kz[box], sizeof(double) * imageSize[box]);
+  std::memcpy(hsqrRef[box], hsqr[box], sizeof(double) * imageSize[box]);
+  std::memcpy(prefactRef[box], prefact[box], sizeof(double) *imageSize[box]);
+  latticeRef[box] = lattice[box];
 #ifdef GOMC_CUDA
   CopyCurrentToRefCUDA(ff.particles->getCUDAVars(),
                        box, imageSize[box]);
@@ -808,6 +1063,7 @@ double Ewald::BoxSelf(BoxDimensions const& boxAxes, uint box) const
 // commented out. In case you need to calculate them, uncomment them.
 Virial Ewald::ForceReciprocal(Virial& virial, uint box) const
 {
+  PROFILE_SCOPE(prof::FORCE_RECIP);
   Virial tempVir = virial;
   if (box >= BOXES_WITH_U_NB)
     return tempVir;
@@ -865,8 +1121,9 @@ Virial Ewald::ForceReciprocal(Virial& virial, uint box) const
                          wT13, wT22, wT23, wT33, imageSizeRef[box], constVal,
                          box);
 #else
+  PROFILE_COUNT(prof::KVECTORS, imageSizeRef[box]);
 #ifdef _OPENMP
-  #pragma omp parallel for default(shared) private(i, factor) reduction(+:wT11, wT12, wT13, wT22, wT23, wT33)
+  #pragma omp parallel for default(shared) private(i, factor) reduction(+:wT11, wT12, wT13, wT22, wT23, wT33) if(par::Worth(imageSizeRef[box]))
 #endif
   for (i = 0; i < imageSizeRef[box]; i++) {
     factor = prefactRef[box][i] * (sumRref[box][i] * sumRref[box][i] +
@@ -908,7 +1165,7 @@ Virial Ewald::ForceReciprocal(Virial& virial, uint box) const
       charge = mols.GetKind(*thisMol).AtomCharge(p);
 
 #ifdef _OPENMP
-      #pragma omp parallel for default(shared) private(i, arg, factor) reduction(+:wT11, wT12, wT13, wT22, wT23, wT33)
+      #pragma omp parallel for default(shared) private(i, arg, factor) reduction(+:wT11, wT12, wT13, wT22, wT23, wT33) if(par::Worth(imageSizeRef[box]))
 #endif
       for (i = 0; i < imageSizeRef[box]; i++) {
         //compute the dot product of k and r
@@ -999,6 +1256,7 @@ double Ewald::SwapSelf(const cbmc::TrialMol& trialMol) const
 //update reciprocate values
 void Ewald::UpdateRecip(uint box)
 {
+  PROFILE_SCOPE(prof::UPDATE_RECIP);
   double *tempR, *tempI;
   tempR = sumRref[box];
   tempI = sumIref[box];
@@ -1031,6 +1289,7 @@ void Ewald::UpdateRecipVec(uint box)
   kz[box] = tempKz;
   hsqr[box] = tempHsqr;
   prefact[box] = tempPrefact;
+  lattice[box].swap(latticeRef[box]);
 #ifdef GOMC_CUDA
   UpdateRecipVecCUDA(ff.particles->getCUDAVars(), box);
 #endif
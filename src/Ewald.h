@@ -14,6 +14,7 @@ along with this program, also can be found at <http://www.gnu.org/licenses/>.
 #include "TrialMol.h"
 #include "MoleculeLookup.h"
 #include <vector>
+#include <algorithm>
 #include <stdio.h>
 #include <cstring>
 #include <cassert>
@@ -41,6 +42,45 @@ class XYZArray;
 class BoxDimensions;
 class CalculateEnergy;
 
+//Wave vectors of an orthogonal box lie on the lattice
+//k = (unit.x * nx, unit.y * ny, unit.z * nz) with integer nx, ny, nz
+struct RecipLattice {
+  RecipLattice() : use(false), nMax(0) {}
+
+  void swap(RecipLattice& other)
+  {
+    std::swap(use, other.use);
+    std::swap(unit, other.unit);
+    std::swap(nMax, other.nMax);
+    nx.swap(other.nx);
+    ny.swap(other.ny);
+    nz.swap(other.nz);
+  }
+
+  bool use;                     //true if set by RecipInitOrth
+  XYZ unit;                     //2 * pi / axis
+  int nMax;                     //largest |n| on any axis
+  std::vector<int> nx, ny, nz;  //lattice index of each wave vector
+};
+
+//Tiles of BoxReciprocalSetup: about RECIP_TILE_ATOMS atoms (whole molecules)
+//are summed over RECIP_TILE_K wave vectors at a time, so the coordinates or
+//lattice tables of a tile stay in cache while a thread works through them
+const uint RECIP_TILE_ATOMS = 256;
+const uint RECIP_TILE_K = 64;
+
+//Charged atoms of a box in molecule order, cut into tiles
+struct RecipTiles {
+  RecipTiles() : maxTile(0) {}
+
+  std::vector<uint> mol;        //molecules of the box
+  std::vector<uint> molFirst;   //first atom of each molecule, mols + 1
+  std::vector<uint> atom;       //index in the coordinates of each atom
+  std::vector<double> charge;   //charge of each atom
+  std::vector<uint> tileFirst;  //first molecule of each tile, tiles + 1
+  uint maxTile;                 //atoms in the largest tile
+};
+
 
 class Ewald
 {
@@ -52,6 +92,17 @@ public:
 
   virtual void Init();
 
+  //Init, with the structure factors of each box taken from sumR and sumI
+  //(saved by GetRecipSums) instead of summed over the atoms. Returns false
+  //without doing anything if the engine keeps more than those.
+  virtual bool InitFromSums(std::vector<std::vector<double> > const& sumR,
+                            std::vector<std::vector<double> > const& sumI);
+
+  //Reference structure factors of box, for the checkpoint. Returns false if
+  //the engine can not restart from them.
+  virtual bool GetRecipSums(std::vector<double>& sumR,
+                            std::vector<double>& sumI, uint box) const;
+
   virtual void AllocMem();
 
   //initiliazie term used for ewald calculation
@@ -72,6 +123,12 @@ public:
   //calculate reciprocate energy term for a box
   virtual double BoxReciprocal(uint box) const;
 
+  //number of wave vectors of a box
+  virtual uint ImageSize(uint box) const
+  {
+    return imageSize[box];
+  }
+
   //calculate self term for a box
   virtual double BoxSelf(BoxDimensions const& boxAxes, uint box) const;
 
@@ -131,6 +188,39 @@ private:
   double currentEnergyRecip[BOXES_WITH_U_NB];
 
 protected:
+  //Tabulate e^(i * n * unit * r) for n = -nMax..nMax on each axis for
+  //atoms start..start+length-1 of coords, stored from table row first on.
+  //Uses one cos/sin per atom and axis, the rest by complex multiplication.
+  //Each box has its own tables, so boxes can be set up at the same time.
+  void LatticeTables(RecipLattice const& lat, XYZArray const& coords,
+                     const uint start, const uint length, const uint first,
+                     const uint box);
+
+  //Sum of charge * e^(i k.r) of wave vector i over the tabled atoms
+  //first..first+length-1 (charges from kind)
+  void LatticeSum(double& sumReal, double& sumImaginary,
+                  RecipLattice const& lat, const uint i,
+                  MoleculeKind const& kind, const uint length,
+                  const uint first, const uint box) const;
+
+  //Same, with the charges of the tabled atoms from charge
+  void LatticeSum(double& sumReal, double& sumImaginary,
+                  RecipLattice const& lat, const uint i,
+                  const double *charge, const uint length,
+                  const uint first, const uint box) const;
+
+  //Fills tiles with the charged atoms of box, for BoxReciprocalSetup
+  void BoxTiles(RecipTiles& tiles, const uint box) const;
+
+  //Sizes the lattice tables of lat for rows atoms, so that LatticeTables
+  //can be called on separate rows from several threads
+  void ReserveTables(RecipLattice const& lat, const uint rows,
+                     const uint box);
+
+  RecipLattice lattice[BOXES_WITH_U_NB], latticeRef[BOXES_WITH_U_NB];
+  std::vector<double> trigR[BOXES_WITH_U_NB], trigI[BOXES_WITH_U_NB];
+  RecipTiles boxTiles[BOXES_WITH_U_NB];
+
   const Forcefield& ff;
   const Molecules& mols;
   const Coordinates& currentCoords;
@@ -6,6 +6,8 @@ along with this program, also can be found at <http://www.gnu.org/licenses/>.
 ********************************************************************************/
 #include "EwaldCached.h"
 #include "StaticVals.h"
+#include "Profiler.h"
+#include "Parallel.h"
 
 using namespace geom;
 
@@ -16,14 +18,17 @@ template< class T > void SafeDeleteArray( T*& pVal )
   pVal = NULL;
 }
 
-EwaldCached::EwaldCached(StaticVals & stat, System & sys) : Ewald(stat, sys)
+template <class T>
+EwaldCached<T>::EwaldCached(StaticVals & stat, System & sys) :
+  Ewald(stat, sys)
 #if ENSEMBLE == GEMC
   , GEMC_KIND(stat.kindOfGEMC)
 #endif
 {}
 
 
-EwaldCached::~EwaldCached()
+template <class T>
+EwaldCached<T>::~EwaldCached()
 {
   SafeDeleteArray(kmax);
   SafeDeleteArray(imageSize);
@@ -59,26 +64,15 @@ EwaldCached::~EwaldCached()
   SafeDeleteArray(sumRref);
   SafeDeleteArray(sumIref);
 
-  int i;
-#ifdef _OPENMP
-  #pragma omp parallel for default(shared) private(i)
-#endif
-  for (i = 0; i < mols.count; i++) {
-    SafeDeleteArray(cosMolRef[i]);
-    SafeDeleteArray(sinMolRef[i]);
-    SafeDeleteArray(cosMolBoxRecip[i]);
-    SafeDeleteArray(sinMolBoxRecip[i]);
-  }
   SafeDeleteArray(cosMolRef);
   SafeDeleteArray(sinMolRef);
   SafeDeleteArray(cosMolBoxRecip);
   SafeDeleteArray(sinMolBoxRecip);
-
-  SafeDeleteArray(cosMolRestore);
-  SafeDeleteArray(sinMolRestore);
+  SafeDeleteArray(slab);
 }
 
-void EwaldCached::Init()
+template <class T>
+void EwaldCached<T>::Init()
 {
   for(uint m = 0; m < mols.count; ++m) {
     const MoleculeKind& molKind = mols.GetKind(m);
@@ -94,7 +88,8 @@ void EwaldCached::Init()
   UpdateVectorsAndRecipTerms();
 }
 
-void EwaldCached::AllocMem()
+template <class T>
+void EwaldCached<T>::AllocMem()
 {
   kmax = new uint[BOXES_WITH_U_NB];
   imageSize = new uint[BOXES_WITH_U_NB];
@@ -114,10 +109,10 @@ void EwaldCached::AllocMem()
   hsqrRef = new double*[BOXES_WITH_U_NB];
   prefactRef = new double*[BOXES_WITH_U_NB];
 
-  cosMolRef = new double*[mols.count];
-  sinMolRef = new double*[mols.count];
-  cosMolBoxRecip = new double*[mols.count];
-  sinMolBoxRecip = new double*[mols.count];
+  cosMolRef = new T*[mols.count];
+  sinMolRef = new T*[mols.count];
+  cosMolBoxRecip = new T*[mols.count];
+  sinMolBoxRecip = new T*[mols.count];
 
   for(uint b = 0; b < BOXES_WITH_U_NB; b++) {
     RecipCountInit(b, currentAxes);
@@ -126,9 +121,6 @@ void EwaldCached::AllocMem()
   //25% larger than original box size, reserved for image size change
   imageTotal = Ewald::findLargeImage();
 
-  cosMolRestore = new double[imageTotal];
-  sinMolRestore = new double[imageTotal];
-
   for(uint b = 0; b < BOXES_WITH_U_NB; b++) {
     kx[b] = new double[imageTotal];
     ky[b] = new double[imageTotal];
@@ -146,76 +138,144 @@ void EwaldCached::AllocMem()
     sumIref[b] = new double[imageTotal];
   }
 
-  int i;
-#ifdef _OPENMP
-  #pragma omp parallel for default(shared) private(i)
-#endif
-  for (i = 0; i < mols.count; i++) {
-    cosMolRef[i] = new double[imageTotal];
-    sinMolRef[i] = new double[imageTotal];
-    cosMolBoxRecip[i] = new double[imageTotal];
-    sinMolBoxRecip[i] = new double[imageTotal];
+  //two rows for the restore buffers, four (current and backup cos and sin)
+  //for each molecule whose kind has charges
+  std::vector<bool> charged(mols.GetKindsCount(), false);
+  for (uint k = 0; k < mols.GetKindsCount(); k++) {
+    for (uint a = 0; a < mols.kinds[k].NumAtoms(); a++) {
+      if (mols.kinds[k].AtomCharge(a) != 0.0)
+        charged[k] = true;
+    }
+  }
+  size_t rows = 2;
+  for (uint m = 0; m < mols.count; m++) {
+    if (charged[mols.kIndex[m]])
+      rows += 4;
   }
 
+  slab = new T[rows * imageTotal];
+  T *row = slab;
+  cosMolRestore = row;
+  sinMolRestore = row + imageTotal;
+  row += 2 * imageTotal;
+  for (uint m = 0; m < mols.count; m++) {
+    if (charged[mols.kIndex[m]]) {
+      cosMolRef[m] = row;
+      sinMolRef[m] = row + imageTotal;
+      cosMolBoxRecip[m] = row + 2 * imageTotal;
+      sinMolBoxRecip[m] = row + 3 * imageTotal;
+      row += 4 * imageTotal;
+    } else {
+      cosMolRef[m] = sinMolRef[m] = NULL;
+      cosMolBoxRecip[m] = sinMolBoxRecip[m] = NULL;
+    }
+  }
+  printf("%-40s %-.1f MB \n", "Info: Ewald Fourier cache",
+         rows * imageTotal * sizeof(T) / 1048576.0);
 }
 
 //calculate reciprocate term for a box
-void EwaldCached::BoxReciprocalSetup(uint box, XYZArray const& molCoords)
+template <class T>
+void EwaldCached<T>::BoxReciprocalSetup(uint box, XYZArray const& molCoords)
 {
-  uint j, m;
-  int i;
-  double dotProduct = 0.0;
+  PROFILE_SCOPE(prof::BOX_RECIP_SETUP);
 
   if (box < BOXES_WITH_U_NB) {
-    MoleculeLookup::box_iterator end = molLookup.BoxEnd(box);
-    MoleculeLookup::box_iterator thisMol = molLookup.BoxBegin(box);
-
+    RecipLattice const& lat = lattice[box];
+    RecipTiles& tiles = boxTiles[box];
+    int kTiles = (imageSize[box] + RECIP_TILE_K - 1) / RECIP_TILE_K;
+    int tileCount;
+
+    std::memset(sumRnew[box], 0.0, sizeof(double) * imageSize[box]);
+    std::memset(sumInew[box], 0.0, sizeof(double) * imageSize[box]);
+    BoxTiles(tiles, box);
+    tileCount = tiles.tileFirst.size() - 1;
+    PROFILE_COUNT(prof::KVECTORS, imageSize[box] * tiles.mol.size());
+
+    //as Ewald::BoxReciprocalSetup, keeping the sums of each molecule
+    if (lat.use) {
+      ReserveTables(lat, tiles.maxTile, box);
 #ifdef _OPENMP
-    #pragma omp parallel default(shared)
+      #pragma omp parallel default(shared) if(par::Worth(imageSize[box] * tiles.atom.size()))
 #endif
-    {
-      std::memset(sumRnew[box], 0.0, sizeof(double) * imageSize[box]);
-      std::memset(sumInew[box], 0.0, sizeof(double) * imageSize[box]);
-    }
-
-    while (thisMol != end) {
-      MoleculeKind const& thisKind = mols.GetKind(*thisMol);
+      for (int t = 0; t < tileCount; t++) {
+        uint firstMol = tiles.tileFirst[t], lastMol = tiles.tileFirst[t + 1];
+        uint first = tiles.molFirst[firstMol];
+        int count = tiles.molFirst[lastMol] - first;
+#ifdef _OPENMP
+        #pragma omp for
+#endif
+        for (int p = 0; p < count; p++) {
+          LatticeTables(lat, molCoords, tiles.atom[first + p], 1, p, box);
+        }
 
 #ifdef _OPENMP
-      #pragma omp parallel for default(shared) private(i, j, dotProduct)
+        #pragma omp for
 #endif
-      for (i = 0; i < imageSize[box]; i++) {
-        cosMolRef[*thisMol][i] = 0.0;
-        sinMolRef[*thisMol][i] = 0.0;
-
-        for (j = 0; j < thisKind.NumAtoms(); j++) {
-          dotProduct = Dot(mols.MolStart(*thisMol) + j,
-                           kx[box][i], ky[box][i],
-                           kz[box][i], molCoords);
-
-          cosMolRef[*thisMol][i] += (thisKind.AtomCharge(j) *
-                                     cos(dotProduct));
-          sinMolRef[*thisMol][i] += (thisKind.AtomCharge(j) *
-                                     sin(dotProduct));
+        for (int kt = 0; kt < kTiles; kt++) {
+          uint kEnd = std::min((kt + 1) * RECIP_TILE_K, imageSize[box]);
+          for (uint m = firstMol; m < lastMol; m++) {
+            uint molecule = tiles.mol[m];
+            uint atoms = tiles.molFirst[m + 1] - tiles.molFirst[m];
+            //molecules without charged atoms have no cache rows
+            if (atoms == 0)
+              continue;
+            for (uint k = kt * RECIP_TILE_K; k < kEnd; k++) {
+              double sumReal, sumImaginary;
+              LatticeSum(sumReal, sumImaginary, lat, k,
+                         &tiles.charge[tiles.molFirst[m]], atoms,
+                         tiles.molFirst[m] - first, box);
+              cosMolRef[molecule][k] = sumReal;
+              sinMolRef[molecule][k] = sumImaginary;
+              sumRnew[box][k] += cosMolRef[molecule][k];
+              sumInew[box][k] += sinMolRef[molecule][k];
+            }
+          }
+        }
+      }
+    } else {
+#ifdef _OPENMP
+      #pragma omp parallel for default(shared) if(par::Worth(imageSize[box] * tiles.atom.size()))
+#endif
+      for (int kt = 0; kt < kTiles; kt++) {
+        uint kEnd = std::min((kt + 1) * RECIP_TILE_K, imageSize[box]);
+        for (uint m = 0; m < tiles.mol.size(); m++) {
+          uint molecule = tiles.mol[m];
+          uint first = tiles.molFirst[m], last = tiles.molFirst[m + 1];
+          if (first == last)
+            continue;
+          for (uint k = kt * RECIP_TILE_K; k < kEnd; k++) {
+            double sumReal = 0.0, sumImaginary = 0.0;
+            for (uint p = first; p < last; p++) {
+              double dotProduct = Dot(tiles.atom[p], kx[box][k], ky[box][k],
+                                      kz[box][k], molCoords);
+              sumReal += tiles.charge[p] * cos(dotProduct);
+              sumImaginary += tiles.charge[p] * sin(dotProduct);
+            }
+            cosMolRef[molecule][k] = sumReal;
+            sinMolRef[molecule][k] = sumImaginary;
+            sumRnew[box][k] += cosMolRef[molecule][k];
+            sumInew[box][k] += sinMolRef[molecule][k];
+          }
         }
-        sumRnew[box][i] += cosMolRef[*thisMol][i];
-        sumInew[box][i] += sinMolRef[*thisMol][i];
       }
-      thisMol++;
     }
   }
 }
 
 
 //calculate reciprocate term for a box
-double EwaldCached::BoxReciprocal(uint box) const
+template <class T>
+double EwaldCached<T>::BoxReciprocal(uint box) const
 {
+  PROFILE_SCOPE(prof::BOX_RECIP);
   int i;
   double energyRecip = 0.0;
 
   if (box < BOXES_WITH_U_NB) {
+    PROFILE_COUNT(prof::KVECTORS, imageSize[box]);
 #ifdef _OPENMP
-    #pragma omp parallel for default(shared) private(i) reduction(+:energyRecip)
+    #pragma omp parallel for default(shared) private(i) reduction(+:energyRecip) if(par::Worth(imageSize[box]))
 #endif
     for (i = 0; i < imageSize[box]; i++) {
       energyRecip += (( sumRnew[box][i] * sumRnew[box][i] +
@@ -228,12 +288,18 @@ double EwaldCached::BoxReciprocal(uint box) const
 }
 
 //calculate reciprocate term for displacement and rotation move
-double EwaldCached::MolReciprocal(XYZArray const& molCoords,
-                                  const uint molIndex,
-                                  const uint box)
+template <class T>
+double EwaldCached<T>::MolReciprocal(XYZArray const& molCoords,
+                                     const uint molIndex,
+                                     const uint box)
 {
+  PROFILE_SCOPE(prof::MOL_RECIP);
   double energyRecipNew = 0.0;
 
+  if (box < BOXES_WITH_U_NB && !Cached(molIndex)) {
+    KeepSums(box);
+    return 0.0;
+  }
   if (box < BOXES_WITH_U_NB) {
     MoleculeKind const& thisKind = mols.GetKind(molIndex);
     uint length = thisKind.NumAtoms();
@@ -241,9 +307,13 @@ double EwaldCached::MolReciprocal(XYZArray const& molCoords,
     int i;
     double sumRealNew, sumImaginaryNew, dotProductNew, sumRealOld,
            sumImaginaryOld;
+    PROFILE_COUNT(prof::KVECTORS, imageSizeRef[box]);
+
+    if (latticeRef[box].use)
+      LatticeTables(latticeRef[box], molCoords, 0, length, 0, box);
 
 #ifdef _OPENMP
-    #pragma omp parallel for default(shared) private(i, p, sumRealNew, sumImaginaryNew, sumRealOld, sumImaginaryOld, dotProductNew) reduction(+:energyRecipNew)
+    #pragma omp parallel for default(shared) private(i, p, sumRealNew, sumImaginaryNew, sumRealOld, sumImaginaryOld, dotProductNew) reduction(+:energyRecipNew) if(par::Worth(imageSizeRef[box] * length))
 #endif
     for (i = 0; i < imageSizeRef[box]; i++) {
       sumRealNew = 0.0;
@@ -254,19 +324,25 @@ double EwaldCached::MolReciprocal(XYZArray const& molCoords,
       cosMolRestore[i] = cosMolRef[molIndex][i];
       sinMolRestore[i] = sinMolRef[molIndex][i];
 
-      for (p = 0; p < length; ++p) {
-        dotProductNew = Dot(p, kxRef[box][i],
-                            kyRef[box][i], kzRef[box][i],
-                            molCoords);
-
-        sumRealNew += (thisKind.AtomCharge(p) * cos(dotProductNew));
-        sumImaginaryNew += (thisKind.AtomCharge(p) * sin(dotProductNew));
+      if (latticeRef[box].use) {
+        LatticeSum(sumRealNew, sumImaginaryNew, latticeRef[box], i, thisKind,
+                   length, 0, box);
+      } else {
+        for (p = 0; p < length; ++p) {
+          dotProductNew = Dot(p, kxRef[box][i],
+                              kyRef[box][i], kzRef[box][i],
+                              molCoords);
+
+          sumRealNew += (thisKind.AtomCharge(p) * cos(dotProductNew));
+          sumImaginaryNew += (thisKind.AtomCharge(p) * sin(dotProductNew));
+        }
       }
 
-      sumRnew[box][i] = sumRref[box][i] - sumRealOld + sumRealNew;
-      sumInew[box][i] = sumIref[box][i] - sumImaginaryOld + sumImaginaryNew;
       cosMolRef[molIndex][i] = sumRealNew;
       sinMolRef[molIndex][i] = sumImaginaryNew;
+      sumRnew[box][i] = sumRref[box][i] - sumRealOld + cosMolRef[molIndex][i];
+      sumInew[box][i] = sumIref[box][i] - sumImaginaryOld +
+                        sinMolRef[molIndex][i];
 
       energyRecipNew += (sumRnew[box][i] * sumRnew[box][i] + sumInew[box][i]
                          * sumInew[box][i]) * prefactRef[box][i];
@@ -277,46 +353,57 @@ double EwaldCached::MolReciprocal(XYZArray const& molCoords,
 }
 
 //calculate reciprocate term in destination box for swap move
-double EwaldCached::SwapDestRecip(const cbmc::TrialMol &newMol,
-                                  const uint box,
-                                  const int molIndex)
+template <class T>
+double EwaldCached<T>::SwapDestRecip(const cbmc::TrialMol &newMol,
+                                     const uint box,
+                                     const int molIndex)
 {
+  PROFILE_SCOPE(prof::SWAP_DEST_RECIP);
   double energyRecipNew = 0.0;
   double energyRecipOld = 0.0;
 
-#ifdef _OPENMP
-  #pragma omp parallel default(shared)
-#endif
-  {
-    std::memcpy(cosMolRestore, cosMolRef[molIndex], sizeof(double)*imageTotal);
-    std::memcpy(sinMolRestore, sinMolRef[molIndex], sizeof(double)*imageTotal);
+  if (!Cached(molIndex)) {
+    if (box < BOXES_WITH_U_NB)
+      KeepSums(box);
+    return 0.0;
   }
+  std::memcpy(cosMolRestore, cosMolRef[molIndex], sizeof(T) * imageTotal);
+  std::memcpy(sinMolRestore, sinMolRef[molIndex], sizeof(T) * imageTotal);
 
   if (box < BOXES_WITH_U_NB) {
     uint p, length;
     int i;
     MoleculeKind const& thisKind = newMol.GetKind();
     XYZArray molCoords = newMol.GetCoords();
-    double dotProductNew;
+    double dotProductNew, sumRealNew, sumImaginaryNew;
     length = thisKind.NumAtoms();
+    PROFILE_COUNT(prof::KVECTORS, imageSizeRef[box]);
+
+    if (latticeRef[box].use)
+      LatticeTables(latticeRef[box], molCoords, 0, length, 0, box);
 
 #ifdef _OPENMP
-    #pragma omp parallel for default(shared) private(i, p, dotProductNew) reduction(+:energyRecipNew)
+    #pragma omp parallel for default(shared) private(i, p, dotProductNew, sumRealNew, sumImaginaryNew) reduction(+:energyRecipNew) if(par::Worth(imageSizeRef[box] * length))
 #endif
     for (i = 0; i < imageSizeRef[box]; i++) {
-      cosMolRef[molIndex][i] = 0.0;
-      sinMolRef[molIndex][i] = 0.0;
+      sumRealNew = 0.0;
+      sumImaginaryNew = 0.0;
       dotProductNew = 0.0;
 
-      for (p = 0; p < length; ++p) {
-        dotProductNew = Dot(p, kxRef[box][i],
-                            kyRef[box][i], kzRef[box][i],
-                            molCoords);
-        cosMolRef[molIndex][i] += (thisKind.AtomCharge(p) *
-                                   cos(dotProductNew));
-        sinMolRef[molIndex][i] += (thisKind.AtomCharge(p) *
-                                   sin(dotProductNew));
+      if (latticeRef[box].use) {
+        LatticeSum(sumRealNew, sumImaginaryNew, latticeRef[box], i, thisKind,
+                   length, 0, box);
+      } else {
+        for (p = 0; p < length; ++p) {
+          dotProductNew = Dot(p, kxRef[box][i],
+                              kyRef[box][i], kzRef[box][i],
+                              molCoords);
+          sumRealNew += (thisKind.AtomCharge(p) * cos(dotProductNew));
+          sumImaginaryNew += (thisKind.AtomCharge(p) * sin(dotProductNew));
+        }
       }
+      cosMolRef[molIndex][i] = sumRealNew;
+      sinMolRef[molIndex][i] = sumImaginaryNew;
 
       //sumRealNew;
       sumRnew[box][i] = sumRref[box][i] + cosMolRef[molIndex][i];
@@ -335,16 +422,23 @@ double EwaldCached::SwapDestRecip(const cbmc::TrialMol &newMol,
 
 
 //calculate reciprocate term in source box for swap move
-double EwaldCached::SwapSourceRecip(const cbmc::TrialMol &oldMol,
-                                    const uint box, const int molIndex)
+template <class T>
+double EwaldCached<T>::SwapSourceRecip(const cbmc::TrialMol &oldMol,
+                                       const uint box, const int molIndex)
 {
+  PROFILE_SCOPE(prof::SWAP_SOURCE_RECIP);
   double energyRecipNew = 0.0;
   double energyRecipOld = 0.0;
 
+  if (box < BOXES_WITH_U_NB && !Cached(molIndex)) {
+    KeepSums(box);
+    return 0.0;
+  }
   if (box < BOXES_WITH_U_NB) {
     int i;
+    PROFILE_COUNT(prof::KVECTORS, imageSizeRef[box]);
 #ifdef _OPENMP
-    #pragma omp parallel for default(shared) private(i) reduction(+:energyRecipNew)
+    #pragma omp parallel for default(shared) private(i) reduction(+:energyRecipNew) if(par::Worth(imageSizeRef[box]))
 #endif
     for (i = 0; i < imageSizeRef[box]; i++) {
       sumRnew[box][i] = sumRref[box][i] - cosMolRestore[i];
@@ -361,8 +455,9 @@ double EwaldCached::SwapSourceRecip(const cbmc::TrialMol &oldMol,
 
 //calculate reciprocate term for inserting some molecules (kindA) in destination
 // box and removing a molecule (kindB) from destination box
-double EwaldCached::SwapRecip(const std::vector<cbmc::TrialMol> &newMol,
-                              const std::vector<cbmc::TrialMol> &oldMol)
+template <class T>
+double EwaldCached<T>::SwapRecip(const std::vector<cbmc::TrialMol> &newMol,
+                                 const std::vector<cbmc::TrialMol> &oldMol)
 {
   //This function should not be called in IDExchange move
   std::cout << "Error: Cached Fourier method cannot be used while " <<
@@ -372,9 +467,12 @@ double EwaldCached::SwapRecip(const std::vector<cbmc::TrialMol> &newMol,
 }
 
 //restore cosMol and sinMol
-void EwaldCached::RestoreMol(int molIndex)
+template <class T>
+void EwaldCached<T>::RestoreMol(int molIndex)
 {
-  double *tempCos, *tempSin;
+  if (!Cached(molIndex))
+    return;
+  T *tempCos, *tempSin;
   tempCos = cosMolRef[molIndex];
   tempSin = sinMolRef[molIndex];
   cosMolRef[molIndex] = cosMolRestore;
@@ -384,9 +482,10 @@ void EwaldCached::RestoreMol(int molIndex)
 }
 
 //restore the whole cosMolRef & sinMolRef into cosMolBoxRecip & sinMolBoxRecip
-void EwaldCached::exgMolCache()
+template <class T>
+void EwaldCached<T>::exgMolCache()
 {
-  double **tempCos, **tempSin;
+  T **tempCos, **tempSin;
   tempCos = cosMolRef;
   tempSin = sinMolRef;
   cosMolRef = cosMolBoxRecip;
@@ -396,7 +495,8 @@ void EwaldCached::exgMolCache()
 }
 
 //backup the whole cosMolRef & sinMolRef into cosMolBoxRecip & sinMolBoxRecip
-void EwaldCached::backupMolCache()
+template <class T>
+void EwaldCached<T>::backupMolCache()
 {
 #if ENSEMBLE == NPT
   exgMolCache();
@@ -410,8 +510,10 @@ void EwaldCached::backupMolCache()
       #pragma omp parallel for private(m)
 #endif
       for(m = 0; m < mols.count; m++) {
-        std::memcpy(cosMolBoxRecip[m], cosMolRef[m], sizeof(double)*imageTotal);
-        std::memcpy(sinMolBoxRecip[m], sinMolRef[m], sizeof(double)*imageTotal);
+        if (Cached(m)) {
+          std::memcpy(cosMolBoxRecip[m], cosMolRef[m], sizeof(T) * imageTotal);
+          std::memcpy(sinMolBoxRecip[m], sinMolRef[m], sizeof(T) * imageTotal);
+        }
       }
     }
   } else {
@@ -420,9 +522,21 @@ void EwaldCached::backupMolCache()
     #pragma omp parallel for private(m)
 #endif
     for(m = 0; m < mols.count; m++) {
-      std::memcpy(cosMolBoxRecip[m], cosMolRef[m], sizeof(double)*imageTotal);
-      std::memcpy(sinMolBoxRecip[m], sinMolRef[m], sizeof(double)*imageTotal);
+      if (Cached(m)) {
+        std::memcpy(cosMolBoxRecip[m], cosMolRef[m], sizeof(T) * imageTotal);
+        std::memcpy(sinMolBoxRecip[m], sinMolRef[m], sizeof(T) * imageTotal);
+      }
     }
   }
 #endif
 }
+
+template <class T>
+void EwaldCached<T>::KeepSums(const uint box)
+{
+  std::memcpy(sumRnew[box], sumRref[box], sizeof(double) * imageSizeRef[box]);
+  std::memcpy(sumInew[box], sumIref[box], sizeof(double) * imageSizeRef[box]);
+}
+
+template class EwaldCached<double>;
+template class EwaldCached<float>;
@@ -9,6 +9,13 @@ along with this program, also can be found at <http://www.gnu.org/licenses/>.
 
 #include "Ewald.h"
 
+//Ewald with the reciprocal sums of every charged molecule cached, so a move
+//only sums the atoms of the moved molecule. T is the storage type of the
+//cache: float halves its memory, the sums themselves are still done in
+//double and the box sums only ever add or remove the stored values, so the
+//box sums do not drift from the cache. Molecules of kinds without charges
+//have no cache rows.
+template <class T>
 class EwaldCached : public Ewald
 {
 public:
@@ -18,6 +25,18 @@ public:
 
   virtual void Init();
 
+  //the molecule cache can not be restored from the structure factors
+  virtual bool InitFromSums(std::vector<std::vector<double> > const& sumR,
+                            std::vector<std::vector<double> > const& sumI)
+  {
+    return false;
+  }
+  virtual bool GetRecipSums(std::vector<double>& sumR,
+                            std::vector<double>& sumI, uint box) const
+  {
+    return false;
+  }
+
   virtual void AllocMem();
 
   //setup reciprocate term for a box
@@ -54,12 +73,25 @@ public:
 
 private:
 
-  double *cosMolRestore; //cos()*charge
-  double *sinMolRestore; //sin()*charge
-  double **cosMolRef;
-  double **sinMolRef;
-  double **cosMolBoxRecip;
-  double **sinMolBoxRecip;
+  //True if molecule m has a cache row
+  bool Cached(const uint m) const
+  {
+    return cosMolRef[m] != NULL;
+  }
+
+  //Sets the new sums of box to the current ones, the result of moving a
+  //molecule without charges
+  void KeepSums(const uint box);
+
+  T *cosMolRestore; //cos()*charge
+  T *sinMolRestore; //sin()*charge
+  T **cosMolRef;
+  T **sinMolRef;
+  T **cosMolBoxRecip;
+  T **sinMolBoxRecip;
+  //one allocation holding every row of the cache, rows are handed out
+  //through the pointers above and swapped between them
+  T *slab;
 #if ENSEMBLE == GEMC
   const uint GEMC_KIND;
 #endif
@@ -0,0 +1,651 @@
+/*******************************************************************************
+GPU OPTIMIZED MONTE CARLO (GOMC) 2.40
+Copyright (C) 2018  GOMC Group
+A copy of the GNU General Public License can be found in the COPYRIGHT.txt
+along with this program, also can be found at <http://www.gnu.org/licenses/>.
+********************************************************************************/
+#include "EwaldPME.h"
+#include "StaticVals.h"
+#include "MoleculeKind.h"
+#include "Coordinates.h"
+#include "COM.h"
+#include "BoxDimensions.h"
+#include "TrialMol.h"
+#include "NumLib.h"
+#include "Profiler.h"
+#include <algorithm>
+#include <cmath>
+
+const int EwaldPME::ORDER;
+
+EwaldPME::EwaldPME(StaticVals & stat, System & sys) : Ewald(stat, sys)
+{
+  for(uint b = 0; b < BOXES_WITH_U_NB; b++) {
+    pendingCost[b] = refreshCost[b] = 0.0;
+  }
+#if ENSEMBLE == GEMC
+  excess = 1.25;
+#elif ENSEMBLE == NPT
+  excess = 1.5;
+#else
+  excess = 1.00;
+#endif
+}
+
+void EwaldPME::Init()
+{
+  Ewald::Init();
+
+  //The Ewald sum over the same wave vectors is exact, the difference is
+  //the error of the mesh
+  for(uint b = 0; b < BOXES_WITH_U_NB; b++) {
+    Ewald::RecipInit(b, currentAxes);
+    Ewald::BoxReciprocalSetup(b, currentCoords);
+    double exact = Ewald::BoxReciprocal(b);
+    double error = mesh[b].energy - exact;
+    printf("Box: %d, PME recip energy: %.6e K, Ewald: %.6e K, "
+           "relative error: %.2e\n", b, mesh[b].energy, exact,
+           (exact != 0.0 ? fabs(error / exact) : fabs(error)));
+  }
+}
+
+void EwaldPME::AllocMem()
+{
+  //k vectors are not used, but ~Ewald expects them allocated
+  Ewald::AllocMem();
+
+  for(uint b = 0; b < BOXES_WITH_U_NB; b++) {
+    SetMesh(b, currentAxes.axis.Get(b) * excess);
+  }
+}
+
+uint EwaldPME::Points(const uint box, const double length) const
+{
+  //every wave vector below recip_rcut, at no more than the spacing
+  int nMax = int(ff.recip_rcut[box] * length / (2 * M_PI)) + 1;
+  return std::max(2 * nMax + 1, (int)ceil(length / ff.pmeSpacing));
+}
+
+void EwaldPME::SetMesh(const uint box, XYZ const& axis)
+{
+  double length[3] = { axis.x, axis.y, axis.z };
+  for(uint a = 0; a < 3; a++) {
+    meshSize[box][a] = FFT3D::GoodSize(Points(box, length[a]));
+  }
+  fft[box].Init(meshSize[box][0], meshSize[box][1], meshSize[box][2]);
+
+  //B-spline moduli, |b(m)|^2 = 1 / |sum_k M(k + 1) exp(2 pi i m k / K)|^2
+  double w[ORDER];
+  Weights(w, NULL, 0.0);
+  for(uint a = 0; a < 3; a++) {
+    uint K = meshSize[box][a];
+    moduli[box][a].resize(K);
+    for(uint m = 0; m < K; m++) {
+      double sumR = 0.0, sumI = 0.0;
+      for(int k = 0; k < ORDER - 1; k++) {
+        double arg = 2.0 * M_PI * m * k / K;
+        sumR += w[ORDER - 2 - k] * cos(arg);
+        sumI += w[ORDER - 2 - k] * sin(arg);
+      }
+      double denom = sumR * sumR + sumI * sumI;
+      moduli[box][a][m] = (denom > 1.0e-10 ? 1.0 / denom : 0.0);
+    }
+  }
+
+  uint total = fft[box].Size();
+  refreshCost[box] = 2.0 * total * log2((double)total);
+  pendingCost[box] = 0.0;
+  pending[box].clear();
+  trial[box].clear();
+}
+
+void EwaldPME::UpdateVectorsAndRecipTerms()
+{
+  for (uint b = 0; b < BOXES_WITH_U_NB; ++b) {
+    RecipInit(b, currentAxes);
+    BoxReciprocalSetup(b, currentCoords);
+    SetRecipRef(b);
+    printf("Box: %d, PME mesh: %d x %d x %d\n", b, meshSize[b][0],
+           meshSize[b][1], meshSize[b][2]);
+  }
+}
+
+void EwaldPME::Weights(double* w, double* dw, const double frac)
+{
+  int j, k;
+  double div;
+
+  w[ORDER - 1] = 0.0;
+  w[1] = frac;
+  w[0] = 1.0 - frac;
+  for(j = 3; j < ORDER; j++) {
+    div = 1.0 / (j - 1);
+    w[j - 1] = div * frac * w[j - 2];
+    for(k = 1; k < j - 1; k++) {
+      w[j - k - 1] = div * ((frac + k) * w[j - k - 2] +
+                            (j - k - frac) * w[j - k - 1]);
+    }
+    w[0] = div * (1.0 - frac) * w[0];
+  }
+
+  //derivative from the order - 1 spline
+  if(dw != NULL) {
+    dw[0] = -w[0];
+    for(j = 1; j < ORDER; j++)
+      dw[j] = w[j - 1] - w[j];
+  }
+
+  div = 1.0 / (ORDER - 1);
+  w[ORDER - 1] = div * frac * w[ORDER - 2];
+  for(k = 1; k < ORDER - 1; k++) {
+    w[ORDER - k - 1] = div * ((frac + k) * w[ORDER - k - 2] +
+                              (ORDER - k - frac) * w[ORDER - k - 1]);
+  }
+  w[0] = div * (1.0 - frac) * w[0];
+}
+
+void EwaldPME::SplineAt(int* first, double (*w)[ORDER], double (*dw)[ORDER],
+                        XYZ const& pos, XYZ const& axis, const uint box) const
+{
+  double r[3] = { pos.x, pos.y, pos.z };
+  double length[3] = { axis.x, axis.y, axis.z };
+  for(uint a = 0; a < 3; a++) {
+    double K = meshSize[box][a];
+    double u = r[a] / length[a] * K;
+    u -= K * floor(u / K);
+    double base = floor(u);
+    Weights(w[a], (dw != NULL ? dw[a] : NULL), u - base);
+    first[a] = (int)base - ORDER + 1 + (int)K;
+  }
+}
+
+void EwaldPME::Spread(std::vector<MeshPoint>& points, XYZArray const& coords,
+                      const uint start, const uint length,
+                      MoleculeKind const& kind, const double sign,
+                      XYZ const& axis, const uint box) const
+{
+  int first[3];
+  double w[3][ORDER];
+  const uint *K = meshSize[box];
+  MeshPoint point;
+
+  for(uint p = 0; p < length; p++) {
+    double charge = sign * kind.AtomCharge(p);
+    if(charge == 0.0)
+      continue;
+
+    SplineAt(first, w, NULL, coords[start + p], axis, box);
+    for(int i = 0; i < ORDER; i++) {
+      point.x = (first[0] + i) % K[0];
+      for(int j = 0; j < ORDER; j++) {
+        point.y = (first[1] + j) % K[1];
+        for(int k = 0; k < ORDER; k++) {
+          point.z = (first[2] + k) % K[2];
+          point.index = (point.x * K[1] + point.y) * K[2] + point.z;
+          point.charge = charge * w[0][i] * w[1][j] * w[2][k];
+          points.push_back(point);
+        }
+      }
+    }
+  }
+}
+
+void EwaldPME::Merge(std::vector<MeshPoint>& points)
+{
+  if(points.empty())
+    return;
+
+  std::sort(points.begin(), points.end());
+  uint last = 0;
+  for(uint i = 1; i < points.size(); i++) {
+    if(points[i].index == points[last].index)
+      points[last].charge += points[i].charge;
+    else
+      points[++last] = points[i];
+  }
+  points.resize(last + 1);
+}
+
+double EwaldPME::Convolve(MeshPoint const& a,
+                          std::vector<MeshPoint> const& points,
+                          std::vector<double> const& kernel,
+                          const uint box) const
+{
+  int K[3] = { (int)meshSize[box][0], (int)meshSize[box][1],
+               (int)meshSize[box][2] };
+  double sum = 0.0;
+  for(uint n = 0; n < points.size(); n++) {
+    int dx = (int)a.x - (int)points[n].x;
+    int dy = (int)a.y - (int)points[n].y;
+    int dz = (int)a.z - (int)points[n].z;
+    if(dx < 0) dx += K[0];
+    if(dy < 0) dy += K[1];
+    if(dz < 0) dz += K[2];
+    sum += kernel[(dx * K[1] + dy) * K[2] + dz] * points[n].charge;
+  }
+  return sum;
+}
+
+double EwaldPME::WaveNumber(const uint i, const uint axis, const uint box,
+                            const double length) const
+{
+  int K = meshSize[box][axis];
+  int m = ((int)i <= K / 2 ? (int)i : (int)i - K);
+  return 2.0 * M_PI * m / length;
+}
+
+void EwaldPME::RecipInit(uint box, BoxDimensions const& boxAxes)
+{
+  PROFILE_SCOPE(prof::RECIP_INIT);
+  if(box >= BOXES_WITH_U_NB)
+    return;
+
+  if(!boxAxes.orthogonal[box]) {
+    std::cout << "Error: PME requires an orthogonal simulation box.\n";
+    exit(EXIT_FAILURE);
+  }
+
+  PMEMesh& thisMesh = mesh[box];
+  XYZ axis = boxAxes.axis.Get(box);
+  double length[3] = { axis.x, axis.y, axis.z };
+  bool fits = true;
+  for(uint a = 0; a < 3; a++) {
+    fits &= (Points(box, length[a]) <= meshSize[box][a]);
+  }
+  if(!fits) {
+    //The box outgrew the mesh. Lay out a larger one for both this and the
+    //Ref box, and set the Ref mesh up again on it.
+    XYZ ref = currentAxes.axis.Get(box);
+    SetMesh(box, XYZ(std::max(axis.x, ref.x), std::max(axis.y, ref.y),
+                     std::max(axis.z, ref.z)) * excess);
+    printf("Info: Box %d, PME mesh grown to %d x %d x %d\n", box,
+           meshSize[box][0], meshSize[box][1], meshSize[box][2]);
+    RecipInit(box, currentAxes);
+    BoxReciprocalSetup(box, currentCoords);
+    SetRecipRef(box);
+  }
+  thisMesh.axis = axis;
+
+  uint total = fft[box].Size();
+  uint *K = meshSize[box];
+  thisMesh.influence.resize(total);
+  thisMesh.charge.resize(total);
+  thisMesh.potential.resize(total);
+
+  //half of the Ewald prefactor, since the mesh sums over both k and -k
+  double alpsqr4 = 1.0 / (4.0 * ff.alphaSq[box]);
+  double vol = boxAxes.volume[box] / (4 * M_PI);
+  int i;
+  uint x, y, z;
+  double kX, kY, kZ, ksqr;
+#ifdef _OPENMP
+  #pragma omp parallel for default(shared) private(i, x, y, z, kX, kY, kZ, ksqr)
+#endif
+  for(i = 0; i < (int)total; i++) {
+    x = i / (K[1] * K[2]);
+    y = (i / K[2]) % K[1];
+    z = i % K[2];
+    kX = WaveNumber(x, 0, box, length[0]);
+    kY = WaveNumber(y, 1, box, length[1]);
+    kZ = WaveNumber(z, 2, box, length[2]);
+    ksqr = kX * kX + kY * kY + kZ * kZ;
+
+    if(ksqr > 0.0 && ksqr < ff.recip_rcut_Sq[box]) {
+      thisMesh.influence[i] = 0.5 * num::qqFact * exp(-ksqr * alpsqr4) /
+                              (ksqr * vol) * moduli[box][0][x] *
+                              moduli[box][1][y] * moduli[box][2][z];
+    } else {
+      thisMesh.influence[i] = 0.0;
+    }
+  }
+
+  //only needed once the mesh is accepted, see Kernel
+  thisMesh.kernel.clear();
+}
+
+void EwaldPME::Kernel(PMEMesh& thisMesh, const uint box)
+{
+  //G is even in m, so its transform theta is real
+  std::vector< std::complex<double> > grid(thisMesh.influence.begin(),
+      thisMesh.influence.end());
+  fft[box].Transform(grid, FFT3D::BACKWARD);
+  thisMesh.kernel.resize(grid.size());
+  for(uint i = 0; i < grid.size(); i++) {
+    thisMesh.kernel[i] = grid[i].real();
+  }
+}
+
+void EwaldPME::Solve(PMEMesh& thisMesh, const uint box)
+{
+  uint total = fft[box].Size();
+  std::vector< std::complex<double> > grid(thisMesh.charge.begin(),
+      thisMesh.charge.end());
+  double energyRecip = 0.0;
+  int i;
+
+  fft[box].Transform(grid, FFT3D::FORWARD);
+#ifdef _OPENMP
+  #pragma omp parallel for default(shared) private(i) reduction(+:energyRecip)
+#endif
+  for(i = 0; i < (int)total; i++) {
+    energyRecip += thisMesh.influence[i] * std::norm(grid[i]);
+    grid[i] *= thisMesh.influence[i];
+  }
+  fft[box].Transform(grid, FFT3D::BACKWARD);
+
+  for(i = 0; i < (int)total; i++) {
+    thisMesh.potential[i] = grid[i].real();
+  }
+  thisMesh.energy = energyRecip;
+}
+
+void EwaldPME::BoxReciprocalSetup(uint box, XYZArray const& molCoords)
+{
+  PROFILE_SCOPE(prof::BOX_RECIP_SETUP);
+  if (box >= BOXES_WITH_U_NB)
+    return;
+
+  PMEMesh& thisMesh = mesh[box];
+  std::fill(thisMesh.charge.begin(), thisMesh.charge.end(), 0.0);
+
+  std::vector<MeshPoint> points;
+  MoleculeLookup::box_iterator thisMol = molLookup.BoxBegin(box),
+                               end = molLookup.BoxEnd(box);
+  while (thisMol != end) {
+    MoleculeKind const& thisKind = mols.GetKind(*thisMol);
+    points.clear();
+    Spread(points, molCoords, mols.MolStart(*thisMol), thisKind.NumAtoms(),
+           thisKind, 1.0, thisMesh.axis, box);
+    for(uint n = 0; n < points.size(); n++) {
+      thisMesh.charge[points[n].index] += points[n].charge;
+    }
+    thisMol++;
+  }
+
+  Solve(thisMesh, box);
+}
+
+//calculate reciprocate term for a box
+double EwaldPME::BoxReciprocal(uint box) const
+{
+  PROFILE_SCOPE(prof::BOX_RECIP);
+  if (box >= BOXES_WITH_U_NB)
+    return 0.0;
+  return mesh[box].energy;
+}
+
+void EwaldPME::Refresh(const uint box)
+{
+  Solve(meshRef[box], box);
+  pending[box].clear();
+  pendingCost[box] = 0.0;
+}
+
+double EwaldPME::TrialEnergy(const uint box)
+{
+  Merge(trial[box]);
+  if(meshRef[box].kernel.empty())
+    Kernel(meshRef[box], box);
+  if(pendingCost[box] > refreshCost[box])
+    Refresh(box);
+
+  std::vector<MeshPoint> const& dQ = trial[box];
+  PMEMesh const& ref = meshRef[box];
+  double energyRecip = 0.0;
+  double phi;
+  int i;
+
+#ifdef _OPENMP
+  #pragma omp parallel for default(shared) private(i, phi) reduction(+:energyRecip)
+#endif
+  for(i = 0; i < (int)dQ.size(); i++) {
+    phi = ref.potential[dQ[i].index] +
+          Convolve(dQ[i], pending[box], ref.kernel, box);
+    energyRecip += dQ[i].charge * (2.0 * phi +
+                                   Convolve(dQ[i], dQ, ref.kernel, box));
+  }
+
+  pendingCost[box] += (double)dQ.size() * pending[box].size();
+  return energyRecip;
+}
+
+//calculate reciprocate term for displacement and rotation move
+double EwaldPME::MolReciprocal(XYZArray const& molCoords,
+                               const uint molIndex, const uint box)
+{
+  PROFILE_SCOPE(prof::MOL_RECIP);
+  if (box >= BOXES_WITH_U_NB)
+    return 0.0;
+
+  MoleculeKind const& thisKind = mols.GetKind(molIndex);
+  uint length = thisKind.NumAtoms();
+  uint startAtom = mols.MolStart(molIndex);
+
+  trial[box].clear();
+  Spread(trial[box], molCoords, 0, length, thisKind, 1.0,
+         meshRef[box].axis, box);
+  Spread(trial[box], currentCoords, startAtom, length, thisKind, -1.0,
+         meshRef[box].axis, box);
+  return TrialEnergy(box);
+}
+
+//calculate reciprocate term in destination box for swap move
+double EwaldPME::SwapDestRecip(const cbmc::TrialMol &newMol,
+                               const uint box, const int molIndex)
+{
+  PROFILE_SCOPE(prof::SWAP_DEST_RECIP);
+  if (box >= BOXES_WITH_U_NB)
+    return 0.0;
+
+  MoleculeKind const& thisKind = newMol.GetKind();
+  trial[box].clear();
+  Spread(trial[box], newMol.GetCoords(), 0, thisKind.NumAtoms(), thisKind,
+         1.0, meshRef[box].axis, box);
+  return TrialEnergy(box);
+}
+
+//calculate reciprocate term in source box for swap move
+double EwaldPME::SwapSourceRecip(const cbmc::TrialMol &oldMol,
+                                 const uint box, const int molIndex)
+{
+  PROFILE_SCOPE(prof::SWAP_SOURCE_RECIP);
+  if (box >= BOXES_WITH_U_NB)
+    return 0.0;
+
+  MoleculeKind const& thisKind = oldMol.GetKind();
+  trial[box].clear();
+  Spread(trial[box], oldMol.GetCoords(), 0, thisKind.NumAtoms(), thisKind,
+         -1.0, meshRef[box].axis, box);
+  return TrialEnergy(box);
+}
+
+//calculate reciprocate term for inserting some molecules (kindA) in destination
+// box and removing molecule (kindB) from destination box
+double EwaldPME::SwapRecip(const std::vector<cbmc::TrialMol> &newMol,
+                           const std::vector<cbmc::TrialMol> &oldMol)
+{
+  PROFILE_SCOPE(prof::SWAP_RECIP);
+  uint box = newMol[0].GetBox();
+  if (box >= BOXES_WITH_U_NB)
+    return 0.0;
+
+  MoleculeKind const& thisKindNew = newMol[0].GetKind();
+  MoleculeKind const& thisKindOld = oldMol[0].GetKind();
+  uint m;
+
+  trial[box].clear();
+  for (m = 0; m < newMol.size(); m++) {
+    Spread(trial[box], newMol[m].GetCoords(), 0, thisKindNew.NumAtoms(),
+           thisKindNew, 1.0, meshRef[box].axis, box);
+  }
+  for (m = 0; m < oldMol.size(); m++) {
+    Spread(trial[box], oldMol[m].GetCoords(), 0, thisKindOld.NumAtoms(),
+           thisKindOld, -1.0, meshRef[box].axis, box);
+  }
+  return TrialEnergy(box);
+}
+
+//back up the mesh to Ref (will be called during initialization)
+void EwaldPME::SetRecipRef(uint box)
+{
+  if (box >= BOXES_WITH_U_NB)
+    return;
+
+  meshRef[box] = mesh[box];
+  trial[box].clear();
+  pending[box].clear();
+  pendingCost[box] = 0.0;
+}
+
+//add the accepted mesh change to Ref
+void EwaldPME::UpdateRecip(uint box)
+{
+  PROFILE_SCOPE(prof::UPDATE_RECIP);
+  if (box >= BOXES_WITH_U_NB)
+    return;
+
+  std::vector<MeshPoint>& dQ = trial[box];
+  for(uint n = 0; n < dQ.size(); n++) {
+    meshRef[box].charge[dQ[n].index] += dQ[n].charge;
+  }
+  pending[box].insert(pending[box].end(), dQ.begin(), dQ.end());
+  Merge(pending[box]);
+  dQ.clear();
+}
+
+//swap the mesh set up for the new volume with Ref
+void EwaldPME::UpdateRecipVec(uint box)
+{
+  if (box >= BOXES_WITH_U_NB)
+    return;
+
+  meshRef[box].swap(mesh[box]);
+  trial[box].clear();
+  pending[box].clear();
+  pendingCost[box] = 0.0;
+}
+
+//drop the rejected mesh change
+void EwaldPME::RestoreMol(int molIndex)
+{
+  for(uint b = 0; b < BOXES_WITH_U_NB; b++) {
+    trial[b].clear();
+  }
+}
+
+// NOTE: The calculation of W12, W13, W23 is expensive and would not be
+// requied for pressure and surface tension calculation. So, they have been
+// commented out. In case you need to calculate them, uncomment them.
+Virial EwaldPME::ForceReciprocal(Virial& virial, uint box) const
+{
+  PROFILE_SCOPE(prof::FORCE_RECIP);
+  Virial tempVir = virial;
+  if (box >= BOXES_WITH_U_NB)
+    return tempVir;
+
+  double wT11 = 0.0, wT12 = 0.0, wT13 = 0.0;
+  double wT22 = 0.0, wT23 = 0.0, wT33 = 0.0;
+
+  PMEMesh const& ref = meshRef[box];
+  const uint *K = meshSize[box];
+  uint total = fft[box].Size();
+  double length[3] = { ref.axis.x, ref.axis.y, ref.axis.z };
+  double constVal = 1.0 / (4.0 * ff.alphaSq[box]);
+  double factor, kX, kY, kZ, ksqr;
+  uint x, y, z;
+  int i;
+
+  std::vector< std::complex<double> > grid(ref.charge.begin(),
+      ref.charge.end());
+  fft[box].Transform(grid, FFT3D::FORWARD);
+
+#ifdef _OPENMP
+  #pragma omp parallel for default(shared) private(i, x, y, z, kX, kY, kZ, ksqr, factor) reduction(+:wT11, wT22, wT33)
+#endif
+  for (i = 0; i < (int)total; i++) {
+    if (ref.influence[i] != 0.0) {
+      x = i / (K[1] * K[2]);
+      y = (i / K[2]) % K[1];
+      z = i % K[2];
+      kX = WaveNumber(x, 0, box, length[0]);
+      kY = WaveNumber(y, 1, box, length[1]);
+      kZ = WaveNumber(z, 2, box, length[2]);
+      ksqr = kX * kX + kY * kY + kZ * kZ;
+      factor = ref.influence[i] * std::norm(grid[i]);
+
+      wT11 += factor * (1.0 - 2.0 * (constVal + 1.0 / ksqr) * kX * kX);
+      wT22 += factor * (1.0 - 2.0 * (constVal + 1.0 / ksqr) * kY * kY);
+      wT33 += factor * (1.0 - 2.0 * (constVal + 1.0 / ksqr) * kZ * kZ);
+    }
+    grid[i] *= ref.influence[i];
+  }
+  //potential of the current charges
+  fft[box].Transform(grid, FFT3D::BACKWARD);
+
+  //Intramolecular part, gradient of E on each atom dotted with its
+  //distance from the molecule COM
+  MoleculeLookup::box_iterator thisMol = molLookup.BoxBegin(box),
+                               end = molLookup.BoxEnd(box);
+  int first[3];
+  double w[3][ORDER], dw[3][ORDER];
+  XYZ atomC, comC, diffC, grad;
+
+  while (thisMol != end) {
+    MoleculeKind const& thisKind = mols.GetKind(*thisMol);
+    uint start = mols.MolStart(*thisMol);
+    comC = currentCOM.Get(*thisMol);
+
+    for (uint p = 0; p < thisKind.NumAtoms(); p++) {
+      double charge = thisKind.AtomCharge(p);
+      if (charge == 0.0)
+        continue;
+
+      SplineAt(first, w, dw, currentCoords[start + p], ref.axis, box);
+      grad = XYZ();
+      for (int a = 0; a < ORDER; a++) {
+        x = (first[0] + a) % K[0];
+        for (int b = 0; b < ORDER; b++) {
+          y = (first[1] + b) % K[1];
+          for (int c = 0; c < ORDER; c++) {
+            z = (first[2] + c) % K[2];
+            double phi = grid[(x * K[1] + y) * K[2] + z].real();
+            grad.x += dw[0][a] * w[1][b] * w[2][c] * phi;
+            grad.y += w[0][a] * dw[1][b] * w[2][c] * phi;
+            grad.z += w[0][a] * w[1][b] * dw[2][c] * phi;
+          }
+        }
+      }
+      grad.x *= 2.0 * charge * K[0] / length[0];
+      grad.y *= 2.0 * charge * K[1] / length[1];
+      grad.z *= 2.0 * charge * K[2] / length[2];
+
+      // need to unwrap the atom coordinate
+      atomC = currentCoords.Get(start + p);
+      currentAxes.UnwrapPBC(atomC, box, comC);
+      diffC = atomC - comC;
+
+      wT11 += grad.x * diffC.x;
+      wT22 += grad.y * diffC.y;
+      wT33 += grad.z * diffC.z;
+    }
+    ++thisMol;
+  }
+
+  // set the all tensor values
+  tempVir.recipTens[0][0] = wT11;
+  tempVir.recipTens[0][1] = wT12;
+  tempVir.recipTens[0][2] = wT13;
+
+  tempVir.recipTens[1][0] = wT12;
+  tempVir.recipTens[1][1] = wT22;
+  tempVir.recipTens[1][2] = wT23;
+
+  tempVir.recipTens[2][0] = wT13;
+  tempVir.recipTens[2][1] = wT23;
+  tempVir.recipTens[2][2] = wT33;
+
+  // setting virial of reciprocal cpace
+  tempVir.recip = wT11 + wT22 + wT33;
+
+  return tempVir;
+}
@@ -0,0 +1,193 @@
+/*******************************************************************************
+GPU OPTIMIZED MONTE CARLO (GOMC) 2.40
+Copyright (C) 2018  GOMC Group
+A copy of the GNU General Public License can be found in the COPYRIGHT.txt
+along with this program, also can be found at <http://www.gnu.org/licenses/>.
+********************************************************************************/
+#ifndef EWALDPME_H
+#define EWALDPME_H
+
+#include "Ewald.h"
+#include "FFT3D.h"
+
+//
+//    Smooth particle mesh Ewald (Essmann et al., J. Chem. Phys. 103, 8577)
+//    Charges are spread on a mesh with cardinal B-splines and the
+//    reciprocal energy is E = sum_m G(m) |F(Q)(m)|^2 over the same wave
+//    vectors (|k| < recip_rcut) as Ewald. Equivalently E = Q . (theta * Q)
+//    with theta the real space kernel of G, and phi = theta * Q the mesh
+//    potential.
+//
+//    Moves that change a few molecules only touch the mesh points under
+//    their splines (dQ). The energy change is
+//      dE = 2 dQ . phi + dQ . (theta * dQ)
+//    evaluated on those points only. Accepted dQ are added to Q and kept
+//    in a pending list that corrects phi until the accumulated correction
+//    work exceeds the cost of recomputing phi by FFT.
+//
+//    The mesh spacing is at most PMESpacing, with room for the box to grow
+//    in NPT and GEMC. A box that outgrows it gets a larger mesh. At start
+//    the mesh energy is compared with the Ewald sum to report its error.
+//
+//    Only orthogonal boxes are supported.
+//
+
+//One mesh point touched by a move
+struct MeshPoint {
+  uint index;           //row major index in the mesh
+  uint x, y, z;         //mesh coordinates
+  double charge;
+
+  bool operator<(MeshPoint const& other) const
+  {
+    return index < other.index;
+  }
+};
+
+//Mesh terms of a box, for the box axes it was set up with
+struct PMEMesh {
+  PMEMesh() : energy(0.0) {}
+
+  void swap(PMEMesh& other)
+  {
+    std::swap(axis, other.axis);
+    std::swap(energy, other.energy);
+    influence.swap(other.influence);
+    kernel.swap(other.kernel);
+    charge.swap(other.charge);
+    potential.swap(other.potential);
+  }
+
+  XYZ axis;
+  double energy;
+  std::vector<double> influence;  //G(m), zero for excluded m
+  std::vector<double> kernel;     //theta, real space of G, set on demand
+  std::vector<double> charge;     //Q
+  std::vector<double> potential;  //phi = theta * Q
+};
+
+class EwaldPME : public Ewald
+{
+public:
+
+  EwaldPME(StaticVals & stat, System & sys);
+
+  //Ewald::Init, then report the error of the mesh energy of every box
+  virtual void Init();
+
+  virtual void AllocMem();
+
+  //the mesh can not be restored from the structure factors
+  virtual bool InitFromSums(std::vector<std::vector<double> > const& sumR,
+                            std::vector<std::vector<double> > const& sumI)
+  {
+    return false;
+  }
+  virtual bool GetRecipSums(std::vector<double>& sumR,
+                            std::vector<double>& sumI, uint box) const
+  {
+    return false;
+  }
+
+  //initiliazie the influence function and kernel of the box
+  virtual void RecipInit(uint box, BoxDimensions const& boxAxes);
+
+  //spread the charges and solve the mesh of a box
+  virtual void BoxReciprocalSetup(uint box, XYZArray const& molCoords);
+
+  //calculate reciprocate energy term for a box
+  virtual double BoxReciprocal(uint box) const;
+
+  //calculate reciprocate force term for a box
+  virtual Virial ForceReciprocal(Virial& virial, uint box) const;
+
+  //calculate reciprocate term for displacement and rotation move
+  virtual double MolReciprocal(XYZArray const& molCoords, const uint molIndex,
+                               const uint box);
+
+  //calculate reciprocate term in destination box for swap move
+  virtual double SwapDestRecip(const cbmc::TrialMol &newMol, const uint box,
+                               const int molIndex);
+
+  //calculate reciprocate term in source box for swap move
+  virtual double SwapSourceRecip(const cbmc::TrialMol &oldMol,
+                                 const uint box, const int molIndex);
+
+  //calculate reciprocate term for inserting some molecules (kindA) in
+  //destination box and removing a molecule (kindB) from destination box
+  virtual double SwapRecip(const std::vector<cbmc::TrialMol> &newMol,
+                           const std::vector<cbmc::TrialMol> &oldMol);
+
+  //back up the mesh to Ref (will be called during initialization)
+  virtual void SetRecipRef(uint box);
+
+  //add the accepted mesh change to Ref
+  virtual void UpdateRecip(uint box);
+
+  //swap the mesh set up for the new volume with Ref
+  virtual void UpdateRecipVec(uint box);
+
+  //drop the rejected mesh change
+  virtual void RestoreMol(int molIndex);
+
+  virtual void UpdateVectorsAndRecipTerms();
+
+private:
+  static const int ORDER = 4;     //B-spline order
+
+  //B-spline weights (and derivatives with respect to u, if dw is not
+  //NULL) of the mesh points floor(u) - ORDER + 1 .. floor(u), given the
+  //fraction frac = u - floor(u)
+  static void Weights(double* w, double* dw, const double frac);
+
+  //First mesh point and spline weights on each axis of an atom at pos,
+  //for a box of the given axis lengths
+  void SplineAt(int* first, double (*w)[ORDER], double (*dw)[ORDER],
+                XYZ const& pos, XYZ const& axis, const uint box) const;
+
+  //Append the mesh points of the atoms start..start+length-1 of coords,
+  //with charges of kind times sign
+  void Spread(std::vector<MeshPoint>& points, XYZArray const& coords,
+              const uint start, const uint length, MoleculeKind const& kind,
+              const double sign, XYZ const& axis, const uint box) const;
+
+  //Sort points by index and merge duplicates
+  static void Merge(std::vector<MeshPoint>& points);
+
+  //sum over b of theta(a - b) * charge of b
+  double Convolve(MeshPoint const& a, std::vector<MeshPoint> const& points,
+                  std::vector<double> const& kernel, const uint box) const;
+
+  //Energy change of adding trial[box] to the Ref mesh
+  double TrialEnergy(const uint box);
+
+  //Set the kernel of mesh from its influence function
+  void Kernel(PMEMesh& mesh, const uint box);
+
+  //FFT the charge of mesh and set energy and potential
+  void Solve(PMEMesh& mesh, const uint box);
+
+  //Recompute the potential of the Ref mesh and drop pending changes
+  void Refresh(const uint box);
+
+  //Mesh points needed along a box edge of length
+  uint Points(const uint box, const double length) const;
+
+  //Lay the mesh of box out for a box with the given axis lengths
+  void SetMesh(const uint box, XYZ const& axis);
+
+  //Wave number of mesh index i along axis, for a box edge of length
+  double WaveNumber(const uint i, const uint axis, const uint box,
+                    const double length) const;
+
+  uint meshSize[BOXES_WITH_U_NB][3];
+  FFT3D fft[BOXES_WITH_U_NB];
+  std::vector<double> moduli[BOXES_WITH_U_NB][3];  //|b(m)|^2 on each axis
+  PMEMesh mesh[BOXES_WITH_U_NB], meshRef[BOXES_WITH_U_NB];
+  std::vector<MeshPoint> trial[BOXES_WITH_U_NB];   //dQ of the current move
+  std::vector<MeshPoint> pending[BOXES_WITH_U_NB]; //accepted dQ not in phi
+  double pendingCost[BOXES_WITH_U_NB], refreshCost[BOXES_WITH_U_NB];
+  double excess;  //growth of the box the mesh is laid out for
+};
+
+#endif /*EWALDPME_H*/
@@ -262,83 +262,3 @@ inline void FFParticle::CalcCoulombAdd_1_4(double& en, const double distSq,
     en += qi_qj_Fact * forcefield.scaling_14 / dist;
 }
 
-
-
-//mie potential
-inline double FFParticle::CalcEn(const double distSq,
-                                 const uint kind1, const uint kind2) const
-{
-  if(forcefield.rCutSq < distSq)
-    return 0.0;
-
-  uint index = FlatIndex(kind1, kind2);
-  double rRat2 = sigmaSq[index] / distSq;
-  double rRat4 = rRat2 * rRat2;
-  double attract = rRat4 * rRat2;
-#ifdef MIE_INT_ONLY
-  uint n_ij = n[index];
-  double repulse = num::POW(rRat2, rRat4, attract, n_ij);
-#else
-  double n_ij = n[index];
-  double repulse = pow(sqrt(rRat2), n_ij);
-#endif
-
-  return epsilon_cn[index] * (repulse - attract);
-}
-
-inline double FFParticle::CalcCoulomb(const double distSq,
-                                      const double qi_qj_Fact, const uint b) const
-{
-  if(forcefield.rCutCoulombSq[b] < distSq)
-    return 0.0;
-
-  if(forcefield.ewald) {
-    double dist = sqrt(distSq);
-    double val = forcefield.alpha[b] * dist;
-    return  qi_qj_Fact * erfc(val) / dist;
-  } else {
-    double dist = sqrt(distSq);
-    return  qi_qj_Fact / dist;
-  }
-}
-
-inline double FFParticle::CalcVir(const double distSq,
-                                  const uint kind1, const uint kind2) const
-{
-  if(forcefield.rCutSq < distSq)
-    return 0.0;
-
-  uint index = FlatIndex(kind1, kind2);
-  double rNeg2 = 1.0 / distSq;
-  double rRat2 = rNeg2 * sigmaSq[index];
-  double rRat4 = rRat2 * rRat2;
-  double attract = rRat4 * rRat2;
-#ifdef MIE_INT_ONLY
-  uint n_ij = n[index];
-  double repulse = num::POW(rRat2, rRat4, attract, n_ij);
-#else
-  double n_ij = n[index];
-  double repulse = pow(sqrt(rRat2), n_ij);
-#endif
-
-  //Virial is the derivative of the pressure... mu
-  return epsilon_cn_6[index] * (nOver6[index] * repulse - attract) * rNeg2;
-}
-
-inline double FFParticle::CalcCoulombVir(const double distSq,
-    const double qi_qj, const uint b) const
-{
-  if(forcefield.rCutCoulombSq[b] < distSq)
-    return 0.0;
-
-  if(forcefield.ewald) {
-    double dist = sqrt(distSq);
-    double constValue = 2.0 * forcefield.alpha[b] / sqrt(M_PI);
-    double expConstValue = exp(-1.0 * forcefield.alphaSq[b] * distSq);
-    double temp = 1.0 - erf(forcefield.alpha[b] * dist);
-    return  qi_qj * (temp / dist + constValue * expConstValue) / distSq;
-  } else {
-    double dist = sqrt(distSq);
-    return qi_qj / (distSq * dist);
-  }
-}
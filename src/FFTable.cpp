@@ -0,0 +1,197 @@
+/*******************************************************************************
+GPU OPTIMIZED MONTE CARLO (GOMC) 2.40
+Copyright (C) 2018  GOMC Group
+A copy of the GNU General Public License can be found in the COPYRIGHT.txt
+along with this program, also can be found at <http://www.gnu.org/licenses/>.
+********************************************************************************/
+#include "FFTable.h"
+#include "Forcefield.h" //For cutoffs and FFParticle
+#include "NumLib.h"     //For qqFact
+#include <algorithm>    //For max
+#include <cmath>
+#include <stdio.h>
+
+namespace
+{
+enum Function { LJ_EN, LJ_VIR, COULOMB_EN, COULOMB_VIR };
+
+//One analytic pair function of the flavor, for one kind pair or box
+struct PairFunction {
+  PairFunction(FFParticle const& particles, const Function f,
+               const uint k1, const uint k2, const uint box) :
+    ff(particles), fn(f), kind1(k1), kind2(k2), b(box) {}
+
+  double operator()(const double distSq) const
+  {
+    switch (fn) {
+    case LJ_EN:
+      return ff.CalcEn(distSq, kind1, kind2);
+    case LJ_VIR:
+      return ff.CalcVir(distSq, kind1, kind2);
+    case COULOMB_EN:
+      return ff.CalcCoulomb(distSq, 1.0, b);
+    default:
+      return ff.CalcCoulombVir(distSq, 1.0, b);
+    }
+  }
+
+  FFParticle const& ff;
+  Function fn;
+  uint kind1, kind2, b;
+};
+
+//Clamped cubic spline of f through intervals + 1 evenly spaced knots from
+//x0 to xN, stored per interval as the polynomial in t = (x - knot) / delta
+//at table[8 * interval + part]. The end slopes come from one sided
+//differences of f, since xN is the cutoff and f is zero past it.
+void Tabulate(double* table, const uint part, PairFunction const& f,
+              const double x0, const double xN, const uint intervals)
+{
+  uint n = intervals;
+  double delta = (xN - x0) / n;
+  std::vector<double> y(n + 1), m(n + 1), c(n + 1);
+  for (uint k = 0; k < n; k++)
+    y[k] = f(x0 + k * delta);
+  y[n] = f(xN);
+
+  double eps = 1e-2 * delta;
+  double slope0 = (-3.0 * y[0] + 4.0 * f(x0 + eps) - f(x0 + 2.0 * eps)) /
+                  (2.0 * eps);
+  double slopeN = (3.0 * y[n] - 4.0 * f(xN - eps) + f(xN - 2.0 * eps)) /
+                  (2.0 * eps);
+
+  //second derivatives, tridiagonal system solved by forward elimination
+  //(c holds the modified upper diagonal) and back substitution
+  c[0] = 0.5;
+  m[0] = 3.0 / delta * ((y[1] - y[0]) / delta - slope0);
+  for (uint k = 1; k < n; k++) {
+    double rhs = 6.0 * (y[k + 1] - 2.0 * y[k] + y[k - 1]) / (delta * delta);
+    double diag = 4.0 - c[k - 1];
+    c[k] = 1.0 / diag;
+    m[k] = (rhs - m[k - 1]) / diag;
+  }
+  double rhsN = 6.0 / delta * (slopeN - (y[n] - y[n - 1]) / delta);
+  m[n] = (rhsN - m[n - 1]) / (2.0 - c[n - 1]);
+  for (uint k = n; k-- > 0;)
+    m[k] -= c[k] * m[k + 1];
+
+  double h2 = delta * delta;
+  for (uint k = 0; k < n; k++) {
+    double* p = table + 8 * k + part;
+    p[0] = y[k];
+    p[1] = (y[k + 1] - y[k]) - h2 * (2.0 * m[k] + m[k + 1]) / 6.0;
+    p[2] = 0.5 * h2 * m[k];
+    p[3] = h2 * (m[k + 1] - m[k]) / 6.0;
+  }
+}
+
+//Largest absolute deviation of the spline from f at the middle of the
+//intervals at and above xLow, and the distance it was found at
+void Deviation(double& maxErr, double& maxR, double const* table,
+               const uint part, PairFunction const& f, const double x0,
+               const double delta, const uint intervals, const double xLow)
+{
+  for (uint k = 0; k < intervals; k++) {
+    double x = x0 + (k + 0.5) * delta;
+    if (x < xLow)
+      continue;
+    double const* p = table + 8 * k + part;
+    double spline = p[0] + 0.5 * (p[1] + 0.5 * (p[2] + 0.5 * p[3]));
+    double err = std::fabs(spline - f(x));
+    if (err > maxErr) {
+      maxErr = err;
+      maxR = sqrt(x);
+    }
+  }
+}
+}
+
+void FFTable::Init(FFParticle const& ff, Forcefield const& forcefield,
+                   const uint pointsPerA2)
+{
+  count = ff.NumKinds();
+  xMin = std::max(forcefield.rCutLowSq, 1.0);
+
+  xMaxLJ = forcefield.rCutSq;
+  intervalsLJ = std::max(1u, (uint)ceil((xMaxLJ - xMin) * pointsPerA2));
+  invDeltaLJ = intervalsLJ / (xMaxLJ - xMin);
+
+  pairSlot.resize(count * count);
+  uint slots = 0;
+  for (uint i = 0; i < count; i++) {
+    for (uint j = i; j < count; j++) {
+      pairSlot[i + j * count] = slots;
+      pairSlot[j + i * count] = slots;
+      slots++;
+    }
+  }
+  lj.resize(slots * 8 * intervalsLJ);
+  for (uint i = 0; i < count; i++) {
+    for (uint j = i; j < count; j++) {
+      double* table = &lj[PairOffset(i, j)];
+      Tabulate(table, 0, PairFunction(ff, LJ_EN, i, j, 0), xMin, xMaxLJ,
+               intervalsLJ);
+      Tabulate(table, 4, PairFunction(ff, LJ_VIR, i, j, 0), xMin, xMaxLJ,
+               intervalsLJ);
+    }
+  }
+
+  for (uint b = 0; b < BOX_TOTAL; b++) {
+    intervalsCoulomb[b] = 0;
+    xMaxCoulomb[b] = forcefield.rCutCoulombSq[b];
+    invDeltaCoulomb[b] = 0.0;
+    coulomb[b].clear();
+    if (!forcefield.electrostatic || xMaxCoulomb[b] <= xMin)
+      continue;
+
+    intervalsCoulomb[b] =
+      std::max(1u, (uint)ceil((xMaxCoulomb[b] - xMin) * pointsPerA2));
+    invDeltaCoulomb[b] = intervalsCoulomb[b] / (xMaxCoulomb[b] - xMin);
+    coulomb[b].resize(8 * intervalsCoulomb[b]);
+    Tabulate(&coulomb[b][0], 0, PairFunction(ff, COULOMB_EN, 0, 0, b), xMin,
+             xMaxCoulomb[b], intervalsCoulomb[b]);
+    Tabulate(&coulomb[b][0], 4, PairFunction(ff, COULOMB_VIR, 0, 0, b), xMin,
+             xMaxCoulomb[b], intervalsCoulomb[b]);
+  }
+}
+
+void FFTable::PrintAccuracy(FFParticle const& ff) const
+{
+  //LJ from 0.8 sigma out, closer pairs hardly ever get accepted
+  double enErr = 0.0, enR = 0.0, virErr = 0.0, virR = 0.0;
+  double delta = 1.0 / invDeltaLJ;
+  for (uint i = 0; i < count; i++) {
+    for (uint j = i; j < count; j++) {
+      double const* table = &lj[PairOffset(i, j)];
+      double xLow = 0.64 * ff.GetSigma(i, j) * ff.GetSigma(i, j);
+      Deviation(enErr, enR, table, 0, PairFunction(ff, LJ_EN, i, j, 0), xMin,
+                delta, intervalsLJ, xLow);
+      Deviation(virErr, virR, table, 4, PairFunction(ff, LJ_VIR, i, j, 0),
+                xMin, delta, intervalsLJ, xLow);
+    }
+  }
+  printf("%-40s %-.3e K at %.3f A\n", "Info: Pair table LJ energy error",
+         enErr, enR);
+  printf("%-40s %-.3e K/A^2 at %.3f A\n", "Info: Pair table LJ virial error",
+         virErr, virR);
+
+  for (uint b = 0; b < BOX_TOTAL; b++) {
+    if (coulomb[b].empty())
+      continue;
+    enErr = enR = virErr = virR = 0.0;
+    delta = 1.0 / invDeltaCoulomb[b];
+    Deviation(enErr, enR, &coulomb[b][0], 0,
+              PairFunction(ff, COULOMB_EN, 0, 0, b), xMin, delta,
+              intervalsCoulomb[b], xMin);
+    Deviation(virErr, virR, &coulomb[b][0], 4,
+              PairFunction(ff, COULOMB_VIR, 0, 0, b), xMin, delta,
+              intervalsCoulomb[b], xMin);
+    //for a pair of unit charges
+    char label[64];
+    sprintf(label, "Info: Coulomb table energy error box %u", b);
+    printf("%-40s %-.3e K at %.3f A\n", label, enErr * num::qqFact, enR);
+    sprintf(label, "Info: Coulomb table virial error box %u", b);
+    printf("%-40s %-.3e K/A^2 at %.3f A\n", label, virErr * num::qqFact,
+           virR);
+  }
+}
@@ -0,0 +1,111 @@
+/*******************************************************************************
+GPU OPTIMIZED MONTE CARLO (GOMC) 2.40
+Copyright (C) 2018  GOMC Group
+A copy of the GNU General Public License can be found in the COPYRIGHT.txt
+along with this program, also can be found at <http://www.gnu.org/licenses/>.
+********************************************************************************/
+#ifndef FF_TABLE_H
+#define FF_TABLE_H
+
+#include "EnsemblePreprocessor.h" //For BOX_TOTAL
+#include "BasicTypes.h" //for uint
+#include <vector>
+
+class Forcefield;
+struct FFParticle;
+
+//
+//    FFTable.h
+//    Cubic spline tables in r^2 of the nonbonded pair functions of any
+//    FFParticle flavor, so the intermolecular kernels do not call pow,
+//    erfc and exp for every pair.
+//
+//    The tables are built once from the flavor's own CalcEn/CalcVir (per
+//    kind pair) and CalcCoulomb/CalcCoulombVir (per box, for unit charge,
+//    since they are linear in the charge product). Knots are evenly spaced
+//    in r^2 from max(RcutLow, 1 A)^2 up to the cutoff. Closer pairs are
+//    left to the analytic functions, pairs beyond the cutoff give zero.
+//
+//    Each interval keeps the energy and virial polynomials next to each
+//    other, 8 doubles (one cache line).
+//
+class FFTable
+{
+public:
+  FFTable(void) : count(0), intervalsLJ(0) {}
+
+  //! Build the tables with pointsPerA2 knots per A^2 of r^2
+  void Init(FFParticle const& ff, Forcefield const& forcefield,
+            const uint pointsPerA2);
+
+  //! Prints the largest deviation of the tables from the analytic form
+  void PrintAccuracy(FFParticle const& ff) const;
+
+  //! True if distSq is below the first knot and needs the analytic form
+  bool Below(const double distSq) const
+  {
+    return distSq < xMin;
+  }
+
+  double CalcEn(const double distSq, const uint kind1, const uint kind2) const
+  {
+    if (distSq > xMaxLJ)
+      return 0.0;
+    return Spline(&lj[PairOffset(kind1, kind2)], distSq, invDeltaLJ,
+                  intervalsLJ, 0);
+  }
+  double CalcVir(const double distSq, const uint kind1, const uint kind2) const
+  {
+    if (distSq > xMaxLJ)
+      return 0.0;
+    return Spline(&lj[PairOffset(kind1, kind2)], distSq, invDeltaLJ,
+                  intervalsLJ, 4);
+  }
+  //! Coulomb energy of qi_qj_Fact, as the flavor's CalcCoulomb(Ewald)
+  double CalcCoulomb(const double distSq, const double qi_qj_Fact,
+                     const uint b) const
+  {
+    if (distSq > xMaxCoulomb[b])
+      return 0.0;
+    return qi_qj_Fact * Spline(&coulomb[b][0], distSq, invDeltaCoulomb[b],
+                               intervalsCoulomb[b], 0);
+  }
+  double CalcCoulombVir(const double distSq, const double qi_qj,
+                        const uint b) const
+  {
+    if (distSq > xMaxCoulomb[b])
+      return 0.0;
+    return qi_qj * Spline(&coulomb[b][0], distSq, invDeltaCoulomb[b],
+                          intervalsCoulomb[b], 4);
+  }
+
+private:
+  //Value of the polynomial (part 0 energy, 4 virial) of the interval
+  //holding x
+  double Spline(const double* table, const double x, const double invDelta,
+                const uint intervals, const uint part) const
+  {
+    double t = (x - xMin) * invDelta;
+    uint i = (uint)t;
+    if (i >= intervals)
+      i = intervals - 1;
+    t -= i;
+    const double* c = table + 8 * i + part;
+    return c[0] + t * (c[1] + t * (c[2] + t * c[3]));
+  }
+
+  uint PairOffset(const uint kind1, const uint kind2) const
+  {
+    return pairSlot[kind1 + kind2 * count] * 8 * intervalsLJ;
+  }
+
+  uint count, intervalsLJ, intervalsCoulomb[BOX_TOTAL];
+  double xMin, xMaxLJ, invDeltaLJ;
+  double xMaxCoulomb[BOX_TOTAL], invDeltaCoulomb[BOX_TOTAL];
+  //slot of each kind pair, symmetric pairs share one table
+  std::vector<uint> pairSlot;
+  std::vector<double> lj;
+  std::vector<double> coulomb[BOX_TOTAL];
+};
+
+#endif /*FF_TABLE_H*/
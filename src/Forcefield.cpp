@@ -10,6 +10,7 @@ along with this program, also can be found at <http://www.gnu.org/licenses/>.
 #include "FFShift.h"
 #include "FFSwitch.h"
 #include "FFSwitchMartini.h"
+#include "FFTable.h"
 #ifndef _USE_MATH_DEFINES
 #define _USE_MATH_DEFINES
 #endif
@@ -18,6 +19,7 @@ along with this program, also can be found at <http://www.gnu.org/licenses/>.
 Forcefield::Forcefield()
 {
   particles = NULL;
+  pairTable = NULL;
   angles = NULL;
   OneThree = false; //default behavior is to turn off 1-3 interaction
   OneFour = true;   // to turn on 1-4 interaction
@@ -28,6 +30,8 @@ Forcefield::~Forcefield()
 {
   if(particles != NULL)
     delete particles;
+  if(pairTable != NULL)
+    delete pairTable;
   if( angles != NULL)
     delete angles;
 
@@ -37,11 +41,22 @@ void Forcefield::Init(const Setup& set)
 {
   InitBasicVals(set.config.sys, set.config.in.ffKind);
   particles->Init(set.ff.mie, set.ff.nbfix);
+  if(set.config.sys.ff.pairTable) {
+    pairTable = new FFTable();
+    pairTable->Init(*particles, *this, set.config.sys.ff.tablePoints);
+    pairTable->PrintAccuracy(*particles);
+  }
   bonds.Init(set.ff.bond);
   angles->Init(set.ff.angle);
   dihedrals.Init(set.ff.dih);
 }
 
+void Forcefield::SetTemperature(const double T)
+{
+  T_in_K = T;
+  beta = 1 / T_in_K;
+}
+
 void Forcefield::InitBasicVals(config_setup::SystemVals const& val,
                                config_setup::FFKind const& ffKind)
 {
@@ -60,6 +75,7 @@ void Forcefield::InitBasicVals(config_setup::SystemVals const& val,
   electrostatic = val.elect.enable;
   ewald = val.elect.ewald;
   tolerance = val.elect.tolerance;
+  pmeSpacing = val.elect.pmeSpacing;
   rswitch = val.ff.rswitch;
   dielectric = val.elect.dielectric;
 
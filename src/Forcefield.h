@@ -7,8 +7,10 @@ along with this program, also can be found at <http://www.gnu.org/licenses/>.
 #ifndef FORCEFIELD_H
 #define FORCEFIELD_H
 
+#include "EnsemblePreprocessor.h" //For BOX_TOTAL
+#include "BasicTypes.h" //for uint
+
 //Member classes
-#include "FFParticle.h"
 #include "FFBonds.h"
 #include "FFAngles.h"
 #include "FFDihedrals.h"
@@ -24,6 +26,7 @@ class FFSetup;
 class Setup;
 class FFPrintout;
 class FFParticle;
+class FFTable;
 
 class Forcefield
 {
@@ -35,8 +38,12 @@ public:
   //Initialize contained FFxxxx structs from setup data
   void Init(const Setup& set);
 
+  //Sets the system temperature (K) and beta, e.g. after a replica exchange
+  void SetTemperature(const double T);
+
 
   FFParticle * particles;    //!<For LJ/Mie energy between unbonded atoms
+  FFTable * pairTable;       //!<Spline tables of particles, NULL if not used
   // for LJ, shift and switch type
   FFBonds bonds;                  //!<For bond stretching energy
   FFAngles * angles;              //!<For 3-atom bending energy
@@ -53,6 +60,7 @@ public:
   double recip_rcut[BOX_TOTAL];   //Ewald sum terms
   double recip_rcut_Sq[BOX_TOTAL]; //Ewald sum terms
   double tolerance;               //Ewald sum terms
+  double pmeSpacing;              //Largest PME mesh spacing (angstroms)
   double rswitch;                 //Switch distance
   double dielectric;              //dielectric for martini
   double scaling_14;              //!<Scaling factor for 1-4 pairs' ewald interactions
@@ -75,4 +83,7 @@ private:
 
 };
 
+//FFParticle's inline pair functions need the complete Forcefield
+#include "FFParticle.h"
+
 #endif /*FORCEFIELD_H*/
@@ -0,0 +1,374 @@
+/*******************************************************************************
+GPU OPTIMIZED MONTE CARLO (GOMC) 2.40
+Copyright (C) 2018  GOMC Group
+A copy of the GNU General Public License can be found in the COPYRIGHT.txt
+along with this program, also can be found at <http://www.gnu.org/licenses/>.
+********************************************************************************/
+#include "FrameworkGrid.h"
+#include "Forcefield.h"     //For cutoffs and FFParticle
+#include "Molecules.h"
+#include "MoleculeKind.h"
+#include "MoleculeLookup.h"
+#include "BoxDimensions.h"
+#include "EnergyTypes.h"     //For BOXES_WITH_U_NB
+#include "NumLib.h"         //For qqFact
+#include <algorithm>
+#include <climits>          //For UINT_MAX
+#include <cmath>
+#include <iostream>
+#include <sstream>
+#include <stdio.h>
+
+namespace
+{
+//Grid points closer than this to a fixed atom are always blocked, so that
+//no point holds the diverging energy of an atom center
+const double MIN_DIST_SQ = 0.25;
+
+const char MAGIC[8] = {'G', 'O', 'M', 'C', 'F', 'W', 'G', '1'};
+}
+
+FrameworkGrid::FrameworkGrid(void) : interpolate(true), spacing(0.0), slots(0),
+  ff(NULL), mols(NULL), coords(NULL), dims(NULL)
+{
+  for (uint b = 0; b < BOX_TOTAL; b++) {
+    active[b] = false;
+    fixedLJ[b] = fixedReal[b] = 0.0;
+  }
+}
+
+void FrameworkGrid::Init(Forcefield const& forcefield, Molecules const& mol,
+                         MoleculeLookup const& lookup, XYZArray const& pos,
+                         BoxDimensions const& boxDims, const double space,
+                         const bool interp, std::string const& file)
+{
+  ff = &forcefield;
+  mols = &mol;
+  coords = &pos;
+  dims = &boxDims;
+  spacing = space;
+  interpolate = interp;
+
+  uint kinds = 0;
+  atomKind.clear();
+  atomMol.clear();
+  atomCharge.clear();
+  for (uint m = 0; m < mol.count; m++) {
+    MoleculeKind const& kind = mol.GetKind(m);
+    for (uint a = 0; a < kind.NumAtoms(); a++) {
+      atomKind.push_back(kind.AtomKind(a));
+      atomMol.push_back(m);
+      atomCharge.push_back(kind.AtomCharge(a));
+      kinds = std::max(kinds, kind.AtomKind(a) + 1);
+    }
+  }
+
+  //every atom kind of the mobile molecules gets a slot
+  kindSlot.assign(kinds, UINT_MAX);
+  guestKinds.clear();
+  for (uint m = 0; m < mol.count; m++) {
+    if (lookup.IsFix(m))
+      continue;
+    for (uint a = mol.MolStart(m); a < mol.MolEnd(m); a++) {
+      if (kindSlot[atomKind[a]] == UINT_MAX) {
+        kindSlot[atomKind[a]] = guestKinds.size();
+        guestKinds.push_back(atomKind[a]);
+      }
+    }
+  }
+  slots = guestKinds.size() + 1;
+
+  for (uint b = 0; b < BOXES_WITH_U_NB; b++) {
+    fixedAtom[b].clear();
+    MoleculeLookup::box_iterator thisMol = lookup.BoxBegin(b);
+    MoleculeLookup::box_iterator end = lookup.BoxEnd(b);
+    while (thisMol != end) {
+      if (lookup.IsFix(*thisMol)) {
+        for (uint a = mol.MolStart(*thisMol); a < mol.MolEnd(*thisMol); a++)
+          fixedAtom[b].push_back(a);
+      }
+      ++thisMol;
+    }
+    active[b] = !fixedAtom[b].empty() && !guestKinds.empty();
+    if (!active[b])
+      continue;
+
+    std::string name;
+    if (!file.empty()) {
+      std::stringstream ss;
+      ss << file << "_BOX_" << b << ".grid";
+      name = ss.str();
+    }
+    if (!name.empty() && Read(name, b)) {
+      printf("%s %-d %-27s %s\n", "Info: Box ", b, " Framework grid read from",
+             name.c_str());
+    } else {
+      Build(b);
+      if (!name.empty())
+        Write(name, b);
+    }
+    printf("%s %-d %-27s %u x %u x %u\n", "Info: Box ", b,
+           " Framework grid points", grid[b].n[0], grid[b].n[1], grid[b].n[2]);
+  }
+}
+
+void FrameworkGrid::Build(const uint box)
+{
+  BoxGrid& g = grid[box];
+  FFParticle const& particles = *ff->particles;
+  XYZ axis = dims->GetAxis(box);
+  double ax[3] = {axis.x, axis.y, axis.z};
+  double rCutSq = dims->rCutSq[box];
+  double blockSq = std::max(ff->rCutLowSq, MIN_DIST_SQ);
+  uint cells[3];
+  for (uint a = 0; a < 3; a++) {
+    g.n[a] = std::max((uint)ceil(ax[a] / spacing), 1u);
+    cells[a] = std::max((uint)(ax[a] / dims->rCut[box]), 1u);
+  }
+
+  //bin the fixed atoms into cells at least a cutoff wide
+  std::vector<std::vector<uint> > cellAtoms(cells[0] * cells[1] * cells[2]);
+  for (uint i = 0; i < fixedAtom[box].size(); i++) {
+    uint atom = fixedAtom[box][i];
+    XYZ u = dims->TransformUnSlant(dims->WrapPBC((*coords)[atom], box), box);
+    double f[3] = {u.x / ax[0], u.y / ax[1], u.z / ax[2]};
+    uint c[3];
+    for (uint a = 0; a < 3; a++)
+      c[a] = std::min((uint)(std::max(f[a], 0.0) * cells[a]), cells[a] - 1);
+    cellAtoms[(c[0] * cells[1] + c[1]) * cells[2] + c[2]].push_back(atom);
+  }
+
+  //cells around each cell, without repeats for boxes only a few cells wide
+  std::vector<std::vector<uint> > around(cellAtoms.size());
+  for (uint x = 0; x < cells[0]; x++) {
+    for (uint y = 0; y < cells[1]; y++) {
+      for (uint z = 0; z < cells[2]; z++) {
+        std::vector<uint>& list = around[(x * cells[1] + y) * cells[2] + z];
+        for (int dx = -1; dx <= 1; dx++) {
+          for (int dy = -1; dy <= 1; dy++) {
+            for (int dz = -1; dz <= 1; dz++) {
+              list.push_back((((x + dx + cells[0]) % cells[0]) * cells[1] +
+                              (y + dy + cells[1]) % cells[1]) * cells[2] +
+                             (z + dz + cells[2]) % cells[2]);
+            }
+          }
+        }
+        std::sort(list.begin(), list.end());
+        list.erase(std::unique(list.begin(), list.end()), list.end());
+      }
+    }
+  }
+
+  int points = g.n[0] * g.n[1] * g.n[2];
+  g.value.assign((size_t)points * slots, 0.0);
+  g.blocked.assign(points, 0);
+
+#ifdef _OPENMP
+  #pragma omp parallel for default(shared) schedule(dynamic, 64)
+#endif
+  for (int p = 0; p < points; p++) {
+    uint i = p / (g.n[1] * g.n[2]);
+    uint j = (p / g.n[2]) % g.n[1];
+    uint k = p % g.n[2];
+    XYZ pos = dims->TransformSlant(XYZ(i * ax[0] / g.n[0], j * ax[1] / g.n[1],
+                                       k * ax[2] / g.n[2]), box);
+    uint cell = ((i * cells[0] / g.n[0]) * cells[1] + j * cells[1] / g.n[1]) *
+                cells[2] + k * cells[2] / g.n[2];
+    double *v = &g.value[(size_t)p * slots];
+    bool blocked = false;
+
+    for (uint c = 0; c < around[cell].size() && !blocked; c++) {
+      std::vector<uint> const& list = cellAtoms[around[cell][c]];
+      for (uint n = 0; n < list.size(); n++) {
+        uint atom = list[n];
+        double distSq = dims->MinImage(pos - (*coords)[atom], box).LengthSq();
+        if (distSq < blockSq) {
+          blocked = true;
+          break;
+        }
+        if (rCutSq > distSq) {
+          for (uint s = 0; s < guestKinds.size(); s++)
+            v[s] += particles.CalcEn(distSq, guestKinds[s], atomKind[atom]);
+          if (ff->electrostatic) {
+            v[slots - 1] += particles.CalcCoulomb(distSq, atomCharge[atom] *
+                                                  num::qqFact, box);
+          }
+        }
+      }
+    }
+
+    if (blocked) {
+      g.blocked[p] = 1;
+      std::fill(v, v + slots, 0.0);
+    }
+  }
+
+  //pairs between fixed molecules, each once
+  double lj = 0.0, real = 0.0;
+  for (uint c = 0; c < cellAtoms.size(); c++) {
+    for (uint n1 = 0; n1 < cellAtoms[c].size(); n1++) {
+      uint a1 = cellAtoms[c][n1];
+      for (uint d = 0; d < around[c].size(); d++) {
+        std::vector<uint> const& list = cellAtoms[around[c][d]];
+        for (uint n2 = 0; n2 < list.size(); n2++) {
+          uint a2 = list[n2];
+          if (a2 <= a1 || atomMol[a1] == atomMol[a2])
+            continue;
+          double distSq = dims->MinImage((*coords)[a1] - (*coords)[a2],
+                                         box).LengthSq();
+          if (rCutSq > distSq) {
+            lj += particles.CalcEn(distSq, atomKind[a1], atomKind[a2]);
+            if (ff->electrostatic) {
+              real += particles.CalcCoulomb(distSq, atomCharge[a1] *
+                                            atomCharge[a2] * num::qqFact, box);
+            }
+          }
+        }
+      }
+    }
+  }
+  fixedLJ[box] = lj;
+  fixedReal[box] = real;
+}
+
+bool FrameworkGrid::Energy(double& lj, double& coulomb, XYZ const& pos,
+                           const uint kind, const uint box) const
+{
+  BoxGrid const& g = grid[box];
+  XYZ u = dims->TransformUnSlant(pos, box);
+  XYZ axis = dims->GetAxis(box);
+  double f[3] = {u.x / axis.x * g.n[0], u.y / axis.y * g.n[1],
+                 u.z / axis.z * g.n[2]
+                };
+  uint lo[3], hi[3];
+  double t[3];
+  for (uint a = 0; a < 3; a++) {
+    double fl = floor(f[a]);
+    long i = (long)fl % (long)g.n[a];
+    if (i < 0)
+      i += g.n[a];
+    t[a] = f[a] - fl;
+    lo[a] = i;
+    hi[a] = (i + 1) % g.n[a];
+  }
+  uint slot = kindSlot[kind];
+
+  if (!interpolate) {
+    uint p = Point(box, t[0] < 0.5 ? lo[0] : hi[0], t[1] < 0.5 ? lo[1] : hi[1],
+                   t[2] < 0.5 ? lo[2] : hi[2]);
+    lj = g.value[(size_t)p * slots + slot];
+    coulomb = g.value[(size_t)p * slots + slots - 1];
+    return g.blocked[p] != 0;
+  }
+
+  bool overlap = false;
+  lj = 0.0;
+  coulomb = 0.0;
+  for (uint c = 0; c < 8; c++) {
+    double w = ((c & 4) ? t[0] : 1.0 - t[0]) * ((c & 2) ? t[1] : 1.0 - t[1]) *
+               ((c & 1) ? t[2] : 1.0 - t[2]);
+    uint p = Point(box, (c & 4) ? hi[0] : lo[0], (c & 2) ? hi[1] : lo[1],
+                   (c & 1) ? hi[2] : lo[2]);
+    overlap |= (g.blocked[p] != 0);
+    lj += w * g.value[(size_t)p * slots + slot];
+    coulomb += w * g.value[(size_t)p * slots + slots - 1];
+  }
+  return overlap;
+}
+
+double FrameworkGrid::Fingerprint(const uint box) const
+{
+  FFParticle const& particles = *ff->particles;
+  std::vector<uint> kinds;
+  double sum = dims->rCutSq[box] + ff->rCutLowSq + spacing;
+
+  for (uint i = 0; i < fixedAtom[box].size(); i++) {
+    uint atom = fixedAtom[box][i];
+    XYZ r = (*coords)[atom];
+    sum += (i + 1) * (r.x + 2.0 * r.y + 3.0 * r.z + atomCharge[atom]) +
+           atomKind[atom];
+    kinds.push_back(atomKind[atom]);
+  }
+  std::sort(kinds.begin(), kinds.end());
+  kinds.erase(std::unique(kinds.begin(), kinds.end()), kinds.end());
+  for (uint g = 0; g < guestKinds.size(); g++) {
+    for (uint k = 0; k < kinds.size(); k++) {
+      sum += particles.CalcEn(9.0, guestKinds[g], kinds[k]) +
+             particles.CalcEn(16.0, guestKinds[g], kinds[k]);
+    }
+  }
+  if (ff->electrostatic)
+    sum += particles.CalcCoulomb(9.0, 1.0, box);
+  return sum;
+}
+
+bool FrameworkGrid::Read(std::string const& name, const uint box)
+{
+  FILE *file = fopen(name.c_str(), "rb");
+  if (file == NULL)
+    return false;
+
+  BoxGrid& g = grid[box];
+  XYZ axis = dims->GetAxis(box);
+  double ax[3] = {axis.x, axis.y, axis.z};
+  char magic[8];
+  uint n[3], fileSlots;
+  double print, lj, real;
+  std::vector<uint> kinds(guestKinds.size());
+  bool ok = fread(magic, 1, 8, file) == 8 &&
+            std::equal(magic, magic + 8, MAGIC) &&
+            fread(n, sizeof(uint), 3, file) == 3 &&
+            fread(&fileSlots, sizeof(uint), 1, file) == 1 &&
+            fileSlots == slots;
+  for (uint a = 0; a < 3 && ok; a++)
+    ok = n[a] == std::max((uint)ceil(ax[a] / spacing), 1u);
+  ok = ok && fread(&kinds[0], sizeof(uint), kinds.size(), file) ==
+       kinds.size() && kinds == guestKinds &&
+       fread(&print, sizeof(double), 1, file) == 1 &&
+       fabs(print - Fingerprint(box)) <= 1e-10 * std::max(fabs(print), 1.0) &&
+       fread(&lj, sizeof(double), 1, file) == 1 &&
+       fread(&real, sizeof(double), 1, file) == 1;
+
+  if (ok) {
+    size_t points = (size_t)n[0] * n[1] * n[2];
+    g.value.resize(points * slots);
+    g.blocked.resize(points);
+    ok = fread(&g.value[0], sizeof(double), g.value.size(), file) ==
+         g.value.size() &&
+         fread(&g.blocked[0], 1, points, file) == points;
+  }
+  fclose(file);
+
+  if (!ok) {
+    printf("%-40s %-s \n", "Info: Framework grid does not match",
+           name.c_str());
+    return false;
+  }
+  std::copy(n, n + 3, g.n);
+  fixedLJ[box] = lj;
+  fixedReal[box] = real;
+  return true;
+}
+
+void FrameworkGrid::Write(std::string const& name, const uint box) const
+{
+  FILE *file = fopen(name.c_str(), "wb");
+  if (file == NULL) {
+    std::cout << "Warning: Could not write the framework grid to " << name
+              << "!\n";
+    return;
+  }
+
+  BoxGrid const& g = grid[box];
+  double print = Fingerprint(box);
+  fwrite(MAGIC, 1, 8, file);
+  fwrite(g.n, sizeof(uint), 3, file);
+  fwrite(&slots, sizeof(uint), 1, file);
+  fwrite(&guestKinds[0], sizeof(uint), guestKinds.size(), file);
+  fwrite(&print, sizeof(double), 1, file);
+  fwrite(&fixedLJ[box], sizeof(double), 1, file);
+  fwrite(&fixedReal[box], sizeof(double), 1, file);
+  fwrite(&g.value[0], sizeof(double), g.value.size(), file);
+  fwrite(&g.blocked[0], 1, g.blocked.size(), file);
+  fclose(file);
+}
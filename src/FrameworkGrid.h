@@ -0,0 +1,119 @@
+/*******************************************************************************
+GPU OPTIMIZED MONTE CARLO (GOMC) 2.40
+Copyright (C) 2018  GOMC Group
+A copy of the GNU General Public License can be found in the COPYRIGHT.txt
+along with this program, also can be found at <http://www.gnu.org/licenses/>.
+********************************************************************************/
+#ifndef FRAMEWORK_GRID_H
+#define FRAMEWORK_GRID_H
+
+#include "EnsemblePreprocessor.h" //For BOX_TOTAL
+#include "BasicTypes.h" //for uint
+#include "XYZArray.h"
+#include <string>
+#include <vector>
+
+class Forcefield;
+class Molecules;
+class MoleculeLookup;
+class BoxDimensions;
+
+//
+//    FrameworkGrid.h
+//    Energy grids of the fixed molecules (beta 1) of a box, for adsorption
+//    in rigid frameworks. For every atom kind of the mobile molecules the
+//    LJ energy of all fixed atoms is tabulated on a periodic grid over the
+//    box, plus the real space Coulomb potential for unit charge, so a
+//    guest atom costs one grid lookup instead of a pass over the
+//    framework atoms around it.
+//
+//    With the grid active the fixed molecules are left out of the cell
+//    list of that box, the guest-framework pairs come from the grid and
+//    the framework-framework energy, which never changes, is summed once.
+//    The pair virial (pressure) then only covers the guest-guest pairs.
+//    Points within RcutLow of a fixed atom are blocked and count as an
+//    overlap. Lookups are trilinear between the 8 points around an atom,
+//    or take the nearest point.
+//
+//    Building a grid is costly, so it can be written to a file and read
+//    back by later runs, as long as the box, the framework, the guest
+//    kinds and the force field parameters still match.
+//
+class FrameworkGrid
+{
+public:
+  FrameworkGrid(void);
+
+  //! Builds (or reads from file) the grid of every box with fixed molecules
+  //! at spacing A between points. file is the prefix of the grid files,
+  //! empty to always build.
+  void Init(Forcefield const& forcefield, Molecules const& mols,
+            MoleculeLookup const& lookup, XYZArray const& coords,
+            BoxDimensions const& dims, const double spacing,
+            const bool interpolate, std::string const& file);
+
+  bool Active(const uint box) const
+  {
+    return active[box];
+  }
+
+  //! LJ energy of an atom of kind at pos due to the fixed molecules of box
+  //! and their real space Coulomb energy per unit charge. Returns true if
+  //! pos is on a blocked point.
+  bool Energy(double& lj, double& coulomb, XYZ const& pos, const uint kind,
+              const uint box) const;
+
+  //! LJ and real space energies between the fixed molecules of box
+  double FixedLJ(const uint box) const
+  {
+    return fixedLJ[box];
+  }
+  double FixedReal(const uint box) const
+  {
+    return fixedReal[box];
+  }
+
+private:
+  //Grid points of one box, point-major with slots values per point (one
+  //per guest kind, then the Coulomb potential)
+  struct BoxGrid {
+    uint n[3];
+    std::vector<double> value;
+    std::vector<char> blocked;
+  };
+
+  void Build(const uint box);
+  bool Read(std::string const& name, const uint box);
+  void Write(std::string const& name, const uint box) const;
+
+  //Checksum of the framework and the force field the grid is built from
+  double Fingerprint(const uint box) const;
+
+  uint Point(const uint box, const uint i, const uint j, const uint k) const
+  {
+    return (i * grid[box].n[1] + j) * grid[box].n[2] + k;
+  }
+
+  bool active[BOX_TOTAL];
+  bool interpolate;
+  double spacing;
+  double fixedLJ[BOX_TOTAL], fixedReal[BOX_TOTAL];
+  BoxGrid grid[BOX_TOTAL];
+
+  //slot of each atom kind in the grid, UINT_MAX if no mobile atom has it
+  std::vector<uint> kindSlot;
+  std::vector<uint> guestKinds;
+  uint slots;
+
+  //fixed atoms of each box with their kind, charge and molecule
+  std::vector<uint> fixedAtom[BOX_TOTAL];
+
+  Forcefield const* ff;
+  Molecules const* mols;
+  XYZArray const* coords;
+  BoxDimensions const* dims;
+  std::vector<uint> atomKind, atomMol;
+  std::vector<double> atomCharge;
+};
+
+#endif /*FRAMEWORK_GRID_H*/
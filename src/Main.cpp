@@ -5,6 +5,7 @@ A copy of the GNU General Public License can be found in the COPYRIGHT.txt
 along with this program, also can be found at <http://www.gnu.org/licenses/>.
 ********************************************************************************/
 #include "Simulation.h"
+#include "ReplicaExchange.h"
 #include "GOMC_Config.h"    //For version number
 #ifdef GOMC_CUDA
 #include "cuda.h"
@@ -85,6 +86,8 @@ int main(int argc, char *argv[])
     //SET NUMBER OF THREADS
 #ifdef _OPENMP
     omp_set_num_threads(numThreads);
+    //boxes evaluated at the same time open nested teams (see Parallel.h)
+    omp_set_max_active_levels(2);
     printf("%-40s %-d \n", "Info: Number of threads", numThreads);
 #else
     printf("%-40s %-d \n", "Info: Number of threads", 1);
@@ -105,8 +108,13 @@ int main(int argc, char *argv[])
 
     //ONCE FILE FOUND PASS STRING TO SIMULATION CLASS TO READ AND
     //HANDLE PDB|PSF FILE
-    Simulation sim(inputFileString.c_str());
-    sim.RunSimulation();
+    if(ReplicaExchange::Requested(inputFileString.c_str())) {
+      ReplicaExchange rex(inputFileString.c_str());
+      rex.Run();
+    } else {
+      Simulation sim(inputFileString.c_str());
+      sim.RunSimulation();
+    }
     PrintSimulationFooter();
   }
   return 0;
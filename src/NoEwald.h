@@ -19,6 +19,18 @@ public:
 
   virtual void Init();
 
+  //no reciprocal terms to save
+  virtual bool InitFromSums(std::vector<std::vector<double> > const& sumR,
+                            std::vector<std::vector<double> > const& sumI)
+  {
+    return false;
+  }
+  virtual bool GetRecipSums(std::vector<double>& sumR,
+                            std::vector<double>& sumI, uint box) const
+  {
+    return false;
+  }
+
   virtual void AllocMem();
 
   //initiliazie term used for ewald calculation
@@ -33,6 +45,11 @@ public:
   //calculate reciprocate energy term for a box
   virtual double BoxReciprocal(uint box) const;
 
+  virtual uint ImageSize(uint box) const
+  {
+    return 0;
+  }
+
   //calculate reciprocate force term for a box
   virtual Virial ForceReciprocal(Virial& virial, uint box) const;
 
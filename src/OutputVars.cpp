@@ -15,14 +15,13 @@ along with this program, also can be found at <http://www.gnu.org/licenses/>.
 #endif
 
 OutputVars::OutputVars(System & sys, StaticVals const& statV) :
-  calc(sys.calcEnergy)
+  T_in_K(statV.forcefield.T_in_K), calc(sys.calcEnergy)
 {
   InitRef(sys, statV);
 }
 
 void OutputVars::InitRef(System & sys, StaticVals const& statV)
 {
-  T_in_K = statV.forcefield.T_in_K;
   volumeRef = sys.boxDimRef.volume;
   axisRef = &sys.boxDimRef.axis;
   volInvRef = sys.boxDimRef.volInv;
@@ -36,6 +35,7 @@ void OutputVars::InitRef(System & sys, StaticVals const& statV)
   movePercRef = statV.movePerc;
   pCalcFreq = statV.simEventFreq.pCalcFreq;
   pressureCalc = statV.simEventFreq.pressureCalc;
+  virialFullFreq = statV.simEventFreq.virialFullFreq;
 
   virial = new Virial[BOXES_WITH_U_NB];
 }
@@ -123,7 +123,12 @@ void OutputVars::CalcAndConvert(ulong step)
 
     if (pressureCalc) {
       if((step + 1) % pCalcFreq == 0) {
-        virialRef[b] = calc.ForceCalc(b);
+        //with virial tracking the moves keep the pair virial, it is only
+        //recalculated every virialFullFreq steps to remove the drift
+        if(calc.TrackVirial() && (step + 1) % virialFullFreq != 0)
+          virialRef[b] = calc.ForceUpdate(virialRef[b], b);
+        else
+          virialRef[b] = calc.ForceCalc(b);
         *virialTotRef += virialRef[b];
       }
     }
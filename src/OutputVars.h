@@ -43,12 +43,12 @@ public:
          pressure[BOXES_WITH_U_NB], densityTot[BOX_TOTAL];
   double pressureTens[BOXES_WITH_U_NB][3][3];
   double surfaceTens[BOXES_WITH_U_NB];
-  ulong pCalcFreq;
+  ulong pCalcFreq, virialFullFreq;
   bool pressureCalc;
 
   uint numKinds;
   //Constants
-  double T_in_K;
+  double const& T_in_K; //of the forcefield, which replica exchange changes
 
   //References
   double * volumeRef;
@@ -14,6 +14,7 @@ along with this program, also can be found at <http://www.gnu.org/licenses/>.
 #include "MoveConst.h"
 #include <stdlib.h> //for exit
 #include <string> // for to_string
+#include <fstream> //for the frame index file
 
 #if BOX_TOTAL == 1
 const std::string PDBSetup::pdbAlias[] = {"system PDB coordinate file"};
@@ -23,6 +24,19 @@ const std::string PDBSetup::pdbAlias[] = {"box 0 PDB coordinate file",
                                          };
 #endif
 
+namespace
+{
+//Size of a file in bytes, -1 if it can not be opened
+long long FileSize(std::string const& name)
+{
+  std::ifstream file(name.c_str(), std::ios::in | std::ios::binary);
+  if(!file.is_open())
+    return -1;
+  file.seekg(0, std::ios::end);
+  return (long long)std::streamoff(file.tellg());
+}
+}
+
 namespace pdb_setup
 {
 void Remarks::SetRestart(config_setup::RestartSettings const& r )
@@ -210,8 +224,23 @@ void PDBSetup::Init(config_setup::RestartSettings const& restart,
     } else {
       alias = pdbAlias[b];
     }
+    if(binaryCoord[b].Init(name[b], b)) {
+      if(!remarks.recalcTrajectory) {
+        std::cout << "Error: Binary coordinate file " << name[b]
+                  << " can only be used to recalculate a trajectory!"
+                  << std::endl;
+        exit(EXIT_FAILURE);
+      }
+      binaryCoord[b].ReadFrame(frameNum, atoms, cryst, remarks);
+      continue;
+    }
     FixedWidthReader pdb(name[b], alias);
     pdb.open();
+    //Jump straight to the frame if GetFrameSteps indexed the file
+    if(remarks.recalcTrajectory && frameNum > 0 &&
+        frameNum <= frameOffset[b].size()) {
+      pdb.file.seekg(frameOffset[b][frameNum - 1]);
+    }
     while (pdb.Read(varName, pdb_entry::label::POS)) {
       //If end of frame, and this is the frame we wanted,
       //end read on this file
@@ -239,21 +268,82 @@ void PDBSetup::Init(config_setup::RestartSettings const& restart,
   }
 }
 
-std::vector<ulong> PDBSetup::GetFrameSteps(std::string const*const name)
+std::vector<ulong> PDBSetup::GetFrameSteps(std::string const*const name,
+                                           const bool indexFile)
 {
-  map<string, FWReadableBase *>::const_iterator dataKind;
-  remarks.SetBox(mv::BOX0);
-  FixedWidthReader pdb(name[mv::BOX0], pdbAlias[mv::BOX0]);
-  pdb.open();
-  std::string varName;
-  uint count = 0;
-  while (pdb.Read(varName, pdb_entry::label::POS)) {
-    if(varName == pdb_entry::label::REMARK) {
-      dataKind = dataKinds.find(varName);
-      dataKind->second->Read(pdb);
-      remarks.frameSteps.push_back(remarks.step[mv::BOX0]);
-      count++;
+  remarks.frameSteps.clear();
+  for (uint b = 0; b < BOX_TOTAL; b++) {
+    std::vector<ulong> steps;
+    if(binaryCoord[b].Init(name[b], b)) {
+      //binary files are indexed when they are opened
+      steps = binaryCoord[b].FrameSteps();
+    } else if(!indexFile || !ReadFrameIndex(name[b], b, steps)) {
+      //One pass over the file, remembering where each frame starts
+      frameOffset[b].clear();
+      remarks.SetBox(b);
+      FixedWidthReader pdb(name[b], pdbAlias[b]);
+      pdb.open();
+      std::string varName;
+      std::streampos lineStart = pdb.file.tellg();
+      while (pdb.Read(varName, pdb_entry::label::POS)) {
+        if(varName == pdb_entry::label::REMARK) {
+          remarks.Read(pdb);
+          frameOffset[b].push_back(lineStart);
+          steps.push_back(remarks.step[b]);
+        }
+        lineStart = pdb.file.tellg();
+      }
+      pdb.close();
+      if(indexFile)
+        WriteFrameIndex(name[b], b, steps);
     }
+    if(b == mv::BOX0)
+      remarks.frameSteps = steps;
   }
   return remarks.frameSteps;
+}
+
+bool PDBSetup::ReadFrameIndex(std::string const& name, const uint b,
+                              std::vector<ulong>& steps)
+{
+  std::ifstream index((name + ".idx").c_str());
+  std::string tag;
+  long long size, offset;
+  ulong frames, step;
+  if(!(index >> tag >> size >> frames) || tag != "GOMC_FRAME_INDEX" ||
+      size != FileSize(name)) {
+    return false;
+  }
+
+  frameOffset[b].clear();
+  steps.clear();
+  for(ulong f = 0; f < frames; f++) {
+    if(!(index >> offset >> step)) {
+      frameOffset[b].clear();
+      steps.clear();
+      return false;
+    }
+    frameOffset[b].push_back(std::streampos(offset));
+    steps.push_back(step);
+  }
+  std::cout << "Read trajectory frame index " << name << ".idx" << std::endl;
+  return true;
+}
+
+void PDBSetup::WriteFrameIndex(std::string const& name, const uint b,
+                               std::vector<ulong> const& steps) const
+{
+  std::ofstream index((name + ".idx").c_str());
+  if(!index.is_open()) {
+    std::cout << "Warning: Could not write trajectory frame index "
+              << name << ".idx" << std::endl;
+    return;
+  }
+
+  index << "GOMC_FRAME_INDEX " << FileSize(name) << " "
+        << frameOffset[b].size() << std::endl;
+  for(uint f = 0; f < frameOffset[b].size(); f++) {
+    index << (long long)std::streamoff(frameOffset[b][f]) << " "
+          << steps[f] << std::endl;
+  }
 }
\ No newline at end of file
@@ -9,9 +9,11 @@ along with this program, also can be found at <http://www.gnu.org/licenses/>.
 
 #include <vector>
 #include <map> //for function lookup table.
+#include <fstream> //for std::streampos
 
 #include "InputAbstracts.h" //For FWReadableBase
 #include "BasicTypes.h" //For uint
+#include "BinaryCoordSetup.h" //For binary trajectory frames
 #include "EnsemblePreprocessor.h" //For BOX_TOTAL, etc.
 #include "PDBConst.h" //For fields positions, etc.
 #include "XYZArray.h" //For box dimensions.
@@ -114,8 +116,23 @@ struct PDBSetup {
   PDBSetup(void) : dataKinds(SetReadFunctions()) {}
   void Init(config_setup::RestartSettings const& restart,
             std::string const*const name, uint frameNumber = 1);
-  std::vector<ulong> GetFrameSteps(std::string const*const name);
+  //Returns the step of each frame and indexes where the frames start in
+  //every box file, so Init can seek to them. With indexFile, the index is
+  //read from (or saved to) a "<pdb name>.idx" file next to each PDB.
+  std::vector<ulong> GetFrameSteps(std::string const*const name,
+                                   const bool indexFile = false);
 private:
+  //Load the index of a box file, false if missing or out of date
+  bool ReadFrameIndex(std::string const& name, const uint b,
+                      std::vector<ulong>& steps);
+  void WriteFrameIndex(std::string const& name, const uint b,
+                       std::vector<ulong> const& steps) const;
+
+  //byte offset of the REMARK line of each frame, per box file
+  std::vector<std::streampos> frameOffset[BOX_TOTAL];
+  //box files that are binary coordinate trajectories instead of PDB
+  BinaryCoordSetup binaryCoord[BOX_TOTAL];
+
   //Map variable names to functions
   std::map<std::string, FWReadableBase *>  SetReadFunctions(void)
   {
@@ -0,0 +1,118 @@
+/*******************************************************************************
+GPU OPTIMIZED MONTE CARLO (GOMC) 2.40
+Copyright (C) 2018  GOMC Group
+A copy of the GNU General Public License can be found in the COPYRIGHT.txt
+along with this program, also can be found at <http://www.gnu.org/licenses/>.
+********************************************************************************/
+#include "PairBatch.h"
+#include "BoxDimensions.h"
+#include "XYZArray.h"
+
+//Let the compiler emit one clone per instruction set and dispatch on CPUID
+#if defined(__GNUC__) && !defined(__clang__) && defined(__x86_64__) && \
+    defined(__linux__)
+#define BATCH_CLONES __attribute__((target_clones("avx512f", "avx2", "default")))
+#else
+#define BATCH_CLONES
+#endif
+
+namespace
+{
+//Same branches as BoxDimensions::MinImageSigned, written as selects
+BATCH_CLONES
+void OrthPairDist(double* dx, double* dy, double* dz, double* distSq,
+                  const double* x1, const double* y1, const double* z1,
+                  const uint* i, const double* x2, const double* y2,
+                  const double* z2, const uint* j, const uint count,
+                  const double ax, const double ay, const double az,
+                  const double hx, const double hy, const double hz)
+{
+#ifdef _OPENMP
+  #pragma omp simd
+#endif
+  for (uint k = 0; k < count; k++) {
+    double x = x1[i[k]] - x2[j[k]];
+    double y = y1[i[k]] - y2[j[k]];
+    double z = z1[i[k]] - z2[j[k]];
+    x = (x > hx ? x - ax : (x < -hx ? x + ax : x));
+    y = (y > hy ? y - ay : (y < -hy ? y + ay : y));
+    z = (z > hz ? z - az : (z < -hz ? z + az : z));
+    dx[k] = x;
+    dy[k] = y;
+    dz[k] = z;
+    distSq[k] = x * x + y * y + z * z;
+  }
+}
+
+BATCH_CLONES
+void OrthAtomDist(double* dx, double* dy, double* dz, double* distSq,
+                  const double x1, const double y1, const double z1,
+                  const double* x2, const double* y2, const double* z2,
+                  const uint* j, const uint count,
+                  const double ax, const double ay, const double az,
+                  const double hx, const double hy, const double hz)
+{
+#ifdef _OPENMP
+  #pragma omp simd
+#endif
+  for (uint k = 0; k < count; k++) {
+    double x = x1 - x2[j[k]];
+    double y = y1 - y2[j[k]];
+    double z = z1 - z2[j[k]];
+    x = (x > hx ? x - ax : (x < -hx ? x + ax : x));
+    y = (y > hy ? y - ay : (y < -hy ? y + ay : y));
+    z = (z > hz ? z - az : (z < -hz ? z + az : z));
+    dx[k] = x;
+    dy[k] = y;
+    dz[k] = z;
+    distSq[k] = x * x + y * y + z * z;
+  }
+}
+}
+
+namespace batch
+{
+void PairDist(double* dx, double* dy, double* dz, double* distSq,
+              BoxDimensions const& boxAxes, XYZArray const& arr1,
+              const uint* i, XYZArray const& arr2, const uint* j,
+              const uint count, const uint b)
+{
+  if (boxAxes.orthogonal[b]) {
+    OrthPairDist(dx, dy, dz, distSq, arr1.x, arr1.y, arr1.z, i,
+                 arr2.x, arr2.y, arr2.z, j, count,
+                 boxAxes.axis.x[b], boxAxes.axis.y[b], boxAxes.axis.z[b],
+                 boxAxes.halfAx.x[b], boxAxes.halfAx.y[b], boxAxes.halfAx.z[b]);
+    return;
+  }
+
+  for (uint k = 0; k < count; k++) {
+    XYZ dist = boxAxes.MinImage(arr1.Difference(i[k], arr2, j[k]), b);
+    dx[k] = dist.x;
+    dy[k] = dist.y;
+    dz[k] = dist.z;
+    distSq[k] = dist.x * dist.x + dist.y * dist.y + dist.z * dist.z;
+  }
+}
+
+void AtomDist(double* dx, double* dy, double* dz, double* distSq,
+              BoxDimensions const& boxAxes, XYZArray const& arr1,
+              const uint i, XYZArray const& arr2, const uint* j,
+              const uint count, const uint b)
+{
+  if (boxAxes.orthogonal[b]) {
+    OrthAtomDist(dx, dy, dz, distSq, arr1.x[i], arr1.y[i], arr1.z[i],
+                 arr2.x, arr2.y, arr2.z, j, count,
+                 boxAxes.axis.x[b], boxAxes.axis.y[b], boxAxes.axis.z[b],
+                 boxAxes.halfAx.x[b], boxAxes.halfAx.y[b], boxAxes.halfAx.z[b]);
+    return;
+  }
+
+  for (uint k = 0; k < count; k++) {
+    XYZ dist = boxAxes.MinImage(arr1.Difference(i, arr2, j[k]), b);
+    dx[k] = dist.x;
+    dy[k] = dist.y;
+    dz[k] = dist.z;
+    distSq[k] = dist.x * dist.x + dist.y * dist.y + dist.z * dist.z;
+  }
+}
+}
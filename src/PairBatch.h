@@ -0,0 +1,43 @@
+/*******************************************************************************
+GPU OPTIMIZED MONTE CARLO (GOMC) 2.40
+Copyright (C) 2018  GOMC Group
+A copy of the GNU General Public License can be found in the COPYRIGHT.txt
+along with this program, also can be found at <http://www.gnu.org/licenses/>.
+********************************************************************************/
+#ifndef PAIR_BATCH_H
+#define PAIR_BATCH_H
+
+#include "BasicTypes.h" //for uint
+
+class XYZArray;
+class BoxDimensions;
+
+//
+//    PairBatch.h
+//    Minimum image distances for a block of atom pairs at once, working on
+//    the x/y/z arrays of XYZArray directly. For orthogonal boxes the loop is
+//    vectorized and compiled for AVX-512, AVX2 and generic x86-64; the best
+//    version for the running CPU is picked at load time from CPUID.
+//    Other boxes fall back to BoxDimensions::MinImage one pair at a time.
+//
+
+namespace batch
+{
+//!Number of pairs the energy kernels hand over per call
+const uint SIZE = 64;
+
+//!Minimum image vector (dx, dy, dz) and its squared length for the count
+//!pairs arr1[i[k]] - arr2[j[k]] in box b
+void PairDist(double* dx, double* dy, double* dz, double* distSq,
+              BoxDimensions const& boxAxes, XYZArray const& arr1,
+              const uint* i, XYZArray const& arr2, const uint* j,
+              const uint count, const uint b);
+
+//!Same as PairDist, for the single atom arr1[i] against arr2[j[k]]
+void AtomDist(double* dx, double* dy, double* dz, double* distSq,
+              BoxDimensions const& boxAxes, XYZArray const& arr1,
+              const uint i, XYZArray const& arr2, const uint* j,
+              const uint count, const uint b);
+}
+
+#endif /*PAIR_BATCH_H*/
@@ -0,0 +1,99 @@
+/*******************************************************************************
+GPU OPTIMIZED MONTE CARLO (GOMC) 2.40
+Copyright (C) 2018  GOMC Group
+A copy of the GNU General Public License can be found in the COPYRIGHT.txt
+along with this program, also can be found at <http://www.gnu.org/licenses/>.
+********************************************************************************/
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include "BasicTypes.h" //For ulong
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+//
+//    Parallel.h
+//    Whether a loop is worth an OpenMP parallel region. Waking the thread
+//    team and joining it again costs about as much as a few thousand pair
+//    energies, which is more than most single molecule loops have. Loops
+//    of a move pass their amount of work to Worth in the if clause of their
+//    pragma and run on the calling thread when it is small.
+//
+//    The OpenMP runtime keeps its threads between regions, so work of the
+//    same move that does reach the threshold is batched into as few loops
+//    as possible (see CalculateEnergy::MoleculeInter and ParticleInter).
+//    OMP_WAIT_POLICY=active keeps the idle threads spinning between moves.
+//
+//    Independent work of several boxes (a GEMC volume move, a full energy
+//    recalculation) can run at the same time: a team of one thread per box
+//    runs the boxes, and each of those threads opens its own nested team
+//    for the loops of its box. Split decides the size of each nested team.
+//    Main allows the second level of nesting (omp_set_max_active_levels).
+//
+namespace par
+{
+//! Work items (pair energies, or k-vectors times atoms) below which a
+//! loop runs serially
+const ulong MIN_WORK = 2048;
+
+//! True if a loop over work items should run on the thread team
+inline bool Worth(const ulong work)
+{
+#ifdef _OPENMP
+  return work >= MIN_WORK && omp_get_max_threads() > 1;
+#else
+  return false;
+#endif
+}
+
+//! Largest ratio of the busiest nested team's work per thread to the
+//! average work per thread for which Split still runs tasks at once. The
+//! serial parts of each box (k-vectors, binning, short loops) are what
+//! running boxes at the same time wins back.
+const double MAX_IMBALANCE = 1.25;
+
+//! Threads of each of count tasks with the given work items that are to run
+//! at the same time as nested teams. Every team gets one thread, then each
+//! further thread goes to the team with the most work per thread. Returns
+//! false if the tasks should run in turn on the whole team instead: too
+//! little work, fewer threads than tasks, already inside a team or nesting
+//! not allowed, or a split too uneven to pay off (MAX_IMBALANCE). Tasks
+//! never split in GPU and profiled builds, whose state is global.
+inline bool Split(int *threads, const ulong *work, const uint count)
+{
+#if defined(_OPENMP) && !defined(GOMC_CUDA) && !defined(GOMC_PROFILE)
+  int team = omp_get_max_threads();
+  ulong total = 0;
+  uint most = 0;
+  for (uint i = 0; i < count; i++)
+    total += work[i];
+  if (count < 2 || team < (int)count || !Worth(total) ||
+      omp_get_level() != 0 || omp_get_max_active_levels() < 2)
+    return false;
+
+  for (uint i = 0; i < count; i++)
+    threads[i] = 1;
+  for (int t = count; t < team; t++) {
+    most = 0;
+    for (uint i = 1; i < count; i++) {
+      if (work[i] * threads[most] > work[most] * threads[i])
+        most = i;
+    }
+    threads[most]++;
+  }
+
+  most = 0;
+  for (uint i = 1; i < count; i++) {
+    if (work[i] * threads[most] > work[most] * threads[i])
+      most = i;
+  }
+  return (double)work[most] / threads[most] <=
+         MAX_IMBALANCE * total / team;
+#else
+  return false;
+#endif
+}
+}
+
+#endif /*PARALLEL_H*/
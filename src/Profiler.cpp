@@ -0,0 +1,150 @@
+/*******************************************************************************
+GPU OPTIMIZED MONTE CARLO (GOMC) 2.40
+Copyright (C) 2018  GOMC Group
+A copy of the GNU General Public License can be found in the COPYRIGHT.txt
+along with this program, also can be found at <http://www.gnu.org/licenses/>.
+********************************************************************************/
+#include "Profiler.h"
+
+#ifdef GOMC_PROFILE
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <iomanip>
+#include <cstdlib>
+
+namespace
+{
+const char* const FIXED_NAMES[prof::MOVE_TIMERS] = {
+  "SystemTotal", "BoxInter", "ForceCalc", "MoleculeInter", "MoleculeVirial",
+  "ParticleInter", "MoleculeIntra", "FindMolInCavity",
+  "RecipInit", "BoxReciprocalSetup", "BoxReciprocal", "ForceReciprocal",
+  "MolReciprocal", "SwapDestRecip", "SwapSourceRecip", "SwapRecip",
+  "UpdateRecip",
+  "CellList.AddMol", "CellList.RemoveMol", "CellList.GridAll",
+  "CellList.GridBox", "CellList.GridScaled", "CellList.Repack",
+  "DCSingle", "DCOnSphere", "DCLinkedHedron", "DCFreeHedron",
+  "DCFreeHedronSeed", "DCLinkedCycle", "DCFreeCycle",
+  "DCFreeCycleSeed", "DCRotateCOM", "DCRotateOnAtom", "DCCrankShaftAng",
+  "DCCrankShaftDih"
+};
+
+const char* const PHASE_NAMES[prof::PHASES_TOTAL] = {
+  "Prep", "Transform", "CalcEn", "Accept"
+};
+
+const char* const COUNTER_NAMES[prof::COUNTERS_TOTAL] = {
+  "pairs", "kvectors", "trials"
+};
+}
+
+namespace prof
+{
+std::string MoveName(const uint kind)
+{
+  switch (kind) {
+  case mv::DISPLACE:
+    return "Displacement";
+  case mv::ROTATE:
+    return "Rotation";
+  case mv::INTRA_SWAP:
+    return "Intra-Swap";
+  case mv::REGROWTH:
+    return "Regrowth";
+  case mv::INTRA_MEMC:
+    return "Intra-MEMC";
+  case mv::CRANKSHAFT:
+    return "Crank-Shaft";
+#if ENSEMBLE == GEMC || ENSEMBLE == GCMC
+  case mv::MOL_TRANSFER:
+    return "Mol-Transfer";
+  case mv::MEMC:
+    return "MEMC";
+#endif
+#if ENSEMBLE == GEMC || ENSEMBLE == NPT
+  case mv::VOL_TRANSFER:
+    return "Vol-Transfer";
+#endif
+  default:
+    return "Unknown";
+  }
+}
+
+Profiler profiler;
+
+Profiler::Profiler() : reportedSteps(0)
+{
+  std::fill_n(time, TIMERS_TOTAL, 0.0);
+  std::fill_n(calls, TIMERS_TOTAL, 0);
+  std::fill_n(counts, COUNTERS_TOTAL, 0);
+  timerName.assign(FIXED_NAMES, FIXED_NAMES + MOVE_TIMERS);
+  for (uint m = 0; m < mv::MOVE_KINDS_TOTAL; ++m) {
+    for (uint p = 0; p < PHASES_TOTAL; ++p)
+      timerName.push_back(MoveName(m) + "." + PHASE_NAMES[p]);
+  }
+}
+
+void Profiler::Init(std::string const& uniqueStr)
+{
+  jsonName = uniqueStr + "_profile.json";
+  csvName = uniqueStr + "_profile.csv";
+  std::ofstream csv(csvName.c_str(), std::ios::out | std::ios::trunc);
+  if (!csv.is_open()) {
+    std::cout << "Error: Cannot open profile file " << csvName << "!\n";
+    exit(EXIT_FAILURE);
+  }
+  csv << "step,type,name,count,seconds\n";
+  printf("%-40s %-s \n", "Info: Profiler", "Active");
+}
+
+void Profiler::Report(const ulong step)
+{
+  //the last console output and the end of the run can be the same step
+  if (step + 1 == reportedSteps)
+    return;
+  reportedSteps = step + 1;
+  WriteJSON(step);
+  WriteCSV(step);
+}
+
+void Profiler::WriteJSON(const ulong step)
+{
+  std::ofstream out(jsonName.c_str(), std::ios::out | std::ios::trunc);
+  out << std::setprecision(9);
+  out << "{\n  \"step\": " << step + 1 << ",\n  \"timers\": [";
+  bool first = true;
+  for (uint t = 0; t < TIMERS_TOTAL; ++t) {
+    if (calls[t] == 0)
+      continue;
+    out << (first ? "\n" : ",\n") << "    {\"name\": \"" << timerName[t]
+        << "\", \"calls\": " << calls[t] << ", \"seconds\": " << time[t]
+        << "}";
+    first = false;
+  }
+  out << "\n  ],\n  \"counters\": {";
+  for (uint c = 0; c < COUNTERS_TOTAL; ++c) {
+    out << (c == 0 ? "\n" : ",\n") << "    \"" << COUNTER_NAMES[c] << "\": "
+        << counts[c];
+  }
+  out << "\n  }\n}\n";
+}
+
+void Profiler::WriteCSV(const ulong step)
+{
+  std::ofstream out(csvName.c_str(), std::ios::out | std::ios::app);
+  out << std::setprecision(9);
+  for (uint t = 0; t < TIMERS_TOTAL; ++t) {
+    if (calls[t] == 0)
+      continue;
+    out << step + 1 << ",timer," << timerName[t] << "," << calls[t] << ","
+        << time[t] << "\n";
+  }
+  for (uint c = 0; c < COUNTERS_TOTAL; ++c)
+    out << step + 1 << ",counter," << COUNTER_NAMES[c] << "," << counts[c]
+        << ",\n";
+}
+}
+
+#endif /*GOMC_PROFILE*/
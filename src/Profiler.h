@@ -0,0 +1,214 @@
+/*******************************************************************************
+GPU OPTIMIZED MONTE CARLO (GOMC) 2.40
+Copyright (C) 2018  GOMC Group
+A copy of the GNU General Public License can be found in the COPYRIGHT.txt
+along with this program, also can be found at <http://www.gnu.org/licenses/>.
+********************************************************************************/
+#ifndef PROFILER_H
+#define PROFILER_H
+
+//
+//    Profiler.h
+//    Wall time and call counts of the move phases, energy kernels, Ewald
+//    routines, cell list updates and CBMC components, plus counters of the
+//    work they did. Only built in with the GOMC_PROFILE CMake option, the
+//    PROFILE_* macros are empty otherwise.
+//
+//    The report is written to <OutputName>_profile.json (the totals so far)
+//    and appended to <OutputName>_profile.csv at every console output and at
+//    the end of the run. Times are inclusive, so nested timers are counted
+//    in their callers too. Timers started inside an OpenMP parallel region
+//    are ignored, only the thread that runs the move is timed.
+//
+
+#ifdef GOMC_PROFILE
+
+#include "BasicTypes.h" //For uint, ulong
+#include "MoveConst.h" //For MOVE_KINDS_TOTAL
+#include <string>
+#include <vector>
+#if defined(__linux__) || defined(__APPLE__)
+#include <sys/time.h>
+#else
+#include <time.h>
+#endif
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace prof
+{
+//Phases of a move, see System::RunMove
+enum Phase { PREP, TRANSFORM, CALC_EN, ACCEPT, PHASES_TOTAL };
+
+enum Timer {
+  //energy
+  SYSTEM_TOTAL,
+  BOX_INTER,
+  FORCE_CALC,
+  MOLECULE_INTER,
+  MOLECULE_VIRIAL,
+  PARTICLE_INTER,
+  MOLECULE_INTRA,
+  FIND_MOL_IN_CAVITY,
+  //Ewald
+  RECIP_INIT,
+  BOX_RECIP_SETUP,
+  BOX_RECIP,
+  FORCE_RECIP,
+  MOL_RECIP,
+  SWAP_DEST_RECIP,
+  SWAP_SOURCE_RECIP,
+  SWAP_RECIP,
+  UPDATE_RECIP,
+  //cell list
+  CELL_ADD_MOL,
+  CELL_REMOVE_MOL,
+  CELL_GRID_ALL,
+  CELL_GRID_BOX,
+  CELL_GRID_SCALED,
+  CELL_REPACK,
+  //CBMC components, both BuildOld and BuildNew
+  DC_SINGLE,
+  DC_ON_SPHERE,
+  DC_LINKED_HEDRON,
+  DC_FREE_HEDRON,
+  DC_FREE_HEDRON_SEED,
+  DC_LINKED_CYCLE,
+  DC_FREE_CYCLE,
+  DC_FREE_CYCLE_SEED,
+  DC_ROTATE_COM,
+  DC_ROTATE_ON_ATOM,
+  DC_CRANKSHAFT_ANG,
+  DC_CRANKSHAFT_DIH,
+  //the move phases follow, see MoveTimer
+  MOVE_TIMERS
+};
+
+enum Counter {
+  PAIRS,      //pair interactions evaluated by the intermolecular kernels
+  KVECTORS,   //reciprocal vectors looped over by the Ewald sums
+  TRIALS,     //CBMC trial positions evaluated
+  COUNTERS_TOTAL
+};
+
+inline uint MoveTimer(const uint kind, const Phase phase)
+{
+  return MOVE_TIMERS + kind * PHASES_TOTAL + phase;
+}
+
+static const uint TIMERS_TOTAL = MOVE_TIMERS +
+                                 mv::MOVE_KINDS_TOTAL * PHASES_TOTAL;
+
+//Name of the move kind, as printed by System::PrintTime
+std::string MoveName(const uint kind);
+
+inline double Now()
+{
+#ifdef _OPENMP
+  return omp_get_wtime();
+#elif defined(__linux__) || defined(__APPLE__)
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  return (double)tv.tv_sec + (double)tv.tv_usec / 1000000;
+#else
+  return (double)clock() / CLOCKS_PER_SEC;
+#endif
+}
+
+class Profiler
+{
+public:
+  Profiler();
+
+  //Starts the report files
+  void Init(std::string const& uniqueStr);
+
+  void Add(const uint timer, const double seconds)
+  {
+    time[timer] += seconds;
+    calls[timer]++;
+  }
+
+  void Count(const Counter counter, const ulong n)
+  {
+#ifdef _OPENMP
+    #pragma omp atomic
+#endif
+    counts[counter] += n;
+  }
+
+  //Writes the totals of all timers and counters after step, once per step
+  void Report(const ulong step);
+
+  std::string const& Name(const uint timer) const
+  {
+    return timerName[timer];
+  }
+  double Seconds(const uint timer) const
+  {
+    return time[timer];
+  }
+  ulong Calls(const uint timer) const
+  {
+    return calls[timer];
+  }
+  ulong Counts(const Counter counter) const
+  {
+    return counts[counter];
+  }
+
+private:
+  void WriteJSON(const ulong step);
+  void WriteCSV(const ulong step);
+
+  std::string jsonName, csvName;
+  ulong reportedSteps;
+  std::vector<std::string> timerName;
+  double time[TIMERS_TOTAL];
+  ulong calls[TIMERS_TOTAL];
+  ulong counts[COUNTERS_TOTAL];
+};
+
+extern Profiler profiler;
+
+//Adds the lifetime of the object to timer
+class ScopedTimer
+{
+public:
+  explicit ScopedTimer(const uint t) : timer(t), start(0.0), active(true)
+  {
+#ifdef _OPENMP
+    active = !omp_in_parallel();
+#endif
+    if (active)
+      start = Now();
+  }
+  ~ScopedTimer()
+  {
+    if (active)
+      profiler.Add(timer, Now() - start);
+  }
+
+private:
+  uint timer;
+  double start;
+  bool active;
+};
+}
+
+#define PROFILE_INIT(uniqueStr) prof::profiler.Init(uniqueStr)
+#define PROFILE_SCOPE(timer) prof::ScopedTimer profileScope(timer)
+#define PROFILE_COUNT(counter, n) prof::profiler.Count(counter, n)
+#define PROFILE_REPORT(step) prof::profiler.Report(step)
+
+#else
+
+#define PROFILE_INIT(uniqueStr)
+#define PROFILE_SCOPE(timer)
+#define PROFILE_COUNT(counter, n)
+#define PROFILE_REPORT(step)
+
+#endif /*GOMC_PROFILE*/
+
+#endif /*PROFILER_H*/
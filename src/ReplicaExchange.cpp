@@ -0,0 +1,321 @@
+/*******************************************************************************
+GPU OPTIMIZED MONTE CARLO (GOMC) 2.40
+Copyright (C) 2018  GOMC Group
+A copy of the GNU General Public License can be found in the COPYRIGHT.txt
+along with this program, also can be found at <http://www.gnu.org/licenses/>.
+********************************************************************************/
+#include "ReplicaExchange.h"
+#include "Simulation.h"
+#include "InputFileReader.h"
+#include "MoveConst.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstdio>
+#include <iostream>
+#include <iomanip>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace
+{
+bool SameKeyword(std::string str1, std::string str2)
+{
+  for(uint k = 0; k < str1.length(); k++)
+    str1[k] = toupper(str1[k]);
+  for(uint k = 0; k < str2.length(); k++)
+    str2[k] = toupper(str2[k]);
+  return str1 == str2;
+}
+}
+
+bool ReplicaExchange::Requested(char const*const fileName)
+{
+  InputFileReader reader(fileName);
+  std::vector<std::string> line;
+  while(reader.readNextLine(line)) {
+    if(line.size() != 0 && SameKeyword(line[0], "Replica"))
+      return true;
+    line.clear();
+  }
+  return false;
+}
+
+ReplicaExchange::ReplicaExchange(char const*const fileName) :
+  freq(0), name("Replica"), seeded(false), seed(0)
+{
+  Read(fileName);
+  if(seeded)
+    prng.seed(seed);
+
+  for(uint r = 0; r < files.size(); r++) {
+    printf("\n%-40s %-d of %-d\n", "Info: Setting up replica", r + 1,
+           (int)files.size());
+    replicas.push_back(new Simulation(files[r].c_str()));
+  }
+  Check();
+
+  //slots go up in temperature whatever order the files are listed in, an
+  //insertion sort keeps the listed order of equal temperatures
+  holder.resize(replicas.size());
+  slotT.resize(replicas.size());
+  for(uint r = 0; r < replicas.size(); r++)
+    holder[r] = r;
+  for(uint s = 1; s < holder.size(); s++) {
+    for(uint t = s; t > 0 && Get(holder[t]).T < Get(holder[t - 1]).T; t--)
+      std::swap(holder[t], holder[t - 1]);
+  }
+  for(uint s = 0; s < holder.size(); s++)
+    slotT[s] = Get(holder[s]).T;
+  tries.assign(replicas.size() - 1, 0);
+  accepted.assign(replicas.size() - 1, 0);
+
+  std::string outName = name + "_exchange.dat";
+  outF.open(outName.c_str(), std::ofstream::out);
+  if(!outF.is_open()) {
+    std::cout << "Error: Cannot open " << outName << " for writing!\n";
+    exit(EXIT_FAILURE);
+  }
+  outF << "#STEP";
+  for(uint s = 0; s < slotT.size(); s++)
+    outF << std::setw(12) << slotT[s];
+  outF << std::endl;
+}
+
+ReplicaExchange::~ReplicaExchange()
+{
+  for(uint r = 0; r < replicas.size(); r++)
+    delete replicas[r];
+  outF.close();
+}
+
+void ReplicaExchange::Read(char const*const fileName)
+{
+  InputFileReader reader;
+  std::vector<std::string> line;
+
+  reader.Open(fileName);
+  printf("\n%-40s %-s\n", "Reading Replica Exchange File:", fileName);
+  while(reader.readNextLine(line)) {
+    if(line.size() == 0)
+      continue;
+
+    if(line.size() < 2) {
+      std::cout << "Error: Missing value of " << line[0] << "!\n";
+      exit(EXIT_FAILURE);
+    }
+    if(SameKeyword(line[0], "Replica")) {
+      files.push_back(line[1]);
+      printf("%-40s %-s \n", "Info: Replica config file", line[1].c_str());
+    } else if(SameKeyword(line[0], "ExchangeFreq")) {
+      freq = strtoul(line[1].c_str(), NULL, 10);
+      printf("%-40s %-lu \n", "Info: Exchange frequency", freq);
+    } else if(SameKeyword(line[0], "OutputName")) {
+      name = line[1];
+      printf("%-40s %-s \n", "Info: Exchange output name", name.c_str());
+    } else if(SameKeyword(line[0], "Random_Seed")) {
+      seeded = true;
+      seed = strtoul(line[1].c_str(), NULL, 10);
+      printf("%-40s %-u \n", "Info: Exchange seed", seed);
+    } else {
+      std::cout << "Warning: Unknown input " << line[0] << "!" << std::endl;
+    }
+    line.clear();
+  }
+
+  if(files.size() < 2) {
+    std::cout << "Error: Replica exchange needs at least two Replica files!\n";
+    exit(EXIT_FAILURE);
+  }
+  if(freq == 0) {
+    std::cout << "Error: ExchangeFreq must be set and positive!\n";
+    exit(EXIT_FAILURE);
+  }
+}
+
+//Replicas must agree on everything a swap or the lockstep run relies on
+void ReplicaExchange::Check(void) const
+{
+  for(uint r = 0; r < replicas.size(); r++) {
+    Simulation& sim = *replicas[r];
+    config_setup::Output const& out = sim.GetSetup().config.out;
+    if(sim.TotalSteps() <= sim.StartStep() ||
+        sim.StartStep() != replicas[0]->StartStep() ||
+        sim.TotalSteps() != replicas[0]->TotalSteps()) {
+      std::cout << "Error: All replicas must run the same, nonzero, steps!\n";
+      exit(EXIT_FAILURE);
+    }
+    if(sim.GetStaticVals().mol.GetKindsCount() !=
+        replicas[0]->GetStaticVals().mol.GetKindsCount()) {
+      std::cout << "Error: All replicas must have the same molecule kinds!\n";
+      exit(EXIT_FAILURE);
+    }
+#if ENSEMBLE == GCMC
+    if(sim.GetStaticVals().forcefield.isFugacity !=
+        replicas[0]->GetStaticVals().forcefield.isFugacity) {
+      std::cout << "Error: Replicas can not mix fugacity and chemical "
+                << "potential!\n";
+      exit(EXIT_FAILURE);
+    }
+#endif
+    //The checkpoint file name is fixed and does not record the swaps
+    if(out.checkpoint.enable) {
+      std::cout << "Error: Checkpoint output can not be used with replica "
+                << "exchange!\n";
+      exit(EXIT_FAILURE);
+    }
+    for(uint s = 0; s < r; s++) {
+      if(out.statistics.settings.uniqueStr.val ==
+          replicas[s]->GetSetup().config.out.statistics.settings.uniqueStr.val) {
+        std::cout << "Error: Replicas " << s + 1 << " and " << r + 1
+                  << " have the same OutputName!\n";
+        exit(EXIT_FAILURE);
+      }
+    }
+  }
+}
+
+ReplicaExchange::Thermo ReplicaExchange::Get(const uint replica) const
+{
+  StaticVals& statV = replicas[replica]->GetStaticVals();
+  Thermo thermo;
+  thermo.T = statV.forcefield.T_in_K;
+#if ENSEMBLE == GCMC
+  for(uint k = 0; k < statV.mol.GetKindsCount(); k++)
+    thermo.chemPot.push_back(statV.mol.kinds[k].chemPot);
+#endif
+  return thermo;
+}
+
+void ReplicaExchange::Set(const uint replica, Thermo const& thermo)
+{
+  StaticVals& statV = replicas[replica]->GetStaticVals();
+  statV.forcefield.SetTemperature(thermo.T);
+#if ENSEMBLE == GCMC
+  for(uint k = 0; k < statV.mol.GetKindsCount(); k++)
+    statV.mol.kinds[k].chemPot = thermo.chemPot[k];
+#endif
+}
+
+//With u(x; p) the reduced energy of state x under the parameters p, this is
+//u(a; pa) + u(b; pb) - u(a; pb) - u(b; pa). The pressure of NPT stays with
+//its replica, so beta * P * V swaps with beta like the energy does.
+double ReplicaExchange::LogAcceptance(const uint a, const uint b) const
+{
+  System& sysA = replicas[a]->GetSystem();
+  System& sysB = replicas[b]->GetSystem();
+  StaticVals const& statA = replicas[a]->GetStaticVals();
+  StaticVals const& statB = replicas[b]->GetStaticVals();
+  double betaA = statA.forcefield.beta, betaB = statB.forcefield.beta;
+  double hA = sysA.potential.totalEnergy.total;
+  double hB = sysB.potential.totalEnergy.total;
+
+#if ENSEMBLE == GEMC || ENSEMBLE == NPT
+  for(uint box = 0; box < BOX_TOTAL; box++) {
+    if(box == mv::BOX0 && statA.fixVolBox0)
+      continue;
+    if(statA.kindOfGEMC == mv::GEMC_NPT)
+      hA += statA.pressure * sysA.boxDimRef.volume[box];
+    if(statB.kindOfGEMC == mv::GEMC_NPT)
+      hB += statB.pressure * sysB.boxDimRef.volume[box];
+  }
+#endif
+
+  double logAcc = (betaA - betaB) * (hA - hB);
+
+#if ENSEMBLE == GCMC
+  //GOMC's chemical potential already holds the thermal wavelength, so
+  //the weight of N molecules is exp(beta mu N), or (beta f)^N for fugacity
+  for(uint k = 0; k < statA.mol.GetKindsCount(); k++) {
+    double nA = sysA.molLookupRef.NumKindInBox(k, mv::BOX0);
+    double nB = sysB.molLookupRef.NumKindInBox(k, mv::BOX0);
+    double muA = statA.mol.kinds[k].chemPot, muB = statB.mol.kinds[k].chemPot;
+    if(nA == nB || (muA == muB && betaA == betaB))
+      continue;
+    double bA, bB;
+    if(statA.forcefield.isFugacity) {
+      if(muA == 0.0 && muB == 0.0)
+        continue;
+      bA = log(betaA * muA);
+      bB = log(betaB * muB);
+    } else {
+      bA = betaA * muA;
+      bB = betaB * muB;
+    }
+    logAcc -= (bA - bB) * (nA - nB);
+  }
+#endif
+
+  return logAcc;
+}
+
+void ReplicaExchange::Attempt(const ulong step, const uint parity)
+{
+  for(uint s = parity; s + 1 < holder.size(); s += 2) {
+    uint a = holder[s], b = holder[s + 1];
+    double logAcc = LogAcceptance(a, b);
+    tries[s]++;
+    if(logAcc >= 0.0 || prng.rand() < exp(logAcc)) {
+      Thermo thermoA = Get(a);
+      Set(a, Get(b));
+      Set(b, thermoA);
+      std::swap(holder[s], holder[s + 1]);
+      accepted[s]++;
+    }
+  }
+  Write(step);
+}
+
+void ReplicaExchange::Write(const ulong step)
+{
+  outF << std::setw(5) << step;
+  for(uint s = 0; s < holder.size(); s++)
+    outF << std::setw(12) << holder[s] + 1;
+  outF << std::endl;
+}
+
+void ReplicaExchange::Run(void)
+{
+  ulong first = replicas[0]->StartStep(), last = replicas[0]->TotalSteps();
+  uint parity = 0;
+  int count = replicas.size();
+
+  //The replicas are the parallel work, each one runs on a single thread.
+  //Profiled builds and the GPU code keep global state and run them in turn.
+#if defined(_OPENMP) && !defined(GOMC_CUDA) && !defined(GOMC_PROFILE)
+  omp_set_max_active_levels(1);
+  printf("%-40s %-d \n", "Info: Replicas run in parallel on threads",
+         std::min(omp_get_max_threads(), count));
+#endif
+
+  for(ulong step = first; step < last;) {
+    ulong end = std::min((step / freq + 1) * freq, last);
+#if defined(_OPENMP) && !defined(GOMC_CUDA) && !defined(GOMC_PROFILE)
+    #pragma omp parallel for schedule(dynamic, 1)
+#endif
+    for(int r = 0; r < count; r++)
+      replicas[r]->RunSteps(step, end);
+    if(end % freq == 0) {
+      Attempt(end, parity);
+      parity ^= 1;
+    }
+    step = end;
+  }
+
+  for(uint r = 0; r < replicas.size(); r++) {
+    printf("\n%-40s %-d\n", "Info: Summary of replica", r + 1);
+    replicas[r]->Finish();
+  }
+  PrintAcceptance();
+}
+
+void ReplicaExchange::PrintAcceptance(void) const
+{
+  printf("\n%-40s\n", "Replica exchange acceptance:");
+  for(uint s = 0; s < tries.size(); s++) {
+    double percent = tries[s] == 0 ? 0.0 : 100.0 * accepted[s] / tries[s];
+    printf("%-10.2f K <-> %-10.2f K %-10lu tries %10.2f %%\n", slotT[s],
+           slotT[s + 1], tries[s], percent);
+  }
+}
@@ -0,0 +1,88 @@
+/*******************************************************************************
+GPU OPTIMIZED MONTE CARLO (GOMC) 2.40
+Copyright (C) 2018  GOMC Group
+A copy of the GNU General Public License can be found in the COPYRIGHT.txt
+along with this program, also can be found at <http://www.gnu.org/licenses/>.
+********************************************************************************/
+#ifndef REPLICA_EXCHANGE_H
+#define REPLICA_EXCHANGE_H
+
+#include "BasicTypes.h" //For uint, ulong
+#include "MersenneTwister.h"
+#include <fstream>
+#include <string>
+#include <vector>
+
+class Simulation;
+
+//
+//    ReplicaExchange.h
+//    Parallel tempering of several replicas of one system in one process.
+//    The input file lists the config file of every replica. Swaps are
+//    tried between neighbouring temperatures, replicas at the same
+//    temperature neighbour in the order they are listed (e.g. by chemical
+//    potential):
+//
+//      Replica        T300.conf
+//      Replica        T320.conf
+//      ExchangeFreq   1000
+//      OutputName     rex
+//      Random_Seed    50
+//
+//    Each replica is a full Simulation with its own output files (the
+//    OutputName of its config). The replicas run on the threads of +p#,
+//    one thread each, and every ExchangeFreq steps swaps between the
+//    replicas holding neighbouring temperatures are attempted. A swap
+//    exchanges the temperature, and in GCMC the chemical potentials, of the
+//    two replicas, the coordinates stay put. Which replica holds which
+//    temperature after each attempt goes to <OutputName>_exchange.dat.
+//
+class ReplicaExchange
+{
+public:
+  explicit ReplicaExchange(char const*const fileName);
+  ~ReplicaExchange();
+
+  //! True if fileName is a replica exchange input (has Replica lines)
+  static bool Requested(char const*const fileName);
+
+  void Run(void);
+
+private:
+  //Parameters a swap moves between replicas
+  struct Thermo {
+    double T;
+    std::vector<double> chemPot; //GCMC only
+  };
+
+  void Read(char const*const fileName);
+  void Check(void) const;
+
+  Thermo Get(const uint replica) const;
+  void Set(const uint replica, Thermo const& thermo);
+
+  //! Attempts swaps between the replicas holding slots s and s+1 for
+  //! every s of the given parity
+  void Attempt(const ulong step, const uint parity);
+  //! Log of the acceptance ratio of swapping the parameters of a and b
+  double LogAcceptance(const uint a, const uint b) const;
+
+  void Write(const ulong step);
+  void PrintAcceptance(void) const;
+
+  std::vector<std::string> files;
+  std::vector<Simulation *> replicas;
+  //replica holding each parameter slot, and the temperature of the slot
+  std::vector<uint> holder;
+  std::vector<double> slotT;
+  std::vector<ulong> tries, accepted;
+
+  ulong freq;
+  std::string name;
+  bool seeded;
+  uint seed;
+  MTRand prng;
+  std::ofstream outF;
+};
+
+#endif /*REPLICA_EXCHANGE_H*/
@@ -0,0 +1,104 @@
+/*******************************************************************************
+GPU OPTIMIZED MONTE CARLO (GOMC) 2.40
+Copyright (C) 2018  GOMC Group
+A copy of the GNU General Public License can be found in the COPYRIGHT.txt
+along with this program, also can be found at <http://www.gnu.org/licenses/>.
+********************************************************************************/
+#ifndef SCRATCH_H
+#define SCRATCH_H
+
+#include "BasicTypes.h" //For uint
+#include "EnsemblePreprocessor.h" //For BOX_TOTAL
+#include "XYZArray.h"
+#include <vector>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+//Neighbors of a set of positions (CBMC trials, or the old and new atoms of
+//a molecule), cut into blocks of batch::SIZE so one parallel loop covers
+//all of them. ParticleInter takes them from the caller (cbmc::DCData).
+struct TrialNeighbors {
+  std::vector<uint> kind;         //atom kind of each position
+  std::vector<double> charge;     //atom charge of each position
+  std::vector<uint> index;        //neighbors of every position in turn
+  std::vector<uint> start;        //first neighbor of each position, n + 1
+  std::vector<uint> blockTrial;   //position of each block of batch::SIZE
+  std::vector<uint> blockStart;   //first neighbor of each block
+  std::vector<double> blockLJ, blockReal;
+  std::vector<char> blockOverlap;
+};
+
+//Work arrays of the energy functions that used to be allocated on every
+//call. The vectors are cleared, never shrunk, so once they reached the
+//largest size a run needs, the energy calls do not touch the heap.
+struct ScratchBuffers {
+  ScratchBuffers() : bondVec(0), positions(0) {}
+
+  //Returns bondVec with room for at least n vectors
+  XYZArray& BondVectors(const uint n)
+  {
+    if (bondVec.Count() < n)
+      bondVec.Init(n);
+    return bondVec;
+  }
+
+  //Returns positions with room for at least n atoms
+  XYZArray& Positions(const uint n)
+  {
+    if (positions.Count() < n)
+      positions.Init(n);
+    return positions;
+  }
+
+  //neighbors of one atom
+  std::vector<uint> nIndex;
+  //pairs of a whole box
+  std::vector<uint> pair1, pair2;
+  //particles of a half shell of cells
+  std::vector<uint> shell;
+  //molecules of a box
+  std::vector<uint> molID;
+  XYZArray bondVec;
+  std::vector<bool> bondExist;
+  //old and new positions of a molecule and their neighbors
+  XYZArray positions;
+  TrialNeighbors neighbors;
+};
+
+//One set of buffers per OpenMP thread, owned by System. Functions that may
+//be called from inside a parallel region take the set of the calling thread.
+//Boxes evaluated at the same time (par::Split) run as nested teams under a
+//team of one thread per box. With n boxes, the threads of a box take every
+//n-th set from the box's own on.
+class ScratchPool
+{
+public:
+  //Must be called after the number of threads is set
+  void Init()
+  {
+#ifdef _OPENMP
+    buffers.resize(BOX_TOTAL * omp_get_max_threads());
+#else
+    buffers.resize(1);
+#endif
+  }
+
+  ScratchBuffers& Get()
+  {
+#ifdef _OPENMP
+    if (omp_get_level() > 1) {
+      return buffers[omp_get_ancestor_thread_num(1) +
+                     omp_get_team_size(1) * omp_get_ancestor_thread_num(2)];
+    }
+    return buffers[omp_get_thread_num()];
+#else
+    return buffers[0];
+#endif
+  }
+
+private:
+  std::vector<ScratchBuffers> buffers;
+};
+
+#endif /*SCRATCH_H*/
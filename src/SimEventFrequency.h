@@ -11,8 +11,8 @@ along with this program, also can be found at <http://www.gnu.org/licenses/>.
 #include "ConfigSetup.h" //for event frequencies from config file.
 
 struct SimEventFrequency {
-  ulong total, perAdjust, tillEquil, pCalcFreq;
-  bool pressureCalc;
+  ulong total, perAdjust, tillEquil, pCalcFreq, virialFullFreq;
+  bool pressureCalc, virialTracking;
 
   void Init(config_setup::Step const& s)
   {
@@ -21,6 +21,8 @@ struct SimEventFrequency {
     tillEquil = s.equil;
     pCalcFreq = s.pressureCalcFreq;
     pressureCalc = s.pressureCalc;
+    virialTracking = s.virialTracking;
+    virialFullFreq = s.virialFullFreq;
   }
 };
 
@@ -9,6 +9,7 @@ along with this program, also can be found at <http://www.gnu.org/licenses/>.
 
 #include "EnergyTypes.h"
 #include "PSFOutput.h"
+#include "Profiler.h"
 #include <iostream>
 #include <iomanip>
 
@@ -20,6 +21,7 @@ Simulation::Simulation(char const*const configFileName)
   //as system depends on staticValues, and cpu sometimes depends on both.
   set.Init(configFileName);
   totalSteps = set.config.sys.step.total;
+  PROFILE_INIT(set.config.out.statistics.settings.uniqueStr.val);
   staticValues = new StaticVals(set);
   system = new System(*staticValues);
   staticValues->Init(set, *system);
@@ -39,8 +41,10 @@ Simulation::Simulation(char const*const configFileName)
             << set.config.out.state.files.psf.name << '\n';
 
   if(totalSteps == 0) {
-    frameSteps = set.pdb.GetFrameSteps(set.config.in.files.pdb.name);
+    frameSteps = set.pdb.GetFrameSteps(set.config.in.files.pdb.name,
+                                       set.config.in.restart.frameIndexFile);
   }
+  startEnergy = system->potential.totalEnergy.total;
 }
 
 Simulation::~Simulation()
@@ -52,7 +56,6 @@ Simulation::~Simulation()
 
 void Simulation::RunSimulation(void)
 {
-  double startEnergy = system->potential.totalEnergy.total;
   if(totalSteps == 0) {
     for(int i = 0; i < frameSteps.size(); i++) {
       if(i == 0) {
@@ -63,7 +66,13 @@ void Simulation::RunSimulation(void)
       cpu->Output(frameSteps[i] - 1);
     }
   }
-  for (ulong step = startStep; step < totalSteps; step++) {
+  RunSteps(startStep, totalSteps);
+  Finish();
+}
+
+void Simulation::RunSteps(const ulong first, const ulong last)
+{
+  for (ulong step = first; step < last; step++) {
     system->moveSettings.AdjustMoves(step);
     system->ChooseAndRunMove(step);
     cpu->Output(step);
@@ -84,8 +93,14 @@ void Simulation::RunSimulation(void)
       RunningCheck(step);
 #endif
   }
+}
+
+void Simulation::Finish(void)
+{
   system->PrintAcceptance();
   system->PrintTime();
+  if (totalSteps > startStep)
+    PROFILE_REPORT(totalSteps - 1);
 }
 
 #ifndef NDEBUG
@@ -21,6 +21,32 @@ public:
 
   void RunSimulation(void);
 
+  //! Runs the moves and output of steps [first, last)
+  void RunSteps(const ulong first, const ulong last);
+  //! Prints the acceptance, timing and profile of the finished run
+  void Finish(void);
+
+  ulong StartStep(void) const
+  {
+    return startStep;
+  }
+  ulong TotalSteps(void) const
+  {
+    return totalSteps;
+  }
+  System& GetSystem(void)
+  {
+    return *system;
+  }
+  StaticVals& GetStaticVals(void)
+  {
+    return *staticValues;
+  }
+  Setup const& GetSetup(void) const
+  {
+    return set;
+  }
+
 #ifndef NDEBUG
   void RunningCheck(const uint step);
 #endif
@@ -34,6 +60,7 @@ private:
   std::vector<ulong> frameSteps;
   uint remarksCount;
   ulong startStep;
+  double startEnergy;
 };
 
 #endif /*SIMULATION_H*/
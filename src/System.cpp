@@ -8,6 +8,7 @@ along with this program, also can be found at <http://www.gnu.org/licenses/>.
 #include "System.h"
 #include "CalculateEnergy.h"
 #include "EwaldCached.h"
+#include "EwaldPME.h"
 #include "Ewald.h"
 #include "NoEwald.h"
 #include "EnergyTypes.h"
@@ -30,6 +31,7 @@ along with this program, also can be found at <http://www.gnu.org/licenses/>.
 #include "IntraMoleculeExchange2.h"
 #include "IntraMoleculeExchange3.h"
 #include "CrankShaft.h"
+#include "Profiler.h"
 
 System::System(StaticVals& statics) :
   statV(statics),
@@ -47,7 +49,9 @@ System::System(StaticVals& statics) :
   coordinates(boxDimRef, com, molLookupRef, prng, statics.mol),
   com(boxDimRef, coordinates, molLookupRef, statics.mol),
   moveSettings(boxDimRef), cellList(statics.mol, boxDimRef),
-  calcEnergy(statics, *this), checkpointSet(*this, statics)
+  verletList(statics.mol, boxDimRef),
+  calcEnergy(statics, *this), checkpointSet(*this, statics),
+  stateFingerprint(0)
 {
   calcEwald = NULL;
 }
@@ -105,12 +109,28 @@ void System::Init(Setup const& set, ulong & startStep)
   }
 
   com.CalcCOM();
+  if(set.config.sys.ff.frameworkGrid) {
+    config_setup::FFValues const& ff = set.config.sys.ff;
+    frameworkGrid.Init(statV.forcefield, statV.mol, molLookupRef, coordinates,
+                       boxDimRef, ff.gridSpacing, ff.gridInterp, ff.gridFile);
+    for(uint b = 0; b < BOX_TOTAL; b++) {
+      if(frameworkGrid.Active(b)) {
+        cellList.ExcludeFixed(b);
+        verletList.ExcludeFixed(b);
+      }
+    }
+  }
   cellList.SetCutoff();
   cellList.GridAll(boxDimRef, coordinates, molLookupRef);
+  verletList.Init(set.config.sys.ff.verletSkin, coordinates.Count());
+  if(verletList.IsEnabled())
+    cellList.SetVerletList(&verletList);
+  scratch.Init();
 
   //check if we have to use cached version of ewlad or not.
   bool ewald = set.config.sys.elect.ewald;
   bool cached = set.config.sys.elect.cache;
+  bool pme = set.config.sys.elect.pme;
 
 #ifdef GOMC_CUDA
   if(ewald)
@@ -118,8 +138,12 @@ void System::Init(Setup const& set, ulong & startStep)
   else
     calcEwald = new NoEwald(statV, *this);
 #else
-  if (ewald && cached)
-    calcEwald = new EwaldCached(statV, *this);
+  if (ewald && pme)
+    calcEwald = new EwaldPME(statV, *this);
+  else if (ewald && cached && set.config.sys.elect.cacheFloat)
+    calcEwald = new EwaldCached<float>(statV, *this);
+  else if (ewald && cached)
+    calcEwald = new EwaldCached<double>(statV, *this);
   else if (ewald && !cached)
     calcEwald = new Ewald(statV, *this);
   else
@@ -127,8 +151,24 @@ void System::Init(Setup const& set, ulong & startStep)
 #endif
 
   calcEnergy.Init(*this);
-  calcEwald->Init();
-  potential = calcEnergy.SystemTotal();
+  //a checkpoint with the Ewald sums and running energies saves summing
+  //over every atom again
+  bool restartState = set.config.in.restart.restartFromCheckpoint;
+  stateFingerprint = checkpoint::Fingerprint(set.config.sys, statV);
+  if(restartState && checkpointSet.HasState() &&
+      !checkpointSet.HasPotential(stateFingerprint) &&
+      !checkpointSet.HasRecip(stateFingerprint)) {
+    printf("%-40s %-s \n", "Info: Checkpoint state not used",
+           "Force field or settings changed, computing energies again");
+  }
+  if(!(restartState && checkpointSet.HasRecip(stateFingerprint) &&
+       calcEwald->InitFromSums(checkpointSet.RecipReal(),
+                               checkpointSet.RecipImaginary())))
+    calcEwald->Init();
+  if(restartState && checkpointSet.HasPotential(stateFingerprint))
+    checkpointSet.SetPotential(potential);
+  else
+    potential = calcEnergy.SystemTotal();
   InitMoves(set);
   for(uint m = 0; m < mv::MOVE_KINDS_TOTAL; m++)
     moveTime[m] = 0.0;
@@ -215,21 +255,25 @@ void System::RunMove(uint majKind, double draw, const uint step)
 
 uint System::SetParams(const uint kind, const double draw)
 {
+  PROFILE_SCOPE(prof::MoveTimer(kind, prof::PREP));
   return moves[kind]->Prep(draw, statV.movePerc[kind]);
 }
 
 uint System::Transform(const uint kind)
 {
+  PROFILE_SCOPE(prof::MoveTimer(kind, prof::TRANSFORM));
   return moves[kind]->Transform();
 }
 
 void System::CalcEn(const uint kind)
 {
+  PROFILE_SCOPE(prof::MoveTimer(kind, prof::CALC_EN));
   moves[kind]->CalcEn();
 }
 
 void System::Accept(const uint kind, const uint rejectState, const uint step)
 {
+  PROFILE_SCOPE(prof::MoveTimer(kind, prof::ACCEPT));
   moves[kind]->Accept(rejectState, step);
 }
 
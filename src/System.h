@@ -22,6 +22,9 @@ along with this program, also can be found at <http://www.gnu.org/licenses/>.
 #include "MoleculeLookup.h"
 #include "MoveSettings.h"
 #include "CellList.h"
+#include "FrameworkGrid.h"
+#include "VerletList.h"
+#include "Scratch.h"
 #include "Clock.h"
 #include "CheckpointSetup.h"
 
@@ -98,9 +101,15 @@ public:
   CalculateEnergy calcEnergy;
   Ewald *calcEwald;
   CellList cellList;
+  FrameworkGrid frameworkGrid;
+  VerletList verletList;
+  ScratchPool scratch;
   PRNG prng;
 
   CheckpointSetup checkpointSet;
+  //checkpoint::Fingerprint of the settings, saved with the running
+  //energies in checkpoints
+  uint32_t stateFingerprint;
 
   //Procedure to run once move is picked... can also be called directly for
   //debugging...
@@ -0,0 +1,228 @@
+/*******************************************************************************
+GPU OPTIMIZED MONTE CARLO (GOMC) 2.40
+Copyright (C) 2018  GOMC Group
+A copy of the GNU General Public License can be found in the COPYRIGHT.txt
+along with this program, also can be found at <http://www.gnu.org/licenses/>.
+********************************************************************************/
+#include "VerletList.h"
+#include "EnergyTypes.h"            //For BOXES_WITH_U_NB
+#include "BoxDimensions.h"
+#include "BoxDimensionsNonOrth.h"
+#include "Molecules.h"
+#include "MoleculeLookup.h"
+
+#include <algorithm>
+
+const int VerletList::NO_BOX;
+
+VerletList::VerletList(const Molecules& mols, BoxDimensions& dims) :
+  mols(mols), dimensions(dims), grid(mols, dims)
+{
+  skin = halfSkinSq = 0.0;
+  enable = false;
+  for(uint b = 0; b < BOX_TOTAL; b++) {
+    molsInBox[b] = 0;
+    built[b] = excludeFixed[b] = false;
+  }
+}
+
+void VerletList::Init(const double skinVal, const uint atomCount)
+{
+  enable = (skinVal > 0.0);
+  if(!enable)
+    return;
+
+  skin = skinVal;
+  halfSkinSq = 0.25 * skin * skin;
+  grid.SetCutoff(skin);
+
+  refPos.Init(atomCount);
+  neighbors.assign(atomCount, std::vector<int>());
+  atomMol.resize(atomCount);
+  molBox.assign(mols.count, NO_BOX);
+  for(uint m = 0; m < mols.count; ++m) {
+    for(int p = mols.MolStart(m); p != mols.MolEnd(m); ++p) {
+      atomMol[p] = m;
+    }
+  }
+  for(uint b = 0; b < BOX_TOTAL; b++) {
+    molsInBox[b] = 0;
+    built[b] = false;
+  }
+}
+
+bool VerletList::IsValid(const uint box) const
+{
+  XYZ axis = dimensions.GetAxis(box);
+  return built[box] && axis.x == builtAxis[box].x &&
+         axis.y == builtAxis[box].y && axis.z == builtAxis[box].z;
+}
+
+bool VerletList::Moved(const int molIndex, const int box,
+                       const XYZArray& pos) const
+{
+  for(int p = mols.MolStart(molIndex); p != mols.MolEnd(molIndex); ++p) {
+    XYZ disp = dimensions.MinImage(pos.Difference(p, refPos, p), box);
+    if(disp.LengthSq() > halfSkinSq)
+      return true;
+  }
+  return false;
+}
+
+void VerletList::Update(const XYZArray& pos, const MoleculeLookup& lookup,
+                        const uint box)
+{
+  if(!enable || box >= BOXES_WITH_U_NB)
+    return;
+
+  bool rebuild = (!IsValid(box) || lookup.NumInBox(box) != molsInBox[box]);
+  atoms[box].clear();
+  MoleculeLookup::box_iterator it = lookup.BoxBegin(box),
+                               end = lookup.BoxEnd(box);
+  while(it != end) {
+    for(int p = mols.MolStart(*it); p != mols.MolEnd(*it); ++p) {
+      atoms[box].push_back(p);
+    }
+    if(!rebuild)
+      rebuild = (molBox[*it] != box || Moved(*it, box, pos));
+    ++it;
+  }
+
+  if(rebuild)
+    Rebuild(pos, lookup, box);
+}
+
+void VerletList::Rebuild(const XYZArray& pos, const MoleculeLookup& lookup,
+                         const uint box)
+{
+  double rListSq = (dimensions.rCut[box] + skin) *
+                   (dimensions.rCut[box] + skin);
+
+  //Forget everything that was listed in this box
+  for(uint m = 0; m < mols.count; ++m) {
+    if(molBox[m] == (int)box) {
+      for(int p = mols.MolStart(m); p != mols.MolEnd(m); ++p) {
+        neighbors[p].clear();
+      }
+      molBox[m] = NO_BOX;
+    }
+  }
+  molsInBox[box] = 0;
+
+  MoleculeLookup::box_iterator it = lookup.BoxBegin(box),
+                               end = lookup.BoxEnd(box);
+  while(it != end) {
+    //molecule is still listed in the box it came from
+    if(molBox[*it] != NO_BOX)
+      RemoveMol(*it);
+    molBox[*it] = box;
+    ++molsInBox[box];
+    for(int p = mols.MolStart(*it); p != mols.MolEnd(*it); ++p) {
+      refPos.Set(p, pos[p]);
+    }
+    ++it;
+  }
+  grid.GridBox(dimensions, refPos, lookup, box);
+
+  //Each pair is found from its lower index atom only
+  for(it = lookup.BoxBegin(box); it != end; ++it) {
+    if(excludeFixed[box] && lookup.IsFix(*it))
+      continue;
+    for(int p = mols.MolStart(*it); p != mols.MolEnd(*it); ++p) {
+      CellList::Neighbors n = grid.EnumerateLocal(refPos[p], box);
+      while(!n.Done()) {
+        int j = *n;
+        if(j > p && atomMol[j] != atomMol[p]) {
+          XYZ dist = dimensions.MinImage(refPos.Difference(p, j), box);
+          if(dist.LengthSq() < rListSq) {
+            neighbors[p].push_back(j);
+            neighbors[j].push_back(p);
+          }
+        }
+        n.Next();
+      }
+    }
+  }
+
+  built[box] = true;
+  builtAxis[box] = dimensions.GetAxis(box);
+}
+
+void VerletList::AddMol(const int molIndex, const int box, const XYZArray& pos)
+{
+  if(!enable)
+    return;
+
+  //Still within half skin of where it was listed, nothing to patch
+  if(molBox[molIndex] == box && IsValid(box) && !Moved(molIndex, box, pos))
+    return;
+
+  RemoveMol(molIndex);
+  molBox[molIndex] = box;
+  ++molsInBox[box];
+
+  //Box will be rebuilt from scratch on next update
+  if(box >= BOXES_WITH_U_NB || !IsValid(box))
+    return;
+
+  for(int p = mols.MolStart(molIndex); p != mols.MolEnd(molIndex); ++p) {
+    refPos.Set(p, pos[p]);
+  }
+  grid.AddMol(molIndex, box, refPos);
+  ListMol(molIndex, box);
+}
+
+void VerletList::RemoveMol(const int molIndex)
+{
+  int box = molBox[molIndex];
+  if(!enable || box == NO_BOX)
+    return;
+
+  if(box < BOXES_WITH_U_NB && IsValid(box))
+    grid.RemoveMol(molIndex, box, refPos);
+
+  for(int p = mols.MolStart(molIndex); p != mols.MolEnd(molIndex); ++p) {
+    for(uint n = 0; n < neighbors[p].size(); ++n) {
+      std::vector<int>& other = neighbors[neighbors[p][n]];
+      other.erase(std::find(other.begin(), other.end(), p));
+    }
+    neighbors[p].clear();
+  }
+  molBox[molIndex] = NO_BOX;
+  --molsInBox[box];
+}
+
+void VerletList::ListMol(const int molIndex, const int box)
+{
+  double rListSq = (dimensions.rCut[box] + skin) *
+                   (dimensions.rCut[box] + skin);
+
+  for(int p = mols.MolStart(molIndex); p != mols.MolEnd(molIndex); ++p) {
+    CellList::Neighbors n = grid.EnumerateLocal(refPos[p], box);
+    while(!n.Done()) {
+      int j = *n;
+      if(atomMol[j] != molIndex) {
+        XYZ dist = dimensions.MinImage(refPos.Difference(p, j), box);
+        if(dist.LengthSq() < rListSq) {
+          neighbors[p].push_back(j);
+          neighbors[j].push_back(p);
+        }
+      }
+      n.Next();
+    }
+  }
+}
+
+void VerletList::GetPairs(std::vector<uint>& pair1, std::vector<uint>& pair2,
+                          const uint box) const
+{
+  for(uint i = 0; i < atoms[box].size(); ++i) {
+    int p = atoms[box][i];
+    for(uint n = 0; n < neighbors[p].size(); ++n) {
+      if(p < neighbors[p][n]) {
+        pair1.push_back(p);
+        pair2.push_back(neighbors[p][n]);
+      }
+    }
+  }
+}
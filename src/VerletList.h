@@ -0,0 +1,99 @@
+/*******************************************************************************
+GPU OPTIMIZED MONTE CARLO (GOMC) 2.40
+Copyright (C) 2018  GOMC Group
+A copy of the GNU General Public License can be found in the COPYRIGHT.txt
+along with this program, also can be found at <http://www.gnu.org/licenses/>.
+********************************************************************************/
+#ifndef VERLETLIST_H
+#define VERLETLIST_H
+#include "BasicTypes.h"
+#include "EnsemblePreprocessor.h"
+#include "CellList.h"
+#include "XYZArray.h"
+#include <vector>
+
+class Molecules;
+class BoxDimensions;
+class MoleculeLookup;
+
+//
+//    VerletList.h
+//    Optional Verlet neighbor list with a skin, kept next to the cell list.
+//    Each atom stores every atom of other molecules that was within
+//    rCut + skin of it at the time it was listed. The list stays valid as
+//    long as no atom moved more than skin/2 from its reference position,
+//    so full box rebuilds are only needed after volume moves or when the
+//    half skin criterion is violated. Single molecule moves patch the list
+//    through AddMol, which is forwarded by CellList::AddMol.
+//
+
+class VerletList
+{
+public:
+  VerletList(const Molecules& mols, BoxDimensions& dims);
+
+  //! Enable the list with the given skin (skin <= 0 leaves it disabled)
+  void Init(const double skin, const uint atomCount);
+
+  bool IsEnabled() const
+  {
+    return enable;
+  }
+
+  //! Leave the fixed molecules of box out of the list (see CellList)
+  void ExcludeFixed(const uint box)
+  {
+    grid.ExcludeFixed(box);
+    excludeFixed[box] = true;
+  }
+
+  //! Rebuild the list of box if it is no longer valid for pos
+  void Update(const XYZArray& pos, const MoleculeLookup& lookup,
+              const uint box);
+
+  //! Relist molecule at pos in box, if it moved more than skin/2
+  //! or changed box. Called after every accepted/rejected move.
+  void AddMol(const int molIndex, const int box, const XYZArray& pos);
+
+  //! Drop all pairs of the molecule from the list
+  void RemoveMol(const int molIndex);
+
+  //! Append all distinct pairs of box in the list (i < j, different mols)
+  void GetPairs(std::vector<uint>& pair1, std::vector<uint>& pair2,
+                const uint box) const;
+
+private:
+  static const int NO_BOX = -1;
+
+  //! Build the list of box from scratch at pos
+  void Rebuild(const XYZArray& pos, const MoleculeLookup& lookup,
+               const uint box);
+
+  //! true if box was built and axes did not change since
+  bool IsValid(const uint box) const;
+
+  //! true if any atom of the molecule moved more than half skin
+  bool Moved(const int molIndex, const int box, const XYZArray& pos) const;
+
+  //! Find neighbors of all atoms of molIndex, which must be binned already
+  void ListMol(const int molIndex, const int box);
+
+  const Molecules& mols;
+  BoxDimensions& dimensions;
+  CellList grid;                //binning of reference positions
+
+  XYZArray refPos;              //positions at the time atoms got listed
+  std::vector< std::vector<int> > neighbors;
+  std::vector<int> atomMol;
+  std::vector<int> molBox;      //box each molecule is listed in
+  std::vector<int> atoms[BOX_TOTAL];
+  uint molsInBox[BOX_TOTAL];
+  bool built[BOX_TOTAL];
+  bool excludeFixed[BOX_TOTAL];
+  XYZ builtAxis[BOX_TOTAL];
+
+  double skin, halfSkinSq;
+  bool enable;
+};
+
+#endif /*VERLETLIST_H*/
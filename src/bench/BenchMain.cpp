@@ -0,0 +1,512 @@
+/*******************************************************************************
+GPU OPTIMIZED MONTE CARLO (GOMC) 2.40
+Copyright (C) 2018  GOMC Group
+A copy of the GNU General Public License can be found in the COPYRIGHT.txt
+along with this program, also can be found at <http://www.gnu.org/licenses/>.
+********************************************************************************/
+
+//
+//    BenchMain.cpp
+//    GOMC_Bench, times the energy kernels, Ewald routines, cell list, CBMC
+//    components and whole moves of the synthetic systems of BenchSystems.h
+//    for a range of system sizes and thread counts.
+//
+//    Usage: GOMC_Bench [--systems lj,water,alkane,ionic]
+//                      [--molecules 256,1024,4096] [--threads 1,<max>]
+//                      [--time 0.3] [--output bench.json]
+//
+//    Every benchmark is repeated until it ran for --time seconds and at
+//    least MIN_CALLS times. Kernels work on the molecules of box 0 in turn.
+//    The CBMC components are timed by the profiler, which is built into the
+//    benchmark, so all timings include its (small) overhead.
+//
+//    The results are written to one JSON file, one result per line with
+//    the keys always in the same order, so runs of different commits can
+//    be compared line by line.
+//
+
+#include "BenchSystems.h"
+#include "Setup.h"
+#include "StaticVals.h"
+#include "System.h"
+#include "TrialMol.h"
+#include "Profiler.h"
+#include "GOMC_Config.h"    //For version number
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+const uint SEED = 50;
+const ulong MIN_CALLS = 3;
+const uint TRIAL_SETS = 64;
+
+struct Options {
+  std::vector<std::string> systems;
+  std::vector<uint> molecules, threads;
+  double minTime;
+  std::string output;
+};
+
+struct Result {
+  std::string system, name;
+  uint molecules, atoms, threads;
+  ulong calls;
+  double seconds;
+};
+
+//A system read from the generated input, as Simulation sets it up but
+//without any output
+struct Context {
+  explicit Context(std::string const& confFile);
+  ~Context();
+
+  Setup set;
+  StaticVals* statV;
+  System* sys;
+  //molecules of box 0 when the benchmarks start, and their coordinates
+  std::vector<uint> mols;
+  std::vector<XYZArray> molCoords;
+  uint step;
+};
+
+Context::Context(std::string const& confFile) : step(0)
+{
+  set.Init(confFile.c_str());
+  statV = new StaticVals(set);
+  sys = new System(*statV);
+  statV->Init(set, *sys);
+  ulong startStep = 0;
+  sys->Init(set, startStep);
+  statV->InitOver(set, *sys);
+
+  MoleculeLookup::box_iterator m = sys->molLookupRef.BoxBegin(0);
+  MoleculeLookup::box_iterator end = sys->molLookupRef.BoxEnd(0);
+  for (; m != end; ++m) {
+    uint length = statV->mol.GetKind(*m).NumAtoms();
+    XYZArray coords(length);
+    sys->coordinates.CopyRange(coords, statV->mol.MolStart(*m), 0, length);
+    mols.push_back(*m);
+    molCoords.push_back(coords);
+  }
+}
+
+Context::~Context()
+{
+  delete sys;
+  delete statV;
+}
+
+//One benchmark, Run is called with the number of calls made so far
+class Kernel
+{
+public:
+  virtual ~Kernel() {}
+  virtual void Run(const ulong call) = 0;
+};
+
+class BoxInterBench : public Kernel
+{
+public:
+  explicit BoxInterBench(Context& c) : ctx(c) {}
+  virtual void Run(const ulong call)
+  {
+    System& sys = *ctx.sys;
+    sys.calcEnergy.BoxInter(SystemPotential(), sys.coordinates, sys.com,
+                            sys.boxDimRef, 0);
+  }
+private:
+  Context& ctx;
+};
+
+class MoleculeInterBench : public Kernel
+{
+public:
+  explicit MoleculeInterBench(Context& c) : ctx(c) {}
+  virtual void Run(const ulong call)
+  {
+    uint i = call % ctx.mols.size();
+    Intermolecular lj, coulomb;
+    ctx.sys->calcEnergy.MoleculeInter(lj, coulomb, ctx.molCoords[i],
+                                      ctx.mols[i], 0);
+  }
+private:
+  Context& ctx;
+};
+
+//Trials of the first atom of a molecule at random positions in box 0
+class ParticleInterBench : public Kernel
+{
+public:
+  explicit ParticleInterBench(Context& c) :
+    ctx(c), trials(c.set.config.sys.cbmcTrials.nonbonded.first),
+    en(trials), real(trials), overlap(new bool[trials])
+  {
+    XYZ axis = ctx.sys->boxDimRef.GetAxis(0);
+    for (uint s = 0; s < TRIAL_SETS; s++) {
+      XYZArray pos(trials);
+      for (uint t = 0; t < trials; t++)
+        pos.Set(t, ctx.sys->prng.rand(axis.x), ctx.sys->prng.rand(axis.y),
+                ctx.sys->prng.rand(axis.z));
+      trialPos.push_back(pos);
+    }
+  }
+  ~ParticleInterBench()
+  {
+    delete[] overlap;
+  }
+  virtual void Run(const ulong call)
+  {
+    std::fill(en.begin(), en.end(), 0.0);
+    std::fill(real.begin(), real.end(), 0.0);
+    std::fill(overlap, overlap + trials, false);
+    ctx.sys->calcEnergy.ParticleInter(&en[0], &real[0],
+                                      trialPos[call % TRIAL_SETS], overlap,
+                                      0, ctx.mols[call % ctx.mols.size()],
+                                      0, trials, nb);
+  }
+private:
+  Context& ctx;
+  uint trials;
+  std::vector<double> en, real;
+  bool* overlap;
+  std::vector<XYZArray> trialPos;
+  TrialNeighbors nb;
+};
+
+class BoxRecipSetupBench : public Kernel
+{
+public:
+  explicit BoxRecipSetupBench(Context& c) : ctx(c) {}
+  virtual void Run(const ulong call)
+  {
+    ctx.sys->calcEwald->BoxReciprocalSetup(0, ctx.sys->coordinates);
+  }
+private:
+  Context& ctx;
+};
+
+class MolRecipBench : public Kernel
+{
+public:
+  explicit MolRecipBench(Context& c) : ctx(c) {}
+  virtual void Run(const ulong call)
+  {
+    uint i = call % ctx.mols.size();
+    ctx.sys->calcEwald->MolReciprocal(ctx.molCoords[i], ctx.mols[i], 0);
+    ctx.sys->calcEwald->RestoreMol(ctx.mols[i]);
+  }
+private:
+  Context& ctx;
+};
+
+class GridAllBench : public Kernel
+{
+public:
+  explicit GridAllBench(Context& c) : ctx(c) {}
+  virtual void Run(const ulong call)
+  {
+    System& sys = *ctx.sys;
+    sys.cellList.GridAll(sys.boxDimRef, sys.coordinates, sys.molLookupRef);
+  }
+private:
+  Context& ctx;
+};
+
+//Regrows a molecule of box 0 in place as the swap (Build), regrowth and
+//crank shaft moves do, the latter two only if the system uses the move.
+//Nothing is accepted, the molecule keeps its coordinates.
+class CBMCBench : public Kernel
+{
+public:
+  explicit CBMCBench(Context& c) : ctx(c)
+  {
+    regrowth = c.statV->movePerc[mv::REGROWTH] > 0.0;
+    crankShaft = c.statV->movePerc[mv::CRANKSHAFT] > 0.0;
+  }
+  virtual void Run(const ulong call)
+  {
+    System& sys = *ctx.sys;
+    uint m = ctx.mols[call % ctx.mols.size()];
+    MoleculeKind& kind = ctx.statV->mol.kinds[ctx.statV->mol.kIndex[m]];
+    sys.cellList.RemoveMol(m, 0, sys.coordinates);
+    Prep(kind, m);
+    kind.Build(oldMol, newMol, m);
+    if (regrowth) {
+      Prep(kind, m);
+      kind.Regrowth(oldMol, newMol, m);
+    }
+    if (crankShaft) {
+      Prep(kind, m);
+      kind.CrankShaft(oldMol, newMol, m);
+    }
+    sys.cellList.AddMol(m, 0, sys.coordinates);
+  }
+private:
+  void Prep(MoleculeKind const& kind, const uint m)
+  {
+    System& sys = *ctx.sys;
+    newMol.Reset(kind, sys.boxDimRef, 0);
+    oldMol.Reset(kind, sys.boxDimRef, 0);
+    oldMol.SetCoords(sys.coordinates, ctx.statV->mol.MolStart(m));
+  }
+
+  Context& ctx;
+  bool regrowth, crankShaft;
+  cbmc::TrialMol oldMol, newMol;
+};
+
+class MoveBench : public Kernel
+{
+public:
+  MoveBench(Context& c, const uint k) : ctx(c), kind(k) {}
+  virtual void Run(const ulong call)
+  {
+    System& sys = *ctx.sys;
+    sys.moveSettings.AdjustMoves(ctx.step);
+    sys.RunMove(kind, sys.prng.rand(ctx.statV->movePerc[kind]), ctx.step++);
+  }
+private:
+  Context& ctx;
+  uint kind;
+};
+
+//Runs kernel until it took minTime seconds and at least MIN_CALLS calls,
+//after one call to warm up
+Result Time(Kernel& kernel, std::string const& name, const double minTime)
+{
+  kernel.Run(0);
+  Result r;
+  r.name = name;
+  r.calls = 0;
+  double start = prof::Now();
+  do {
+    kernel.Run(r.calls++);
+    r.seconds = prof::Now() - start;
+  } while (r.seconds < minTime || r.calls < MIN_CALLS);
+  return r;
+}
+
+class Runner
+{
+public:
+  Runner(std::string const& system, const uint molecules, const uint threads,
+         Context& c, Options const& opt, std::vector<Result>& out) :
+    sys(system), mol(molecules), thr(threads), ctx(c), minTime(opt.minTime),
+    results(out) {}
+
+  void Add(Kernel& kernel, std::string const& name)
+  {
+    Add(Time(kernel, name, minTime));
+  }
+
+  void Add(Result r)
+  {
+    r.system = sys;
+    r.molecules = mol;
+    r.atoms = ctx.sys->coordinates.Count();
+    r.threads = thr;
+    results.push_back(r);
+    printf("%-8s %6u %3u %-28s %10lu %14.6e\n", sys.c_str(), mol, thr,
+           r.name.c_str(), r.calls, r.seconds / r.calls);
+  }
+
+  void RunAll();
+
+private:
+  std::string sys;
+  uint mol, thr;
+  Context& ctx;
+  double minTime;
+  std::vector<Result>& results;
+};
+
+void Runner::RunAll()
+{
+  BoxInterBench boxInter(ctx);
+  Add(boxInter, "BoxInter");
+  MoleculeInterBench molInter(ctx);
+  Add(molInter, "MoleculeInter");
+  ParticleInterBench particleInter(ctx);
+  Add(particleInter, "ParticleInter");
+  if (ctx.statV->forcefield.ewald) {
+    BoxRecipSetupBench boxRecip(ctx);
+    Add(boxRecip, "BoxReciprocalSetup");
+    MolRecipBench molRecip(ctx);
+    Add(molRecip, "MolReciprocal");
+  }
+  GridAllBench gridAll(ctx);
+  Add(gridAll, "CellList.GridAll");
+
+  //the components each CBMC call went through, from the profiler
+  double seconds[prof::MOVE_TIMERS];
+  ulong calls[prof::MOVE_TIMERS];
+  for (uint t = prof::DC_SINGLE; t < prof::MOVE_TIMERS; t++) {
+    seconds[t] = prof::profiler.Seconds(t);
+    calls[t] = prof::profiler.Calls(t);
+  }
+  CBMCBench cbmc(ctx);
+  Add(cbmc, "CBMC");
+  for (uint t = prof::DC_SINGLE; t < prof::MOVE_TIMERS; t++) {
+    Result r;
+    r.name = "CBMC." + prof::profiler.Name(t);
+    r.calls = prof::profiler.Calls(t) - calls[t];
+    r.seconds = prof::profiler.Seconds(t) - seconds[t];
+    if (r.calls != 0)
+      Add(r);
+  }
+
+  //moves last, they change the system
+  for (uint k = 0; k < mv::MOVE_KINDS_TOTAL; k++) {
+    if (ctx.statV->movePerc[k] == 0.0)
+      continue;
+    MoveBench move(ctx, k);
+    Add(move, "Move." + prof::MoveName(k));
+  }
+}
+
+void WriteJSON(std::string const& file, Options const& opt,
+               std::vector<Result> const& results)
+{
+  std::ofstream out(file.c_str(), std::ios::out | std::ios::trunc);
+  if (!out.is_open()) {
+    std::cout << "Error: Cannot open benchmark output file " << file << "!\n";
+    exit(EXIT_FAILURE);
+  }
+  out << std::setprecision(9);
+  out << "{\n  \"format\": \"gomc-bench-1\",\n  \"version\": \""
+      << GOMC_VERSION_MAJOR << '.' << GOMC_VERSION_MINOR << "\",\n"
+      << "  \"min_time\": " << opt.minTime << ",\n  \"results\": [";
+  for (uint i = 0; i < results.size(); i++) {
+    Result const& r = results[i];
+    out << (i == 0 ? "\n" : ",\n") << "    {\"system\": \"" << r.system
+        << "\", \"molecules\": " << r.molecules << ", \"atoms\": " << r.atoms
+        << ", \"threads\": " << r.threads << ", \"name\": \"" << r.name
+        << "\", \"calls\": " << r.calls << ", \"seconds\": " << r.seconds
+        << ", \"per_call\": " << r.seconds / r.calls << "}";
+  }
+  out << "\n  ]\n}\n";
+}
+
+std::vector<std::string> Split(std::string const& list)
+{
+  std::vector<std::string> items;
+  std::stringstream stream(list);
+  std::string item;
+  while (std::getline(stream, item, ','))
+    if (!item.empty())
+      items.push_back(item);
+  return items;
+}
+
+std::vector<uint> SplitNum(std::string const& list, const char* option)
+{
+  std::vector<std::string> items = Split(list);
+  std::vector<uint> nums;
+  for (uint i = 0; i < items.size(); i++) {
+    uint n = atoi(items[i].c_str());
+    if (n == 0) {
+      std::cout << "Error: Invalid value " << items[i] << " of " << option
+                << "!\n";
+      exit(EXIT_FAILURE);
+    }
+    nums.push_back(n);
+  }
+  return nums;
+}
+
+void PrintUsage()
+{
+  std::cout << "Usage: GOMC_Bench [--systems lj,water,alkane,ionic] "
+            << "[--molecules 256,1024,4096]\n"
+            << "                  [--threads 1,<max>] [--time 0.3] "
+            << "[--output bench.json]\n";
+}
+
+Options ReadOptions(int argc, char *argv[])
+{
+  Options opt;
+  opt.systems = bench::SystemNames();
+  opt.molecules.push_back(256);
+  opt.molecules.push_back(1024);
+  opt.molecules.push_back(4096);
+  opt.threads.push_back(1);
+#ifdef _OPENMP
+  if (omp_get_max_threads() > 1)
+    opt.threads.push_back(omp_get_max_threads());
+#endif
+  opt.minTime = 0.3;
+  opt.output = "bench.json";
+
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    if (arg == "--help" || arg == "-h") {
+      PrintUsage();
+      exit(EXIT_SUCCESS);
+    }
+    if (i + 1 == argc) {
+      std::cout << "Error: Missing value of " << arg << "!\n";
+      PrintUsage();
+      exit(EXIT_FAILURE);
+    }
+    std::string value = argv[++i];
+    if (arg == "--systems") {
+      opt.systems = Split(value);
+      for (uint s = 0; s < opt.systems.size(); s++) {
+        if (!bench::IsSystem(opt.systems[s])) {
+          std::cout << "Error: Unknown benchmark system " << opt.systems[s]
+                    << "!\n";
+          exit(EXIT_FAILURE);
+        }
+      }
+    } else if (arg == "--molecules") {
+      opt.molecules = SplitNum(value, "--molecules");
+    } else if (arg == "--threads") {
+      opt.threads = SplitNum(value, "--threads");
+    } else if (arg == "--time") {
+      opt.minTime = atof(value.c_str());
+    } else if (arg == "--output") {
+      opt.output = value;
+    } else {
+      std::cout << "Error: Unknown option " << arg << "!\n";
+      PrintUsage();
+      exit(EXIT_FAILURE);
+    }
+  }
+  return opt;
+}
+}
+
+int main(int argc, char *argv[])
+{
+  Options opt = ReadOptions(argc, argv);
+  std::vector<Result> results;
+
+  for (uint s = 0; s < opt.systems.size(); s++) {
+    for (uint n = 0; n < opt.molecules.size(); n++) {
+      std::string conf = bench::WriteSystem(opt.systems[s], opt.molecules[n],
+                                            SEED);
+      for (uint t = 0; t < opt.threads.size(); t++) {
+#ifdef _OPENMP
+        omp_set_num_threads(opt.threads[t]);
+        omp_set_max_active_levels(2);
+#endif
+        Context ctx(conf);
+        Runner runner(opt.systems[s], opt.molecules[n], opt.threads[t], ctx,
+                      opt, results);
+        runner.RunAll();
+      }
+      bench::RemoveSystem(opt.systems[s], opt.molecules[n]);
+    }
+  }
+
+  WriteJSON(opt.output, opt, results);
+  std::cout << "Info: Benchmark results written to " << opt.output << '\n';
+  return 0;
+}
@@ -0,0 +1,465 @@
+/*******************************************************************************
+GPU OPTIMIZED MONTE CARLO (GOMC) 2.40
+Copyright (C) 2018  GOMC Group
+A copy of the GNU General Public License can be found in the COPYRIGHT.txt
+along with this program, also can be found at <http://www.gnu.org/licenses/>.
+********************************************************************************/
+#include "BenchSystems.h"
+#include "MersenneTwister.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <utility>
+
+namespace
+{
+//Smallest box edge. Volume moves must not shrink a box below twice the
+//cutoff, which ends the run, so leave room for them.
+const double RCUT = 9.0;
+const double MIN_EDGE = 3.0 * RCUT;
+const double PI = 3.14159265358979323846;
+
+struct Site {
+  Site(const char* n, const char* t, const double q, const double m,
+       XYZ const& p) : name(n), type(t), charge(q), mass(m), pos(p) {}
+  std::string name, type;
+  double charge, mass;
+  XYZ pos;
+};
+
+struct Kind {
+  explicit Kind(const char* res) : resName(res) {}
+  void Bond(const uint a, const uint b)
+  {
+    bonds.push_back(std::make_pair(a, b));
+  }
+  std::string resName;
+  std::vector<Site> sites;
+  std::vector<std::pair<uint, uint> > bonds;
+};
+
+struct SystemDef {
+  std::vector<Kind> kinds;
+  double density;     //molecules per A^3
+  double temperature;
+  bool charged;
+  std::string params, moves;
+};
+
+SystemDef Define(std::string const& name)
+{
+  SystemDef def;
+  def.charged = false;
+  if (name == "lj") {
+    Kind ar("AR");
+    ar.sites.push_back(Site("AR", "AR", 0.0, 39.948, XYZ()));
+    def.kinds.push_back(ar);
+    def.density = 0.02;
+    def.temperature = 100.0;
+    def.params = "NONBONDED\n"
+                 "AR 0.0 -0.238 1.911\n";
+    def.moves = "DisFreq 0.70\n"
+                "RotFreq 0.00\n"
+                "VolFreq 0.02\n"
+                "SwapFreq 0.28\n"
+                "RegrowthFreq 0.00\n"
+                "IntraSwapFreq 0.00\n"
+                "CrankShaftFreq 0.00\n";
+  } else if (name == "water") {
+    //SPC/E
+    const double theta = 109.47 * PI / 180.0;
+    Kind wat("WAT");
+    wat.sites.push_back(Site("O1", "OT", -0.8476, 15.999, XYZ()));
+    wat.sites.push_back(Site("H1", "HT", 0.4238, 1.008, XYZ(1.0, 0.0, 0.0)));
+    wat.sites.push_back(Site("H2", "HT", 0.4238, 1.008,
+                             XYZ(cos(theta), sin(theta), 0.0)));
+    wat.Bond(0, 1);
+    wat.Bond(0, 2);
+    def.kinds.push_back(wat);
+    def.density = 0.03;
+    def.temperature = 298.0;
+    def.charged = true;
+    def.params = "BONDS\n"
+                 "OT HT 999999999 1.0\n"
+                 "ANGLES\n"
+                 "HT OT HT 999999999 109.47\n"
+                 "NONBONDED\n"
+                 "OT 0.0 -0.1553 1.7767\n"
+                 "HT 0.0 -0.0 0.0\n";
+    def.moves = "DisFreq 0.40\n"
+                "RotFreq 0.20\n"
+                "VolFreq 0.02\n"
+                "SwapFreq 0.28\n"
+                "RegrowthFreq 0.10\n"
+                "IntraSwapFreq 0.00\n"
+                "CrankShaftFreq 0.00\n";
+  } else if (name == "alkane") {
+    //2-methylbutane, united atom, tetrahedral around the branch point
+    const double b = 1.54 / sqrt(3.0);
+    Kind mb("MBU");
+    mb.sites.push_back(Site("C1", "CH3", 0.0, 15.035, XYZ(b, b, b)));
+    mb.sites.push_back(Site("C2", "CH", 0.0, 13.019, XYZ()));
+    mb.sites.push_back(Site("C3", "CH2", 0.0, 14.027, XYZ(-b, b, -b)));
+    mb.sites.push_back(Site("C4", "CH3", 0.0, 15.035,
+                            XYZ(-2.0 * b, 0.0, -2.0 * b)));
+    mb.sites.push_back(Site("C5", "CH3", 0.0, 15.035, XYZ(b, -b, -b)));
+    mb.Bond(0, 1);
+    mb.Bond(1, 2);
+    mb.Bond(2, 3);
+    mb.Bond(1, 4);
+    def.kinds.push_back(mb);
+    def.density = 0.004;
+    def.temperature = 300.0;
+    def.params = "BONDS\n"
+                 "CH3 CH 999999999 1.54\n"
+                 "CH CH2 999999999 1.54\n"
+                 "CH2 CH3 999999999 1.54\n"
+                 "ANGLES\n"
+                 "CH3 CH CH3 62.1 112.0\n"
+                 "CH3 CH CH2 62.1 112.0\n"
+                 "CH CH2 CH3 62.1 112.0\n"
+                 "DIHEDRALS\n"
+                 "CH3 CH CH2 CH3 0.5 3 0.0\n"
+                 "NONBONDED\n"
+                 "CH3 0.0 -0.1947 2.1046\n"
+                 "CH2 0.0 -0.0914 2.2169\n"
+                 "CH 0.0 -0.01987 2.6266\n";
+    def.moves = "DisFreq 0.30\n"
+                "RotFreq 0.10\n"
+                "VolFreq 0.02\n"
+                "SwapFreq 0.20\n"
+                "RegrowthFreq 0.20\n"
+                "IntraSwapFreq 0.08\n"
+                "CrankShaftFreq 0.10\n";
+  } else {
+    //coarse grained ionic liquid, two site cation and one site anion
+    Kind cat("CAT"), ani("ANI");
+    cat.sites.push_back(Site("C1", "CA1", 0.6, 30.0, XYZ()));
+    cat.sites.push_back(Site("C2", "CA2", 0.4, 30.0, XYZ(2.0, 0.0, 0.0)));
+    cat.Bond(0, 1);
+    ani.sites.push_back(Site("A1", "AN", -1.0, 60.0, XYZ()));
+    def.kinds.push_back(cat);
+    def.kinds.push_back(ani);
+    def.density = 0.008;
+    def.temperature = 400.0;
+    def.charged = true;
+    def.params = "BONDS\n"
+                 "CA1 CA2 999999999 2.0\n"
+                 "NONBONDED\n"
+                 "CA1 0.0 -0.2 2.0\n"
+                 "CA2 0.0 -0.2 2.0\n"
+                 "AN 0.0 -0.2 2.2\n";
+    def.moves = "DisFreq 0.40\n"
+                "RotFreq 0.20\n"
+                "VolFreq 0.02\n"
+                "SwapFreq 0.28\n"
+                "RegrowthFreq 0.10\n"
+                "IntraSwapFreq 0.00\n"
+                "CrankShaftFreq 0.00\n";
+  }
+  return def;
+}
+
+std::string Prefix(std::string const& name, const uint molecules)
+{
+  char buf[32];
+  sprintf(buf, "_%u", molecules);
+  return "bench_" + name + buf;
+}
+
+std::string BoxFile(std::string const& prefix, const uint box,
+                    const char* ext)
+{
+  char buf[16];
+  sprintf(buf, "_box%u.", box);
+  return prefix + buf + ext;
+}
+
+FILE* Open(std::string const& file)
+{
+  FILE* out = fopen(file.c_str(), "w");
+  if (out == NULL) {
+    std::cout << "Error: Cannot open benchmark input file " << file << "!\n";
+    exit(EXIT_FAILURE);
+  }
+  return out;
+}
+
+//Uniform random rotation, from a random unit quaternion
+void RandomRotation(double rot[3][3], MTRand& rand)
+{
+  double u1 = rand.rand(), u2 = 2.0 * PI * rand.rand();
+  double u3 = 2.0 * PI * rand.rand();
+  double x = sqrt(1.0 - u1) * sin(u2), y = sqrt(1.0 - u1) * cos(u2);
+  double z = sqrt(u1) * sin(u3), w = sqrt(u1) * cos(u3);
+  rot[0][0] = 1.0 - 2.0 * (y * y + z * z);
+  rot[0][1] = 2.0 * (x * y - z * w);
+  rot[0][2] = 2.0 * (x * z + y * w);
+  rot[1][0] = 2.0 * (x * y + z * w);
+  rot[1][1] = 1.0 - 2.0 * (x * x + z * z);
+  rot[1][2] = 2.0 * (y * z - x * w);
+  rot[2][0] = 2.0 * (x * z - y * w);
+  rot[2][1] = 2.0 * (y * z + x * w);
+  rot[2][2] = 1.0 - 2.0 * (x * x + y * y);
+}
+
+//Angles and dihedrals of a kind, from its bond graph
+void Topology(Kind const& kind, std::vector<std::vector<uint> >& angles,
+              std::vector<std::vector<uint> >& dihedrals)
+{
+  uint n = kind.sites.size();
+  std::vector<std::vector<uint> > partners(n);
+  for (uint i = 0; i < kind.bonds.size(); i++) {
+    partners[kind.bonds[i].first].push_back(kind.bonds[i].second);
+    partners[kind.bonds[i].second].push_back(kind.bonds[i].first);
+  }
+  for (uint j = 0; j < n; j++) {
+    for (uint a = 0; a < partners[j].size(); a++) {
+      for (uint c = a + 1; c < partners[j].size(); c++) {
+        std::vector<uint> angle(3);
+        angle[0] = partners[j][a];
+        angle[1] = j;
+        angle[2] = partners[j][c];
+        angles.push_back(angle);
+      }
+    }
+  }
+  for (uint i = 0; i < kind.bonds.size(); i++) {
+    uint j = kind.bonds[i].first, k = kind.bonds[i].second;
+    for (uint a = 0; a < partners[j].size(); a++) {
+      for (uint c = 0; c < partners[k].size(); c++) {
+        uint first = partners[j][a], last = partners[k][c];
+        if (first == k || last == j || first == last)
+          continue;
+        std::vector<uint> dih(4);
+        dih[0] = first;
+        dih[1] = j;
+        dih[2] = k;
+        dih[3] = last;
+        dihedrals.push_back(dih);
+      }
+    }
+  }
+}
+
+//Writes the PDB and PSF of one box, count[k] molecules of each kind
+void WriteBox(std::string const& prefix, const uint box, SystemDef const& def,
+              std::vector<uint> const& count, const double edge,
+              MTRand& rand)
+{
+  uint total = 0;
+  for (uint k = 0; k < count.size(); k++)
+    total += count[k];
+  uint perSide = (uint)ceil(pow((double)total, 1.0 / 3.0) - 1e-9);
+  double spacing = edge / perSide;
+  std::vector<XYZ> lattice;
+  for (uint i = 0; i < perSide; i++)
+    for (uint j = 0; j < perSide; j++)
+      for (uint l = 0; l < perSide; l++)
+        lattice.push_back(XYZ((i + 0.5) * spacing, (j + 0.5) * spacing,
+                              (l + 0.5) * spacing));
+  for (uint i = lattice.size() - 1; i > 0; i--)
+    std::swap(lattice[i], lattice[rand.randInt(i)]);
+
+  FILE* pdb = Open(BoxFile(prefix, box, "pdb"));
+  FILE* psf = Open(BoxFile(prefix, box, "psf"));
+  fprintf(pdb, "CRYST1%9.3f%9.3f%9.3f%7.2f%7.2f%7.2f P 1           1\n",
+          edge, edge, edge, 90.0, 90.0, 90.0);
+
+  uint atoms = 0;
+  for (uint k = 0; k < count.size(); k++)
+    atoms += count[k] * def.kinds[k].sites.size();
+  fprintf(psf, "PSF\n\n       1 !NTITLE\n REMARKS GOMC benchmark\n\n");
+  fprintf(psf, "%8u !NATOM\n", atoms);
+
+  std::vector<std::vector<uint> > bonds, angles, dihedrals;
+  uint atom = 0, mol = 0;
+  for (uint k = 0; k < count.size(); k++) {
+    Kind const& kind = def.kinds[k];
+    std::vector<std::vector<uint> > kindAngles, kindDihedrals;
+    Topology(kind, kindAngles, kindDihedrals);
+
+    XYZ center;
+    for (uint s = 0; s < kind.sites.size(); s++)
+      center += kind.sites[s].pos;
+    center *= 1.0 / kind.sites.size();
+
+    for (uint m = 0; m < count[k]; m++, mol++) {
+      double rot[3][3];
+      RandomRotation(rot, rand);
+      XYZ site = lattice[mol];
+      for (uint s = 0; s < kind.sites.size(); s++) {
+        XYZ p = kind.sites[s].pos - center;
+        double pos[3] = {
+          site.x + rot[0][0] * p.x + rot[0][1] * p.y + rot[0][2] * p.z,
+          site.y + rot[1][0] * p.x + rot[1][1] * p.y + rot[1][2] * p.z,
+          site.z + rot[2][0] * p.x + rot[2][1] * p.y + rot[2][2] * p.z
+        };
+        for (uint d = 0; d < 3; d++)
+          pos[d] -= edge * floor(pos[d] / edge);
+        fprintf(pdb, "ATOM  %5u %-4s %-4s %4u    %8.3f%8.3f%8.3f%6.2f%6.2f"
+                "          %2c\n", (atom + s + 1) % 100000,
+                kind.sites[s].name.c_str(), kind.resName.c_str(),
+                (mol + 1) % 10000, pos[0], pos[1], pos[2], 0.0, 0.0,
+                kind.sites[s].name[0]);
+        fprintf(psf, "%8u S%-3u %-4u %-4s %-4s %-4s %10.6f %13.4f %11d\n",
+                atom + s + 1, box, mol + 1, kind.resName.c_str(),
+                kind.sites[s].name.c_str(), kind.sites[s].type.c_str(),
+                kind.sites[s].charge, kind.sites[s].mass, 0);
+      }
+      for (uint i = 0; i < kind.bonds.size(); i++) {
+        std::vector<uint> bond(2);
+        bond[0] = atom + kind.bonds[i].first + 1;
+        bond[1] = atom + kind.bonds[i].second + 1;
+        bonds.push_back(bond);
+      }
+      for (uint i = 0; i < kindAngles.size(); i++) {
+        angles.push_back(kindAngles[i]);
+        for (uint a = 0; a < 3; a++)
+          angles.back()[a] += atom + 1;
+      }
+      for (uint i = 0; i < kindDihedrals.size(); i++) {
+        dihedrals.push_back(kindDihedrals[i]);
+        for (uint a = 0; a < 4; a++)
+          dihedrals.back()[a] += atom + 1;
+      }
+      atom += kind.sites.size();
+    }
+  }
+  fprintf(pdb, "END\n");
+
+  const char* sections[3] = {
+    "!NBOND: bonds", "!NTHETA: angles", "!NPHI: dihedrals"
+  };
+  const uint perLine[3] = { 4, 3, 2 };
+  std::vector<std::vector<uint> > const* lists[3] = {
+    &bonds, &angles, &dihedrals
+  };
+  for (uint sec = 0; sec < 3; sec++) {
+    std::vector<std::vector<uint> > const& list = *lists[sec];
+    fprintf(psf, "\n%8u %s\n", (uint)list.size(), sections[sec]);
+    for (uint i = 0; i < list.size(); i++) {
+      for (uint a = 0; a < list[i].size(); a++)
+        fprintf(psf, "%8u", list[i][a]);
+      if (i % perLine[sec] == perLine[sec] - 1)
+        fprintf(psf, "\n");
+    }
+    fprintf(psf, "\n");
+  }
+  fprintf(psf, "\n%8u !NIMPHI: impropers\n\n", 0);
+  fclose(pdb);
+  fclose(psf);
+}
+
+void WriteConfig(std::string const& prefix, SystemDef const& def,
+                 const double edge, const uint seed)
+{
+  FILE* conf = Open(prefix + ".conf");
+  fprintf(conf, "Restart false\n"
+          "PRNG INTSEED\n"
+          "Random_Seed %u\n"
+          "ParaTypeCHARMM true\n"
+          "Parameters %s.inp\n", seed, prefix.c_str());
+  for (uint b = 0; b < 2; b++) {
+    fprintf(conf, "Coordinates %u %s\n", b, BoxFile(prefix, b, "pdb").c_str());
+    fprintf(conf, "Structure %u %s\n", b, BoxFile(prefix, b, "psf").c_str());
+  }
+  fprintf(conf, "GEMC NVT\n"
+          "Temperature %.1f\n"
+          "Potential VDW\n"
+          "LRC true\n"
+          "Rcut %.1f\n"
+          "RcutLow 1.0\n"
+          "Exclude 1-4\n"
+          "ElectroStatic %s\n"
+          "Ewald %s\n"
+          "Tolerance 0.00001\n"
+          "RunSteps 1000\n"
+          "EqSteps 500\n"
+          "AdjSteps 100\n%s", def.temperature, RCUT,
+          def.charged ? "true" : "false", def.charged ? "true" : "false",
+          def.moves.c_str());
+  for (uint b = 0; b < 2; b++) {
+    fprintf(conf, "CellBasisVector1 %u %.3f 0.0 0.0\n", b, edge);
+    fprintf(conf, "CellBasisVector2 %u 0.0 %.3f 0.0\n", b, edge);
+    fprintf(conf, "CellBasisVector3 %u 0.0 0.0 %.3f\n", b, edge);
+  }
+  fprintf(conf, "CBMC_First 8\n"
+          "CBMC_Nth 4\n"
+          "CBMC_Ang 20\n"
+          "CBMC_Dih 10\n"
+          "OutputName %s\n"
+          "CoordinatesFreq false 1000\n"
+          "RestartFreq false 1000\n"
+          "CheckpointFreq false 1000\n"
+          "ConsoleFreq true 1000\n"
+          "BlockAverageFreq false 1000\n"
+          "OutEnergy true true\n"
+          "OutPressure false false\n"
+          "OutMolNum true true\n"
+          "OutDensity true true\n"
+          "PressureCalc false 1000\n", prefix.c_str());
+  fclose(conf);
+
+  FILE* par = Open(prefix + ".inp");
+  fprintf(par, "%s", def.params.c_str());
+  fprintf(par, "END\n");
+  fclose(par);
+}
+}
+
+namespace bench
+{
+std::vector<std::string> SystemNames()
+{
+  std::vector<std::string> names;
+  names.push_back("lj");
+  names.push_back("water");
+  names.push_back("alkane");
+  names.push_back("ionic");
+  return names;
+}
+
+bool IsSystem(std::string const& name)
+{
+  std::vector<std::string> names = SystemNames();
+  return std::find(names.begin(), names.end(), name) != names.end();
+}
+
+std::string WriteSystem(std::string const& name, const uint molecules,
+                        const uint seed)
+{
+  SystemDef def = Define(name);
+  uint units = molecules / def.kinds.size();
+  uint units0 = units / 2;
+  if (units0 == 0) {
+    std::cout << "Error: Benchmark system " << name << " needs at least "
+              << 2 * def.kinds.size() << " molecules!\n";
+    exit(EXIT_FAILURE);
+  }
+  double edge = std::max(pow(units0 * def.kinds.size() / def.density,
+                             1.0 / 3.0), MIN_EDGE);
+
+  MTRand rand(seed);
+  std::string prefix = Prefix(name, molecules);
+  std::vector<uint> count(def.kinds.size(), units0);
+  WriteBox(prefix, 0, def, count, edge, rand);
+  count.assign(def.kinds.size(), units - units0);
+  WriteBox(prefix, 1, def, count, edge, rand);
+  WriteConfig(prefix, def, edge, seed);
+  return prefix + ".conf";
+}
+
+void RemoveSystem(std::string const& name, const uint molecules)
+{
+  std::string prefix = Prefix(name, molecules);
+  remove((prefix + ".conf").c_str());
+  remove((prefix + ".inp").c_str());
+  for (uint b = 0; b < 2; b++) {
+    remove(BoxFile(prefix, b, "pdb").c_str());
+    remove(BoxFile(prefix, b, "psf").c_str());
+  }
+}
+}
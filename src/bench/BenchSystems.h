@@ -0,0 +1,45 @@
+/*******************************************************************************
+GPU OPTIMIZED MONTE CARLO (GOMC) 2.40
+Copyright (C) 2018  GOMC Group
+A copy of the GNU General Public License can be found in the COPYRIGHT.txt
+along with this program, also can be found at <http://www.gnu.org/licenses/>.
+********************************************************************************/
+#ifndef BENCH_SYSTEMS_H
+#define BENCH_SYSTEMS_H
+
+//
+//    BenchSystems.h
+//    Synthetic Gibbs ensemble systems of the benchmark: an LJ fluid, SPC/E
+//    water, a branched united atom alkane (2-methylbutane) and a coarse
+//    grained ionic liquid. The setup of GOMC reads files only, so a system
+//    is written out as config, parameter, PSF and PDB files named after
+//    its prefix, and removed again once the benchmark has read it.
+//
+//    The molecules are split evenly between two boxes of the same size, at
+//    liquid density unless that would make the boxes too small for the
+//    cutoff. Molecules sit on a cubic lattice with random orientation, the
+//    same seed always gives the same files.
+//
+
+#include "BasicTypes.h" //For uint
+#include <string>
+#include <vector>
+
+namespace bench
+{
+//Names of the systems, in the order they are run by default
+std::vector<std::string> SystemNames();
+
+bool IsSystem(std::string const& name);
+
+//Writes the input files of system name with molecules molecules in total
+//and returns the name of the config file. molecules is rounded down to
+//whole formula units (a cation and an anion for the ionic liquid).
+std::string WriteSystem(std::string const& name, const uint molecules,
+                        const uint seed);
+
+//Removes the files written by WriteSystem
+void RemoveSystem(std::string const& name, const uint molecules);
+}
+
+#endif /*BENCH_SYSTEMS_H*/
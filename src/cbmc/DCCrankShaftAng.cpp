@@ -12,6 +12,7 @@ along with this program, also can be found at <http://www.gnu.org/licenses/>.
 #include "Geometry.h"
 #include "CalculateEnergy.h"
 #include "XYZArray.h"
+#include "Profiler.h"
 #include <numeric>
 #include <cassert>
 
@@ -143,6 +144,7 @@ void DCCrankShaftAng::PrepareNew(TrialMol& newMol, uint molIndex)
 
 void DCCrankShaftAng::BuildOld(TrialMol& oldMol, uint molIndex)
 {
+  PROFILE_SCOPE(prof::DC_CRANKSHAFT_ANG);
   PRNG& prng = data->prng;
   uint nLJTrials = data->nLJTrialsNth;
   uint nDihTrials = data->nDihTrials;
@@ -200,7 +202,8 @@ void DCCrankShaftAng::BuildOld(TrialMol& oldMol, uint molIndex)
     data->axes.WrapPBC(multiPosRotions[a], oldMol.GetBox());
     //Calculate nonbonded energy
     data->calc.ParticleInter(inter, real, multiPosRotions[a], overlap,
-                             atoms[a], molIndex, oldMol.GetBox(), nLJTrials);
+                             atoms[a], molIndex, oldMol.GetBox(), nLJTrials,
+                             data->neighbors);
     ParticleNonbonded(oldMol, multiPosRotions[a], atoms[a], nLJTrials);
   }
 
@@ -222,6 +225,7 @@ void DCCrankShaftAng::BuildOld(TrialMol& oldMol, uint molIndex)
 
 void DCCrankShaftAng::BuildNew(TrialMol& newMol, uint molIndex)
 {
+  PROFILE_SCOPE(prof::DC_CRANKSHAFT_ANG);
   PRNG& prng = data->prng;
   uint nLJTrials = data->nLJTrialsNth;
   uint nDihTrials = data->nDihTrials;
@@ -273,7 +277,8 @@ void DCCrankShaftAng::BuildNew(TrialMol& newMol, uint molIndex)
     data->axes.WrapPBC(multiPosRotions[a], newMol.GetBox());
     //Calculate nonbonded energy
     data->calc.ParticleInter(inter, real, multiPosRotions[a], overlap,
-                             atoms[a], molIndex, newMol.GetBox(), nLJTrials);
+                             atoms[a], molIndex, newMol.GetBox(), nLJTrials,
+                             data->neighbors);
     ParticleNonbonded(newMol, multiPosRotions[a], atoms[a], nLJTrials);
   }
 
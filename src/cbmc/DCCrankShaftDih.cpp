@@ -12,6 +12,7 @@ along with this program, also can be found at <http://www.gnu.org/licenses/>.
 #include "Geometry.h"
 #include "CalculateEnergy.h"
 #include "XYZArray.h"
+#include "Profiler.h"
 #include <numeric>
 #include <cassert>
 
@@ -153,6 +154,7 @@ void DCCrankShaftDih::PrepareNew(TrialMol& newMol, uint molIndex)
 
 void DCCrankShaftDih::BuildOld(TrialMol& oldMol, uint molIndex)
 {
+  PROFILE_SCOPE(prof::DC_CRANKSHAFT_DIH);
   PRNG& prng = data->prng;
   uint nLJTrials = data->nLJTrialsNth;
   uint nDihTrials = data->nDihTrials;
@@ -210,7 +212,8 @@ void DCCrankShaftDih::BuildOld(TrialMol& oldMol, uint molIndex)
     data->axes.WrapPBC(multiPosRotions[a], oldMol.GetBox());
     //Calculate nonbonded energy
     data->calc.ParticleInter(inter, real, multiPosRotions[a], overlap,
-                             atoms[a], molIndex, oldMol.GetBox(), nLJTrials);
+                             atoms[a], molIndex, oldMol.GetBox(), nLJTrials,
+                             data->neighbors);
     ParticleNonbonded(oldMol, multiPosRotions[a], atoms[a], nLJTrials);
   }
 
@@ -232,6 +235,7 @@ void DCCrankShaftDih::BuildOld(TrialMol& oldMol, uint molIndex)
 
 void DCCrankShaftDih::BuildNew(TrialMol& newMol, uint molIndex)
 {
+  PROFILE_SCOPE(prof::DC_CRANKSHAFT_DIH);
   PRNG& prng = data->prng;
   uint nLJTrials = data->nLJTrialsNth;
   uint nDihTrials = data->nDihTrials;
@@ -283,7 +287,8 @@ void DCCrankShaftDih::BuildNew(TrialMol& newMol, uint molIndex)
     data->axes.WrapPBC(multiPosRotions[a], newMol.GetBox());
     //Calculate nonbonded energy
     data->calc.ParticleInter(inter, real, multiPosRotions[a], overlap,
-                             atoms[a], molIndex, newMol.GetBox(), nLJTrials);
+                             atoms[a], molIndex, newMol.GetBox(), nLJTrials,
+                             data->neighbors);
     ParticleNonbonded(newMol, multiPosRotions[a], atoms[a], nLJTrials);
   }
 
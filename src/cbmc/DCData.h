@@ -64,6 +64,8 @@ public:
   bool* overlapT;     //For detecting overlap for each LJ trial. Used in DCRotateCOM
 
   XYZArray multiPositions[MAX_BONDS];
+
+  TrialNeighbors neighbors; //neighbor buffers of CalculateEnergy::ParticleInter
 };
 
 inline DCData::DCData(System& sys, const Forcefield& forcefield, const Setup& set):
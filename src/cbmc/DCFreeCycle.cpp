@@ -13,6 +13,7 @@ along with this program, also can be found at <http://www.gnu.org/licenses/>.
 #include "Forcefield.h"
 #include "PRNG.h"
 #include "NumLib.h"
+#include "Profiler.h"
 
 namespace cbmc
 {
@@ -114,6 +115,7 @@ void DCFreeCycle::SetBondLengthOld(TrialMol& oldMol)
 
 void DCFreeCycle::BuildNew(TrialMol& newMol, uint molIndex)
 {
+  PROFILE_SCOPE(prof::DC_FREE_CYCLE);
   seed.BuildNew(newMol, molIndex);
   PRNG& prng = data->prng;
   const CalculateEnergy& calc = data->calc;
@@ -160,10 +162,10 @@ void DCFreeCycle::BuildNew(TrialMol& newMol, uint molIndex)
 
   for (uint b = 0; b < hed.NumBond(); ++b) {
     calc.ParticleInter(inter, real, positions[b], overlap, hed.Bonded(b),
-                       molIndex, newMol.GetBox(), nLJTrials);
+                       molIndex, newMol.GetBox(), nLJTrials, data->neighbors);
   }
   calc.ParticleInter(inter, real, positions[hed.NumBond()], overlap, hed.Prev(),
-                     molIndex, newMol.GetBox(), nLJTrials);
+                     molIndex, newMol.GetBox(), nLJTrials, data->neighbors);
 
   double stepWeight = 0;
   for (uint lj = 0; lj < nLJTrials; ++lj) {
@@ -189,6 +191,7 @@ void DCFreeCycle::BuildNew(TrialMol& newMol, uint molIndex)
 
 void DCFreeCycle::BuildOld(TrialMol& oldMol, uint molIndex)
 {
+  PROFILE_SCOPE(prof::DC_FREE_CYCLE);
   seed.BuildOld(oldMol, molIndex);
   PRNG& prng = data->prng;
   const CalculateEnergy& calc = data->calc;
@@ -244,11 +247,11 @@ void DCFreeCycle::BuildOld(TrialMol& oldMol, uint molIndex)
 
   for (uint b = 0; b < hed.NumBond(); ++b) {
     calc.ParticleInter(inter, real, positions[b], overlap, hed.Bonded(b),
-                       molIndex, oldMol.GetBox(), nLJTrials);
+                       molIndex, oldMol.GetBox(), nLJTrials, data->neighbors);
   }
   double stepWeight = 0;
   calc.ParticleInter(inter, real, positions[hed.NumBond()], overlap, hed.Prev(),
-                     molIndex, oldMol.GetBox(), nLJTrials);
+                     molIndex, oldMol.GetBox(), nLJTrials, data->neighbors);
 
   for (uint lj = 0; lj < nLJTrials; ++lj) {
     stepWeight += exp(-ff.beta * (inter[lj] + real[lj]));
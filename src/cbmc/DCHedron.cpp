@@ -13,6 +13,7 @@ along with this program, also can be found at <http://www.gnu.org/licenses/>.
 #include "Forcefield.h"
 #include "PRNG.h"
 #include "NumLib.h"
+#include "Parallel.h"
 #include <numeric>
 #include <cassert>
 
@@ -132,7 +133,7 @@ void DCHedron::GenerateAnglesNew(TrialMol& newMol, uint molIndex,
   }
 
 #ifdef _OPENMP
-  #pragma omp parallel for default(shared) private(i, distSq)
+  #pragma omp parallel for default(shared) private(i, distSq) if(par::Worth(nTrials))
 #endif
   for (i = 0; i < nTrials; ++i) {
     data->angleEnergy[i] = data->ff.angles->Calc(kind, data->angles[i]);
@@ -169,7 +170,7 @@ void DCHedron::GenerateAnglesOld(TrialMol& oldMol, uint molIndex,
   }
 
 #ifdef _OPENMP
-  #pragma omp parallel for default(shared) private(i, distSq)
+  #pragma omp parallel for default(shared) private(i, distSq) if(par::Worth(nTrials))
 #endif
   for (i = 0; i < nTrials; ++i) {
     data->angleEnergy[i] = data->ff.angles->Calc(kind, data->angles[i]);
@@ -327,7 +328,7 @@ void DCHedron::ConstrainedAngles(TrialMol& newMol, uint molIndex, uint nTrials)
     double stepWeight = 0.0;
     int i;
 #ifdef _OPENMP
-    #pragma omp parallel for default(shared) private(i) reduction(+:stepWeight)
+    #pragma omp parallel for default(shared) private(i) reduction(+:stepWeight) if(par::Worth(nTrials))
 #endif
     for (i = 0; i < nTrials; ++i) {
       weights[i] = exp(-1 * data->ff.beta * (energies[i] +
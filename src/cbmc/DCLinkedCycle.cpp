@@ -13,6 +13,7 @@ along with this program, also can be found at <http://www.gnu.org/licenses/>.
 #include "Forcefield.h"
 #include "PRNG.h"
 #include "NumLib.h"
+#include "Profiler.h"
 #include <numeric>
 #include <cassert>
 
@@ -172,6 +173,7 @@ void DCLinkedCycle::SetBondLengthOld(TrialMol& oldMol)
 
 void DCLinkedCycle::BuildNew(TrialMol& newMol, uint molIndex)
 {
+  PROFILE_SCOPE(prof::DC_LINKED_CYCLE);
   PRNG& prng = data->prng;
   const CalculateEnergy& calc = data->calc;
   const Forcefield& ff = data->ff;
@@ -280,6 +282,7 @@ void DCLinkedCycle::BuildNew(TrialMol& newMol, uint molIndex)
 
 void DCLinkedCycle::BuildOld(TrialMol& oldMol, uint molIndex)
 {
+  PROFILE_SCOPE(prof::DC_LINKED_CYCLE);
   PRNG& prng = data->prng;
   const CalculateEnergy& calc = data->calc;
   const Forcefield& ff = data->ff;
@@ -455,7 +458,8 @@ double DCLinkedCycle::EvalLJ(TrialMol& mol, uint molIndex)
       continue;
     }
     data->calc.ParticleInter(inter, real, positions[b], overlap, hed.Bonded(b),
-                             molIndex, mol.GetBox(), nLJTrials);
+                             molIndex, mol.GetBox(), nLJTrials,
+                             data->neighbors);
 
     data->calc.ParticleNonbonded(nonbonded, mol, positions[b],
                                  hed.Bonded(b), mol.GetBox(), nLJTrials);
@@ -13,6 +13,7 @@ along with this program, also can be found at <http://www.gnu.org/licenses/>.
 #include "Forcefield.h"
 #include "PRNG.h"
 #include "NumLib.h"
+#include "Profiler.h"
 #include <numeric>
 #include <cassert>
 
@@ -129,6 +130,7 @@ void DCLinkedHedron::SetBondLengthOld(TrialMol& oldMol)
 
 void DCLinkedHedron::BuildNew(TrialMol& newMol, uint molIndex)
 {
+  PROFILE_SCOPE(prof::DC_LINKED_HEDRON);
   PRNG& prng = data->prng;
   const CalculateEnergy& calc = data->calc;
   const Forcefield& ff = data->ff;
@@ -212,6 +214,7 @@ void DCLinkedHedron::BuildNew(TrialMol& newMol, uint molIndex)
 
 void DCLinkedHedron::BuildOld(TrialMol& oldMol, uint molIndex)
 {
+  PROFILE_SCOPE(prof::DC_LINKED_HEDRON);
   PRNG& prng = data->prng;
   const CalculateEnergy& calc = data->calc;
   const Forcefield& ff = data->ff;
@@ -346,7 +349,8 @@ double DCLinkedHedron::EvalLJ(TrialMol& mol, uint molIndex)
 
   for (uint b = 0; b < hed.NumBond(); ++b) {
     data->calc.ParticleInter(inter, real, positions[b], overlap, hed.Bonded(b),
-                             molIndex, mol.GetBox(), nLJTrials);
+                             molIndex, mol.GetBox(), nLJTrials,
+                             data->neighbors);
 
     data->calc.ParticleNonbonded(nonbonded, mol, positions[b],
                                  hed.Bonded(b), mol.GetBox(), nLJTrials);
@@ -11,6 +11,7 @@ along with this program, also can be found at <http://www.gnu.org/licenses/>.
 #include "PRNG.h"
 #include "Forcefield.h"
 #include "MolSetup.h"
+#include "Profiler.h"
 
 namespace cbmc
 {
@@ -56,6 +57,7 @@ double DCOnSphere::BondEnergyOld(TrialMol& oldMol)
 
 void DCOnSphere::BuildOld(TrialMol& oldMol, uint molIndex)
 {
+  PROFILE_SCOPE(prof::DC_ON_SPHERE);
   XYZArray& positions = data->positions;
   uint nLJTrials = data->nLJTrialsNth;
   double* inter = data->inter;
@@ -76,7 +78,7 @@ void DCOnSphere::BuildOld(TrialMol& oldMol, uint molIndex)
   data->axes.WrapPBC(positions, oldMol.GetBox());
 
   data->calc.ParticleInter(inter, real, positions, overlap, atom, molIndex,
-                           oldMol.GetBox(), nLJTrials);
+                           oldMol.GetBox(), nLJTrials, data->neighbors);
 
 
   for (uint trial = 0; trial < nLJTrials; trial++) {
@@ -93,6 +95,7 @@ void DCOnSphere::BuildOld(TrialMol& oldMol, uint molIndex)
 
 void DCOnSphere::BuildNew(TrialMol& newMol, uint molIndex)
 {
+  PROFILE_SCOPE(prof::DC_ON_SPHERE);
   XYZArray& positions = data->positions;
   uint nLJTrials = data->nLJTrialsNth;
   double* inter = data->inter;
@@ -114,7 +117,7 @@ void DCOnSphere::BuildNew(TrialMol& newMol, uint molIndex)
   data->axes.WrapPBC(positions, newMol.GetBox());
 
   data->calc.ParticleInter(inter, real, positions, overlap, atom, molIndex,
-                           newMol.GetBox(), nLJTrials);
+                           newMol.GetBox(), nLJTrials, data->neighbors);
 
 
   for (uint trial = 0; trial < nLJTrials; trial++) {
@@ -13,6 +13,7 @@ along with this program, also can be found at <http://www.gnu.org/licenses/>.
 #include "Forcefield.h"
 #include "PRNG.h"
 #include "NumLib.h"
+#include "Profiler.h"
 /*
 This file is only called from MoleculeExchange and IntraMoleculeExchange file.
 This file depend on ensemble kind, swap the COM of small molecules with one
@@ -126,6 +127,7 @@ void DCRotateCOM::PickTransferCOMOld(TrialMol& oldMol, uint molIndex)
 
 void DCRotateCOM::BuildNew(TrialMol& newMol, uint molIndex)
 {
+  PROFILE_SCOPE(prof::DC_ROTATE_COM);
   PRNG& prng = data->prng;
   const CalculateEnergy& calc = data->calc;
   const Ewald *calcEwald = data->calcEwald;
@@ -215,7 +217,7 @@ void DCRotateCOM::BuildNew(TrialMol& newMol, uint molIndex)
   for (uint a = 0; a < atomNumber; ++a) {
     data->axes.WrapPBC(multiPosRotions[a], newMol.GetBox());
     calc.ParticleInter(inter, real, multiPosRotions[a], overlap, a,
-                       molIndex, newMol.GetBox(), totalTrials);
+                       molIndex, newMol.GetBox(), totalTrials, data->neighbors);
   }
 
   double stepWeight = 0.0;
@@ -237,6 +239,7 @@ void DCRotateCOM::BuildNew(TrialMol& newMol, uint molIndex)
 
 void DCRotateCOM::BuildOld(TrialMol& oldMol, uint molIndex)
 {
+  PROFILE_SCOPE(prof::DC_ROTATE_COM);
   PRNG& prng = data->prng;
   const CalculateEnergy& calc = data->calc;
   const Ewald * calcEwald = data->calcEwald;
@@ -325,7 +328,7 @@ void DCRotateCOM::BuildOld(TrialMol& oldMol, uint molIndex)
     multiPosRotions[a].Add(0, orgCenter);
     data->axes.WrapPBC(multiPosRotions[a], oldMol.GetBox());
     calc.ParticleInter(inter, real, multiPosRotions[a], overlap, a,
-                       molIndex, oldMol.GetBox(), totalTrials);
+                       molIndex, oldMol.GetBox(), totalTrials, data->neighbors);
   }
 
   double stepWeight = 0.0;
@@ -12,6 +12,7 @@ along with this program, also can be found at <http://www.gnu.org/licenses/>.
 #include "Geometry.h"
 #include "CalculateEnergy.h"
 #include "XYZArray.h"
+#include "Profiler.h"
 #include <numeric>
 #include <cassert>
 
@@ -169,6 +170,7 @@ void DCRotateOnAtom::PrepareNew(TrialMol& newMol, uint molIndex)
 
 void DCRotateOnAtom::BuildOld(TrialMol& oldMol, uint molIndex)
 {
+  PROFILE_SCOPE(prof::DC_ROTATE_ON_ATOM);
   PRNG& prng = data->prng;
   uint nLJTrials = data->nLJTrialsNth;
   uint nDihTrials = data->nDihTrials;
@@ -227,7 +229,8 @@ void DCRotateOnAtom::BuildOld(TrialMol& oldMol, uint molIndex)
     data->axes.WrapPBC(multiPosRotions[a], oldMol.GetBox());
     //Calculate nonbonded energy
     data->calc.ParticleInter(inter, real, multiPosRotions[a], overlap,
-                             atoms[a], molIndex, oldMol.GetBox(), nLJTrials);
+                             atoms[a], molIndex, oldMol.GetBox(), nLJTrials,
+                             data->neighbors);
     ParticleNonbonded(oldMol, multiPosRotions[a], atoms[a], nLJTrials);
   }
 
@@ -249,6 +252,7 @@ void DCRotateOnAtom::BuildOld(TrialMol& oldMol, uint molIndex)
 
 void DCRotateOnAtom::BuildNew(TrialMol& newMol, uint molIndex)
 {
+  PROFILE_SCOPE(prof::DC_ROTATE_ON_ATOM);
   PRNG& prng = data->prng;
   uint nLJTrials = data->nLJTrialsNth;
   uint nDihTrials = data->nDihTrials;
@@ -301,7 +305,8 @@ void DCRotateOnAtom::BuildNew(TrialMol& newMol, uint molIndex)
     data->axes.WrapPBC(multiPosRotions[a], newMol.GetBox());
     //Calculate nonbonded energy
     data->calc.ParticleInter(inter, real, multiPosRotions[a], overlap,
-                             atoms[a], molIndex, newMol.GetBox(), nLJTrials);
+                             atoms[a], molIndex, newMol.GetBox(), nLJTrials,
+                             data->neighbors);
     ParticleNonbonded(newMol, multiPosRotions[a], atoms[a], nLJTrials);
   }
 
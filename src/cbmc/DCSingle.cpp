@@ -11,6 +11,7 @@ along with this program, also can be found at <http://www.gnu.org/licenses/>.
 #include "CalculateEnergy.h"
 #include "XYZArray.h"
 #include "Forcefield.h"
+#include "Profiler.h"
 
 namespace cbmc
 {
@@ -24,6 +25,7 @@ DCSingle::DCSingle(DCData* data, uint atom) : data(data), atom(atom)
 
 void DCSingle::BuildOld(TrialMol& oldMol, uint molIndex)
 {
+  PROFILE_SCOPE(prof::DC_SINGLE);
   PRNG& prng = data->prng;
   XYZArray& positions = data->positions;
   uint nLJTrials = data->nLJTrialsFirst;
@@ -43,7 +45,7 @@ void DCSingle::BuildOld(TrialMol& oldMol, uint molIndex)
   }
   positions.Set(0, data->axes.WrapPBC(oldMol.AtomPosition(atom), oldMol.GetBox()));
   data->calc.ParticleInter(inter, real, positions, overlap, atom, molIndex,
-                           oldMol.GetBox(), nLJTrials);
+                           oldMol.GetBox(), nLJTrials, data->neighbors);
 
   for (uint trial = 0; trial < nLJTrials; ++trial) {
     stepWeight += exp(-1 * data->ff.beta *
@@ -58,6 +60,7 @@ void DCSingle::BuildOld(TrialMol& oldMol, uint molIndex)
 
 void DCSingle::BuildNew(TrialMol& newMol, uint molIndex)
 {
+  PROFILE_SCOPE(prof::DC_SINGLE);
   PRNG& prng = data->prng;
   XYZArray& positions = data->positions;
   uint nLJTrials = data->nLJTrialsFirst;
@@ -78,7 +81,7 @@ void DCSingle::BuildNew(TrialMol& newMol, uint molIndex)
     prng.FillWithRandom(positions, nLJTrials, data->axes, newMol.GetBox());
   }
   data->calc.ParticleInter(inter, real, positions, overlap, atom, molIndex,
-                           newMol.GetBox(), nLJTrials);
+                           newMol.GetBox(), nLJTrials, data->neighbors);
 
   double stepWeight = 0;
   for (uint trial = 0; trial < nLJTrials; ++trial) {
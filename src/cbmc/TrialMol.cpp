@@ -106,6 +106,29 @@ void swap(TrialMol& a, TrialMol& b)
   b.cavMatrix.Set(2, 0.0, 0.0, 1.0);
 }
 
+void TrialMol::Reset(const MoleculeKind& k, const BoxDimensions& ax,
+                     uint box)
+{
+  if (kind != &k) {
+    *this = TrialMol(k, ax, box);
+    return;
+  }
+  axes = &ax;
+  this->box = box;
+  en = Energy();
+  totalWeight = 1.0;
+  std::fill_n(atomBuilt, k.NumAtoms(), false);
+  growthToWorld.LoadIdentity();
+  bonds.Unset();
+  comInCav = false;
+  comFix = false;
+  rotateBB = false;
+  overlap = false;
+  cavMatrix.Set(0, 1.0, 0.0, 0.0);
+  cavMatrix.Set(1, 0.0, 1.0, 0.0);
+  cavMatrix.Set(2, 0.0, 0.0, 1.0);
+}
+
 TrialMol::~TrialMol()
 {
   delete[] atomBuilt;
@@ -96,6 +96,10 @@ public:
   TrialMol& operator=(TrialMol other);
   friend void swap(TrialMol& a, TrialMol& b);
 
+  //!Same as assigning TrialMol(k, ax, box), but keeps the arrays if this
+  //!already was a TrialMol of kind k.
+  void Reset(const MoleculeKind& k, const BoxDimensions& ax, uint box);
+
   //!True if this has been initialized to be valid
   bool IsValid() const
   {
@@ -81,8 +81,8 @@ inline uint CrankShaft::Prep(const double subDraw, const double movPerc)
   overlap = false;
   uint state = GetBoxAndMol(subDraw, movPerc);
   if (state == mv::fail_state::NO_FAIL) {
-    newMol = cbmc::TrialMol(molRef.kinds[kindIndex], boxDimRef, destBox);
-    oldMol = cbmc::TrialMol(molRef.kinds[kindIndex], boxDimRef, sourceBox);
+    newMol.Reset(molRef.kinds[kindIndex], boxDimRef, destBox);
+    oldMol.Reset(molRef.kinds[kindIndex], boxDimRef, sourceBox);
     oldMol.SetCoords(coordCurrRef, pStart);
   }
   return state;
@@ -142,9 +142,19 @@ inline void CrankShaft::Accept(const uint rejectState, const uint step)
       sysPotRef.boxEnergy[sourceBox].correction -= correct_old;
       sysPotRef.boxEnergy[destBox].correction += correct_new;
 
+      //Pair virial of the molecule at its old and new position
+      if(calcEnRef.TrackVirial()) {
+        sysPotRef.boxVirial[sourceBox] -=
+          calcEnRef.MoleculeVirial(molIndex, sourceBox);
+      }
+
       //Set coordinates, new COM; shift index to new box's list
       newMol.GetCoords().CopyRange(coordCurrRef, 0, pStart, pLen);
       comCurrRef.SetNew(molIndex, destBox);
+      if(calcEnRef.TrackVirial()) {
+        sysPotRef.boxVirial[destBox] +=
+          calcEnRef.MoleculeVirial(molIndex, destBox);
+      }
       cellList.AddMol(molIndex, destBox, coordCurrRef);
 
 
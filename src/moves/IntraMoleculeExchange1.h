@@ -559,6 +559,7 @@ inline void IntraMoleculeExchange1::Accept(const uint rejectState,
 
       //Update reciprocal
       calcEwald->UpdateRecip(sourceBox);
+      calcEnRef.InvalidateVirial(sourceBox);
 
       //molA and molB already added to cellist
 
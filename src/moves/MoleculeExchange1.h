@@ -755,6 +755,7 @@ inline void MoleculeExchange1::Accept(const uint rejectState, const uint step)
 
       for (uint b = 0; b < BOX_TOTAL; b++) {
         calcEwald->UpdateRecip(b);
+        calcEnRef.InvalidateVirial(b);
       }
       //molA and molB already transfered to destBox and added to cellist
       //Retotal
@@ -85,8 +85,8 @@ inline uint MoleculeTransfer::Prep(const double subDraw, const double movPerc)
   overlap = false;
   uint state = GetBoxPairAndMol(subDraw, movPerc);
   if (state == mv::fail_state::NO_FAIL) {
-    newMol = cbmc::TrialMol(molRef.kinds[kindIndex], boxDimRef, destBox);
-    oldMol = cbmc::TrialMol(molRef.kinds[kindIndex], boxDimRef, sourceBox);
+    newMol.Reset(molRef.kinds[kindIndex], boxDimRef, destBox);
+    oldMol.Reset(molRef.kinds[kindIndex], boxDimRef, sourceBox);
     oldMol.SetCoords(coordCurrRef, pStart);
   }
   return state;
@@ -197,11 +197,21 @@ inline void MoleculeTransfer::Accept(const uint rejectState, const uint step)
       sysPotRef.boxEnergy[sourceBox].self -= self_old;
       sysPotRef.boxEnergy[destBox].self += self_new;
 
+      //Pair virial of the molecule in the old and new box
+      if(calcEnRef.TrackVirial()) {
+        sysPotRef.boxVirial[sourceBox] -=
+          calcEnRef.MoleculeVirial(molIndex, sourceBox);
+      }
+
       //Set coordinates, new COM; shift index to new box's list
       newMol.GetCoords().CopyRange(coordCurrRef, 0, pStart, pLen);
       comCurrRef.SetNew(molIndex, destBox);
       molLookRef.ShiftMolBox(molIndex, sourceBox, destBox,
                              kindIndex);
+      if(calcEnRef.TrackVirial()) {
+        sysPotRef.boxVirial[destBox] +=
+          calcEnRef.MoleculeVirial(molIndex, destBox);
+      }
       cellList.AddMol(molIndex, destBox, coordCurrRef);
 
 
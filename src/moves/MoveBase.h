@@ -79,7 +79,7 @@ protected:
   PRNG & prng;
   BoxDimensions & boxDimRef;
   Molecules const& molRef;
-  const double BETA;
+  const double& BETA; //follows the forcefield through replica exchanges
   const bool ewald;
   CellList& cellList;
   bool molRemoved, fixBox0, overlap;
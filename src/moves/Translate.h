@@ -94,9 +94,15 @@ inline void Translate::Accept(const uint rejectState, const uint step)
     // setting energy and virial of recip term
     sysPotRef.boxEnergy[b].recip += recip.energy;;
 
+    //Pair virial of the molecule at its old and new position
+    if(calcEnRef.TrackVirial())
+      sysPotRef.boxVirial[b] -= calcEnRef.MoleculeVirial(m, b);
+
     //Copy coords
     newMolPos.CopyRange(coordCurrRef, 0, pStart, pLen);
     comCurrRef.Set(m, newCOM);
+    if(calcEnRef.TrackVirial())
+      sysPotRef.boxVirial[b] += calcEnRef.MoleculeVirial(m, b);
     calcEwald->UpdateRecip(b);
 
     sysPotRef.Total();
@@ -8,6 +8,7 @@ along with this program, also can be found at <http://www.gnu.org/licenses/>.
 #define VOLUMETRANSFER_H
 
 #include "MoveBase.h" //For uint.
+#include "Parallel.h"
 
 #ifdef _OPENMP
 #include <omp.h>
@@ -30,6 +31,16 @@ public:
   virtual void Accept(const uint rejectState, const uint step);
   virtual void PrintAcceptKind();
 private:
+  //true if the move scales every box, so the trial coordinates can simply
+  //be swapped in on accept
+  bool ScalesAllBoxes() const
+  {
+    return (GEMC_KIND == mv::GEMC_NVT || BOX_TOTAL == 1);
+  }
+  //Copy coordinates and COM of the molecules in box b
+  void CopyBox(XYZArray const& srcPos, XYZArray const& srcCOM,
+               XYZArray & destPos, XYZArray & destCOM, const uint b) const;
+
   //Note: This is only used for GEMC-NVT
   uint bPick[2];
   //Note: This is only used for GEMC-NPT and NPT
@@ -93,11 +104,32 @@ inline uint VolumeTransfer::Prep(const double subDraw, const double movePerc)
   else
     newDimNonOrth = *((BoxDimensionsNonOrth*)(&boxDimRef));
 
-  coordCurrRef.CopyRange(newMolsPos, 0, 0, coordCurrRef.Count());
-  comCurrRef.CopyRange(newCOMs, 0, 0, comCurrRef.Count());
+  //Only the scaled box is needed, the other box's entries are not used
+  if (ScalesAllBoxes()) {
+    coordCurrRef.CopyRange(newMolsPos, 0, 0, coordCurrRef.Count());
+    comCurrRef.CopyRange(newCOMs, 0, 0, comCurrRef.Count());
+  } else {
+    CopyBox(coordCurrRef, comCurrRef, newMolsPos, newCOMs, box);
+  }
   return state;
 }
 
+inline void VolumeTransfer::CopyBox(XYZArray const& srcPos,
+                                    XYZArray const& srcCOM,
+                                    XYZArray & destPos, XYZArray & destCOM,
+                                    const uint b) const
+{
+  uint pStart = 0, pStop = 0, pLen = 0;
+  MoleculeLookup::box_iterator curr = molLookRef.BoxBegin(b),
+                               end = molLookRef.BoxEnd(b);
+  while (curr != end) {
+    molRef.GetRange(pStart, pStop, pLen, *curr);
+    srcPos.CopyRange(destPos, pStart, pStart, pLen);
+    srcCOM.CopyRange(destCOM, *curr, *curr, 1);
+    ++curr;
+  }
+}
+
 inline uint VolumeTransfer::Transform()
 {
   uint state = mv::fail_state::NO_FAIL;
@@ -138,17 +170,20 @@ inline uint VolumeTransfer::Transform()
 
 inline void VolumeTransfer::CalcEn()
 {
+  //Only atoms that changed cell are moved, the old grid is kept for reject
   if (GEMC_KIND == mv::GEMC_NVT) {
-    if(isOrth) {
-      cellList.GridAll(newDim, newMolsPos, molLookRef);
-    } else {
-      cellList.GridAll(newDimNonOrth, newMolsPos, molLookRef);
+    for(uint b = 0; b < 2; b++) {
+      if(isOrth) {
+        cellList.GridScaled(newDim, newMolsPos, molLookRef, bPick[b]);
+      } else {
+        cellList.GridScaled(newDimNonOrth, newMolsPos, molLookRef, bPick[b]);
+      }
     }
   } else {
     if(isOrth) {
-      cellList.GridBox(newDim, newMolsPos, molLookRef, box);
+      cellList.GridScaled(newDim, newMolsPos, molLookRef, box);
     } else {
-      cellList.GridBox(newDimNonOrth, newMolsPos, molLookRef, box);
+      cellList.GridScaled(newDimNonOrth, newMolsPos, molLookRef, box);
     }
   }
 
@@ -158,24 +193,43 @@ inline void VolumeTransfer::CalcEn()
   sysPotNew = sysPotRef;
 
   if (GEMC_KIND == mv::GEMC_NVT) {
-    for(uint b = 0; b < 2; b++) {
+    //the two boxes are independent, they run at the same time when their
+    //work allows a good split of the threads
+    SystemPotential boxPot[2];
+    int b, threads[2];
+    ulong work[2];
+    for(b = 0; b < 2; b++)
+      work[b] = calcEnRef.BoxWork(bPick[b]);
+    bool split = par::Split(threads, work, 2);
+
+#ifdef _OPENMP
+    #pragma omp parallel for num_threads(2) schedule(static, 1) if(split)
+#endif
+    for(b = 0; b < 2; b++) {
+#ifdef _OPENMP
+      if(split)
+        omp_set_num_threads(threads[b]);
+#endif
       //calculate new K vectors
       if(isOrth) {
         calcEwald->RecipInit(bPick[b], newDim);
         //setup reciprocate terms
         calcEwald->BoxReciprocalSetup(bPick[b], newMolsPos);
-        sysPotNew = calcEnRef.BoxInter(sysPotNew, newMolsPos, newCOMs,
+        boxPot[b] = calcEnRef.BoxInter(sysPotNew, newMolsPos, newCOMs,
                                        newDim, bPick[b]);
       } else {
         calcEwald->RecipInit(bPick[b], newDimNonOrth);
         //setup reciprocate terms
         calcEwald->BoxReciprocalSetup(bPick[b], newMolsPos);
-        sysPotNew = calcEnRef.BoxInter(sysPotNew, newMolsPos, newCOMs,
+        boxPot[b] = calcEnRef.BoxInter(sysPotNew, newMolsPos, newCOMs,
                                        newDimNonOrth, bPick[b]);
       }
       //calculate reciprocate term of electrostatic interaction
-      sysPotNew.boxEnergy[bPick[b]].recip = calcEwald->BoxReciprocal(bPick[b]);
+      boxPot[b].boxEnergy[bPick[b]].recip = calcEwald->BoxReciprocal(bPick[b]);
     }
+
+    for(b = 0; b < 2; b++)
+      sysPotNew.boxEnergy[bPick[b]] = boxPot[b].boxEnergy[bPick[b]];
   } else {
     //calculate new K vectors
     if(isOrth) {
@@ -241,11 +295,19 @@ inline void VolumeTransfer::Accept(const uint rejectState, const uint step)
   if (result) {
     //Set new energy.
     sysPotRef = sysPotNew;
-    //Swap... next time we'll use the current members.
-    //NOTE:
-    //This will be less efficient for NPT, but necessary evil.
-    swap(coordCurrRef, newMolsPos);
-    swap(comCurrRef, newCOMs);
+    cellList.CommitScaled();
+    regrewGrid = false;
+    //every pair changes, the pair virial is recalculated when needed
+    for (uint b = 0; b < BOX_TOTAL; b++)
+      calcEnRef.InvalidateVirial(b);
+    if (ScalesAllBoxes()) {
+      //Swap... next time we'll use the current members.
+      swap(coordCurrRef, newMolsPos);
+      swap(comCurrRef, newCOMs);
+    } else {
+      //Only the scaled box was set up in the trial arrays
+      CopyBox(newMolsPos, newCOMs, coordCurrRef, comCurrRef, box);
+    }
     if(isOrth)
       boxDimRef = newDim;
     else
@@ -262,11 +324,8 @@ inline void VolumeTransfer::Accept(const uint rejectState, const uint step)
     }
 
   } else if (rejectState == mv::fail_state::NO_FAIL && regrewGrid) {
-    if (GEMC_KIND == mv::GEMC_NVT) {
-      cellList.GridAll(boxDimRef, coordCurrRef, molLookRef);
-    } else {
-      cellList.GridBox(boxDimRef, coordCurrRef, molLookRef, box);
-    }
+    //swap the old grid back in
+    cellList.RestoreScaled(boxDimRef);
 
     regrewGrid = false;
     calcEwald->exgMolCache();